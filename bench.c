@@ -0,0 +1,470 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * pingmon-bench: Mikrobenchmarks für Parser, Statistik und Renderer sowie
+ * ein End-to-End-Lauf von der ping-Zeile bis zum fertigen Frame. Gelinkt
+ * gegen pingmon.c ohne main() (PINGMON_NO_MAIN); malloc & Co. werden über
+ * --wrap gezählt. Ausgabe geht in /dev/null.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "pingparse.h"
+#include "evloop.h"
+#include "screen.h"
+#include "stats.h"
+#include "seqtrack.h"
+#include "rank.h"
+#include "twheel.h"
+#include "resolve.h"
+#include "emit.h"
+#include "heatmap.h"
+
+// ========== AUS PINGMON.C ==========
+
+extern int packets_sent, packets_recv;
+extern double last, warn, crit;
+extern char target[RESOLVE_NAME_MAX];
+extern Resolver resolver;
+extern int bar_length, dirty;
+extern pid_t ping_pid;
+extern EvLoop loop;
+extern EvHandler probe_handler, expire_handler;
+extern PingReader ping_reader;
+extern SeqTracker tracker;
+extern LatencyStats lat_stats;
+extern HeatMap heat;
+extern int heat_view, term_rows, term_cols;
+
+void reset_stats(void);
+void ui_init(void);
+void add_to_history(double value);
+void add_to_history_at(int64_t ts_ms, double value);
+void draw_history(int line, int total_width, double warn, double crit);
+int draw_dynamic_bar(int line, int col, double percentage, int length, const char *color);
+void draw_frame(void);
+int safe_start_ping(const char *target, int *pipefd);
+void on_ping_readable(EvHandler *h, uint32_t events);
+void on_probe_lost(SeqTracker *t, uint16_t seq);
+void on_expire_timer(EvHandler *h, uint32_t events);
+
+// ========== ALLOKATIONEN ZÄHLEN ==========
+
+static uint64_t alloc_calls;
+static uint64_t alloc_bytes;
+
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t m);
+void *__real_realloc(void *p, size_t n);
+
+void *__wrap_malloc(size_t n) {
+    alloc_calls++;
+    alloc_bytes += n;
+    return __real_malloc(n);
+}
+
+void *__wrap_calloc(size_t n, size_t m) {
+    alloc_calls++;
+    alloc_bytes += n * m;
+    return __real_calloc(n, m);
+}
+
+void *__wrap_realloc(void *p, size_t n) {
+    alloc_calls++;
+    alloc_bytes += n;
+    return __real_realloc(p, n);
+}
+
+// ========== MESSUNG ==========
+
+typedef struct {
+    int64_t start_ns;
+    uint64_t calls;
+    uint64_t bytes;
+} Mark;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static Mark mark(void) {
+    Mark m = { now_ns(), alloc_calls, alloc_bytes };
+    return m;
+}
+
+static void report(const char *name, const Mark *m, uint64_t ops, const char *extra) {
+    double ns = (double)(now_ns() - m->start_ns);
+    printf("%-22s %10llu ops %9.1f ns/op %8.2f Mops/s %8llu allocs %10llu alloc bytes%s%s\n",
+           name, (unsigned long long)ops, ns / (double)ops, (double)ops / ns * 1e3,
+           (unsigned long long)(alloc_calls - m->calls),
+           (unsigned long long)(alloc_bytes - m->bytes),
+           extra ? "  " : "", extra ? extra : "");
+}
+
+static double synthetic_rtt(uint64_t i) {
+    // Wiederholbares Muster mit gelegentlichen Ausreißern über CRIT
+    return 8.0 + (double)(i * 7919 % 400) / 10.0 + ((i % 997) == 0 ? 120.0 : 0.0);
+}
+
+// ========== PARSER ==========
+
+static size_t build_ping_output(char **out, uint64_t n) {
+    size_t cap = n * 64 + 128, len = 0;
+    char *buf = malloc(cap);
+    len += (size_t)sprintf(buf, "PING 192.0.2.1 (192.0.2.1) 56(84) bytes of data.\n");
+    for (uint64_t i = 1; i <= n; i++) {
+        if (i % 500 == 0) {
+            len += (size_t)sprintf(buf + len, "no answer yet for icmp_seq=%llu\n", (unsigned long long)i);
+        } else {
+            len += (size_t)sprintf(buf + len, "64 bytes from 192.0.2.1: icmp_seq=%llu ttl=57 time=%.2f ms\n",
+                                   (unsigned long long)(i & 0xffff), synthetic_rtt(i));
+        }
+    }
+    *out = buf;
+    return len;
+}
+
+static void bench_parser(uint64_t n) {
+    char *text;
+    size_t len = build_ping_output(&text, n);
+
+    // Einzelne Zeilen direkt
+    Mark m = mark();
+    PingLine line;
+    uint64_t lines = 0, replies = 0;
+    for (const char *p = text, *end = text + len; p < end;) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (ping_parse_line(p, (size_t)(nl - p), &line) == PING_LINE_REPLY) replies++;
+        lines++;
+        p = nl + 1;
+    }
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%llu replies)", (unsigned long long)replies);
+    report("parse_line", &m, lines, extra);
+
+    // Über den Ringpuffer aus einer Datei (read() in Blöcken)
+    int fd = memfd_create("pingmon-bench", MFD_CLOEXEC);
+    if (fd < 0 || write(fd, text, len) != (ssize_t)len) {
+        perror("memfd");
+        free(text);
+        return;
+    }
+    lseek(fd, 0, SEEK_SET);
+    static PingReader reader;
+    ping_reader_init(&reader);
+    PingLine out[64];
+    m = mark();
+    while (ping_reader_fill(&reader, fd) > 0) {
+        while (ping_reader_parse(&reader, out, 64) == 64) {}
+    }
+    snprintf(extra, sizeof(extra), "(%.0f MB/s, %llu reads)",
+             (double)len / (double)(now_ns() - m.start_ns) * 1e3, (unsigned long long)reader.reads);
+    report("reader fill+parse", &m, reader.lines, extra);
+    close(fd);
+    free(text);
+}
+
+// ========== STATISTIK ==========
+
+static void bench_stats(uint64_t n) {
+    reset_stats();
+    volatile double sink = 0;
+
+    Mark m = mark();
+    for (uint64_t i = 0; i < n; i++) {
+        double rtt = (i % 200 == 0) ? 0 : synthetic_rtt(i);
+        add_to_history(rtt);
+    }
+    report("add_to_history", &m, n, "(rollups + heatmap + series)");
+
+    m = mark();
+    for (uint64_t i = 0; i < n; i++) {
+        double rtt = (i % 200 == 0) ? 0 : synthetic_rtt(i);
+        heat_add(&heat, (int64_t)i * 1000, rtt);
+    }
+    report("heat_add", &m, n, NULL);
+
+    m = mark();
+    for (uint64_t i = 0; i < n; i++) lat_add(&lat_stats, synthetic_rtt(i));
+    report("lat_add", &m, n, NULL);
+
+    m = mark();
+    for (uint64_t i = 0; i < n; i++) {
+        sink += calculate_quality(synthetic_rtt(i));
+        sink += calculate_stability((double)(i % 1000) / 100.0);
+    }
+    report("quality+stability", &m, n, NULL);
+
+    m = mark();
+    for (uint64_t i = 0; i < n / 1000; i++) sink += lat_percentile(&lat_stats, 99);
+    report("lat_percentile", &m, n / 1000, NULL);
+    (void)sink;
+}
+
+// ========== RANGLISTE ==========
+
+#define BENCH_RANK_TARGETS 10000
+
+// Rangliste im Mehrzielbetrieb: ein Schlüssel pro Sample, pro Frame die Top 40
+static void bench_rank(uint64_t n) {
+    RankHeap r;
+    if (rank_init(&r, BENCH_RANK_TARGETS) == -1) return;
+
+    Mark m = mark();
+    for (uint64_t i = 0; i < n; i++) {
+        rank_set(&r, (uint32_t)((i * 7919) % BENCH_RANK_TARGETS), synthetic_rtt(i));
+    }
+    report("rank_set (10k targets)", &m, n, NULL);
+
+    uint32_t top[40];
+    uint64_t sink = 0;
+    m = mark();
+    for (uint64_t i = 0; i < n / 100; i++) sink += rank_top(&r, top, 40);
+    report("rank_top 40 of 10k", &m, n / 100, NULL);
+    (void)sink;
+    rank_free(&r);
+}
+
+// ========== SENDE-TIMER-RAD ==========
+
+#define BENCH_WHEEL_PROBES 100000
+#define BENCH_WHEEL_TICK_US 100
+
+typedef struct {
+    TwTimer timer;
+    int64_t interval_us;
+} BenchProbe;
+
+static TimerWheel bench_wheel;
+
+static void bench_probe_due(TwTimer *t, int64_t now_us) {
+    BenchProbe *p = (BenchProbe *)t;
+    tw_add(&bench_wheel, t, now_us + p->interval_us);
+}
+
+// 100k Ziele mit 1 s Intervall, über das Intervall verteilt; die Zeit läuft
+// in Schritten wie vom timerfd geweckt. Kosten pro gesendeter Probe
+// (Auslösen, neu einplanen, anteilig Umsortieren)
+static void bench_wheel_run(uint64_t n) {
+    BenchProbe *probes = calloc(BENCH_WHEEL_PROBES, sizeof(*probes));
+    if (!probes) return;
+
+    tw_init(&bench_wheel, 0, BENCH_WHEEL_TICK_US);
+    Mark m = mark();
+    for (int i = 0; i < BENCH_WHEEL_PROBES; i++) {
+        probes[i].interval_us = 1000000;
+        tw_timer_init(&probes[i].timer, bench_probe_due);
+        tw_add(&bench_wheel, &probes[i].timer, (int64_t)i * 1000000 / BENCH_WHEEL_PROBES);
+    }
+    report("tw_add (100k targets)", &m, BENCH_WHEEL_PROBES, NULL);
+
+    uint64_t fired = 0, wakeups = 0;
+    int64_t now_us = 0;
+    m = mark();
+    while (fired < n) {
+        now_us = tw_next_us(&bench_wheel);
+        fired += tw_advance(&bench_wheel, now_us);
+        wakeups++;
+    }
+    char extra[80];
+    snprintf(extra, sizeof(extra), "(%.1f probes/wakeup, %.2f cascades/probe)",
+             (double)fired / (double)wakeups, (double)bench_wheel.cascaded / (double)fired);
+    report("wheel: fire + reschedule", &m, fired, extra);
+    free(probes);
+}
+
+// ========== RENDERER ==========
+
+static void bench_render(uint64_t frames, int null_fd) {
+    reset_stats();
+    ui_init();
+    scr_flush(null_fd);
+
+    // History füllen, danach pro Frame ein neues Sample
+    for (int i = 0; i < 300; i++) add_to_history(synthetic_rtt((uint64_t)i));
+
+    uint64_t bytes = 0;
+    Mark m = mark();
+    for (uint64_t f = 0; f < frames; f++) {
+        add_to_history(synthetic_rtt(f));
+        scr_clear_row(7);
+        int col = draw_dynamic_bar(7, 1, (double)(f % 101), bar_length, "\033[32m");
+        draw_dynamic_bar(7, col + 1, (double)((f * 3) % 101), bar_length, "\033[33m");
+        draw_history(8, 80, warn, crit);
+        bytes += (uint64_t)scr_flush(null_fd);
+    }
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%.1f bytes/frame)", (double)bytes / (double)frames);
+    report("history+bars frame", &m, frames, extra);
+
+    bytes = 0;
+    m = mark();
+    for (uint64_t f = 0; f < frames; f++) {
+        double rtt = synthetic_rtt(f);
+        packets_sent++;
+        packets_recv++;
+        last = rtt;
+        add_to_history(rtt);
+        lat_add(&lat_stats, rtt);
+        draw_frame();
+        bytes += (uint64_t)scr_flush(null_fd);
+    }
+    snprintf(extra, sizeof(extra), "(%.1f bytes/frame)", (double)bytes / (double)frames);
+    report("full frame", &m, frames, extra);
+
+    // Heatmap über die volle Breite: alle Spalten belegt, pro Frame ein
+    // neues Sample in der neuesten; Kosten hängen an den Spalten, nicht an
+    // der Zahl der Samples
+    reset_stats();
+    heat_view = 1;
+    term_rows = SCREEN_ROWS;
+    term_cols = SCREEN_COLS;
+    ui_init();
+    scr_flush(null_fd);
+    int64_t ts_ms = 0;
+    for (int i = 0; i < HEAT_COLS * 100; i++) {
+        ts_ms = (int64_t)i * (heat.slice_us / 100000);
+        add_to_history_at(ts_ms, synthetic_rtt((uint64_t)i));
+    }
+    bytes = 0;
+    m = mark();
+    for (uint64_t f = 0; f < frames; f++) {
+        add_to_history_at(ts_ms, synthetic_rtt(f));
+        draw_frame();
+        bytes += (uint64_t)scr_flush(null_fd);
+    }
+    snprintf(extra, sizeof(extra), "(%.1f bytes/frame)", (double)bytes / (double)frames);
+    report("heatmap frame", &m, frames, extra);
+    heat_view = 0;
+}
+
+// ========== AUSGABE OHNE OBERFLÄCHE ==========
+
+#define BENCH_EMIT_TARGETS 1000
+
+// --headless: Datensatz formatieren, puffern und schreiben, pro Probe bzw.
+// aggregiert über 1000 Ziele (Intervallende nur einmal, beim Schließen)
+static void bench_emit(uint64_t n, int null_fd) {
+    static const char *const formats[] = { "emit json", "emit binary", "emit json aggregated" };
+    const char *names[BENCH_EMIT_TARGETS];
+    char name_buf[BENCH_EMIT_TARGETS][16];
+    for (int i = 0; i < BENCH_EMIT_TARGETS; i++) {
+        snprintf(name_buf[i], sizeof(name_buf[i]), "host-%d", i);
+        names[i] = name_buf[i];
+    }
+
+    EvLoop eloop = { .epfd = -1 };
+    if (ev_init(&eloop) == -1) return;
+    int64_t ts_ms = 1760000000000;
+    for (int f = 0; f < 3; f++) {
+        Emitter e = { 0 };
+        if (emit_open(&e, &eloop, null_fd, f == 1 ? EMIT_BINARY : EMIT_JSON, names,
+                      BENCH_EMIT_TARGETS, f == 2 ? 1000 : 0) == -1) {
+            perror("emit_open");
+            break;
+        }
+        Mark m = mark();
+        for (uint64_t i = 0; i < n; i++) {
+            uint32_t rtt_us = (i % 200 == 0) ? 0 : (uint32_t)(synthetic_rtt(i) * 1000.0);
+            emit_probe(&e, (uint32_t)(i % BENCH_EMIT_TARGETS), ts_ms + (int64_t)i, (int)(i & 0xffff), 57, rtt_us);
+        }
+        emit_close(&e);
+        char extra[96];
+        snprintf(extra, sizeof(extra), "(%.1f bytes/probe, %llu writes, %.1f us CPU per 1k probes)",
+                 (double)e.bytes / (double)n, (unsigned long long)e.writes,
+                 (double)(now_ns() - m.start_ns) / (double)n);
+        report(formats[f], &m, n, extra);
+    }
+    ev_close(&eloop);
+}
+
+// ========== END-TO-END ==========
+
+// Fake-ping aus bench/ über PATH: Zeile -> Parser -> Statistik -> Frame
+static void bench_end_to_end(uint64_t n, int null_fd) {
+    char count[32];
+    snprintf(count, sizeof(count), "%llu", (unsigned long long)n);
+    setenv("PINGMON_FAKE_COUNT", count, 1);
+    unsetenv("PINGMON_FAKE_DELAY");
+
+    reset_stats();
+    ui_init();
+    scr_flush(null_fd);
+    ping_reader_init(&ping_reader);
+    if (ev_init(&loop) == -1 || (expire_handler.fd = ev_timer_new()) == -1) {
+        perror("eventloop");
+        return;
+    }
+    tracker.on_lost = on_probe_lost;
+
+    int pipefd[2];
+    if (safe_start_ping(target, pipefd) == -1) {
+        perror("ping");
+        return;
+    }
+    fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+    probe_handler.fd = pipefd[0];
+
+    uint64_t frames = 0, bytes = 0;
+    Mark m = mark();
+    struct pollfd pfd = { pipefd[0], POLLIN, 0 };
+    for (;;) {
+        if (poll(&pfd, 1, 5000) <= 0) break;
+        if (pfd.revents & POLLIN) on_ping_readable(&probe_handler, 0);
+        // Ohne Bildratenbegrenzung: jede Änderung wird gezeichnet
+        if (dirty) {
+            draw_frame();
+            bytes += (uint64_t)scr_flush(null_fd);
+            frames++;
+            dirty = 0;
+        }
+        if ((pfd.revents & POLLHUP) && !(pfd.revents & POLLIN)) break;
+    }
+
+    char extra[96];
+    snprintf(extra, sizeof(extra), "(%llu replies, %llu lost, %llu frames, %.1f bytes/frame)",
+             (unsigned long long)packets_recv, (unsigned long long)tracker.lost,
+             (unsigned long long)frames, frames ? (double)bytes / (double)frames : 0.0);
+    report("line -> frame", &m, (uint64_t)packets_sent, extra);
+
+    close(pipefd[0]);
+    if (ping_pid > 0) waitpid(ping_pid, NULL, 0);
+    ev_close(&loop);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 2000000;
+    if (n < 1000) n = 1000;
+
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        perror("/dev/null");
+        return 1;
+    }
+    strcpy(target, "192.0.2.1");
+    resolve_start(&resolver, &loop, target, AF_UNSPEC, 0);   // Literal: ohne Callbacks, ohne Thread
+    seq_init(&tracker, SEQ_WINDOW);
+
+    printf("pingmon-bench: %llu samples\n\n", (unsigned long long)n);
+    bench_parser(n);
+    bench_stats(n);
+    bench_rank(n);
+    bench_wheel_run(n);
+    bench_render(n / 20, null_fd);
+    bench_emit(n, null_fd);
+    bench_end_to_end(n / 10, null_fd);
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * TCP- und UDP-Probes (siehe connprobe.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "connprobe.h"
+#include "icmp.h"
+
+#define CONN_MAGIC 0x706d6f6eu      // "pmon"
+
+// Payload der UDP-Probe; der Echo-Dienst schickt ihn unverändert zurück
+typedef struct {
+    uint32_t magic;
+    uint16_t seq;
+    uint16_t reserved;
+    int64_t sent_us;
+} ConnStamp;
+
+const char *conn_kind_name(ConnKind kind) {
+    return kind == CONN_TCP ? "TCP" : kind == CONN_UDP ? "UDP" : "ICMP";
+}
+
+static socklen_t addr_len(const ResolveAddr *a) {
+    return a->sa.sa_family == AF_INET6 ? sizeof(a->in6) : sizeof(a->in);
+}
+
+static void free_slot(ConnProbe *c, ConnSlot *s) {
+    if (s->h.fd < 0) return;
+    ev_del(c->loop, &s->h);
+    // RST statt FIN: bei hoher Rate keine Verbindungen in TIME_WAIT
+    struct linger lg = { 1, 0 };
+    setsockopt(s->h.fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    close(s->h.fd);
+    s->h.fd = -1;
+}
+
+// ========== TCP ==========
+
+static void on_tcp_ready(EvHandler *h, uint32_t events) {
+    (void)events;
+    ConnSlot *s = h->ctx;
+    ConnProbe *c = s->owner;
+    int64_t now = mono_us();
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(h->fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) err = errno;
+
+    uint16_t seq = s->seq;
+    if (err == 0) {
+        // Erste RTT-Messung des Kernels ist der Handshake; nach einem
+        // wiederholten SYN gilt sie nicht (Karn), dann Userspace-Zeit
+        double rtt_ms = (now - s->sent_us) / 1000.0;
+        struct tcp_info ti;
+        socklen_t tlen = sizeof(ti);
+        if (getsockopt(h->fd, IPPROTO_TCP, TCP_INFO, &ti, &tlen) == 0 &&
+            ti.tcpi_rtt > 0 && ti.tcpi_total_retrans == 0) {
+            rtt_ms = ti.tcpi_rtt / 1000.0;
+            c->kernel_rtts++;
+        }
+        free_slot(c, s);
+        if (c->on_reply) c->on_reply(seq, rtt_ms);
+    } else if (err == ECONNREFUSED) {
+        free_slot(c, s);
+        c->refused++;
+        if (c->on_refused) c->on_refused(seq);
+    } else if (err != EINPROGRESS) {
+        // Z. B. Host unreachable: bleibt offen, bis der Tracker sie verwirft
+        free_slot(c, s);
+    }
+}
+
+static int tcp_send(ConnProbe *c, ConnSlot *s, int64_t now_us) {
+    int fd = socket(c->dst.sa.sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1) return -1;
+
+    s->sent_us = now_us;
+    if (connect(fd, &c->dst.sa, addr_len(&c->dst)) == -1 && errno != EINPROGRESS) {
+        int err = errno;
+        close(fd);
+        if (err == ECONNREFUSED) {
+            // Sofort abgelehnt: die Probe ist beim Aufrufer noch nicht
+            // eingetragen, conn_send meldet es über *refused
+            c->refused++;
+            return 1;
+        }
+        errno = err;
+        return -1;
+    }
+    s->h.fd = fd;
+    s->h.cb = on_tcp_ready;
+    s->h.ctx = s;
+    if (ev_add(c->loop, &s->h, EPOLLOUT) == -1) {
+        int err = errno;
+        close(fd);
+        s->h.fd = -1;
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+// ========== UDP ==========
+
+static void on_udp_readable(EvHandler *h, uint32_t events) {
+    (void)events;
+    ConnProbe *c = h->ctx;
+    ConnStamp st;
+
+    for (;;) {
+        ssize_t n = recv(h->fd, &st, sizeof(st), MSG_DONTWAIT);
+        int64_t now = mono_us();
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // Verbundener Socket: ICMP Port Unreachable kommt als Fehler an
+            if (errno == ECONNREFUSED) {
+                c->refused++;
+                if (c->on_refused) c->on_refused(-1);
+                continue;
+            }
+            return;
+        }
+        if (n != (ssize_t)sizeof(st) || st.magic != CONN_MAGIC) continue;
+
+        ConnSlot *s = &c->slots[st.seq & c->mask];
+        if (s->h.fd < 0 || s->seq != st.seq || s->sent_us != st.sent_us) continue;
+        s->h.fd = -1;
+        if (c->on_reply) c->on_reply(st.seq, (now - st.sent_us) / 1000.0);
+    }
+}
+
+static int udp_send(ConnProbe *c, ConnSlot *s, int64_t now_us) {
+    ConnStamp st = { CONN_MAGIC, s->seq, 0, now_us };
+    ssize_t n;
+    do {
+        n = send(c->udp.fd, &st, sizeof(st), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        if (errno == ECONNREFUSED) {
+            // Fehler einer früheren Probe; diese nochmals senden
+            c->refused++;
+            if (c->on_refused) c->on_refused(-1);
+            n = send(c->udp.fd, &st, sizeof(st), 0);
+        }
+        if (n < 0) return -1;
+    }
+    s->sent_us = now_us;
+    s->h.fd = c->udp.fd;     // belegt; Antworten laufen über den gemeinsamen Socket
+    return 0;
+}
+
+// ========== GEMEINSAM ==========
+
+int conn_open(ConnProbe *c, EvLoop *loop, ConnKind kind, const ResolveAddr *addr, uint16_t port,
+              uint32_t slots) {
+    void (*on_reply)(uint16_t, double) = c->on_reply;
+    void (*on_refused)(int) = c->on_refused;
+    uint32_t n = CONN_SLOTS_MIN;
+    while (n < slots && n < CONN_SLOTS_MAX) n <<= 1;
+    ConnSlot *table = calloc(n, sizeof(ConnSlot));
+    if (!table) return -1;
+
+    memset(c, 0, sizeof(*c));
+    c->on_reply = on_reply;
+    c->on_refused = on_refused;
+    c->kind = kind;
+    c->loop = loop;
+    c->dst = *addr;
+    if (addr->sa.sa_family == AF_INET6) c->dst.in6.sin6_port = htons(port);
+    else c->dst.in.sin_port = htons(port);
+    c->udp.fd = -1;
+    c->slots = table;
+    c->mask = n - 1;
+    for (uint32_t i = 0; i < n; i++) {
+        c->slots[i].h.fd = -1;
+        c->slots[i].owner = c;
+    }
+    if (kind != CONN_UDP) return 0;
+
+    c->udp.fd = socket(addr->sa.sa_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (c->udp.fd == -1) {
+        int err = errno;
+        free(c->slots);
+        c->slots = NULL;
+        errno = err;
+        return -1;
+    }
+    c->udp.cb = on_udp_readable;
+    c->udp.ctx = c;
+    if (connect(c->udp.fd, &c->dst.sa, addr_len(&c->dst)) == -1 ||
+        ev_add(loop, &c->udp, EPOLLIN) == -1) {
+        int err = errno;
+        close(c->udp.fd);
+        c->udp.fd = -1;
+        free(c->slots);
+        c->slots = NULL;
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+int conn_send(ConnProbe *c, int64_t now_us, int *refused) {
+    *refused = 0;
+    uint16_t seq = c->next_seq;
+    ConnSlot *s = &c->slots[seq & c->mask];
+
+    // Alle Slots offen: die älteste aufgeben; verloren zählt sie erst der
+    // Tracker, eine späte Antwort geht aber unter, daher eigens gezählt
+    if (s->h.fd >= 0) {
+        c->aborted++;
+        conn_abort(c, s->seq);
+    }
+    s->seq = seq;
+
+    int rc = c->kind == CONN_TCP ? tcp_send(c, s, now_us) : udp_send(c, s, now_us);
+    if (rc == -1) {
+        c->errors++;
+        return -1;
+    }
+    *refused = rc == 1;
+    c->next_seq++;
+    c->sent++;
+    return seq;
+}
+
+void conn_abort(ConnProbe *c, uint16_t seq) {
+    if (!c->slots) return;
+    ConnSlot *s = &c->slots[seq & c->mask];
+    if (s->h.fd < 0 || s->seq != seq) return;
+    if (c->kind == CONN_TCP) free_slot(c, s);
+    else s->h.fd = -1;
+}
+
+void conn_close(ConnProbe *c) {
+    if (!c->loop) return;
+    if (c->kind == CONN_TCP) {
+        for (uint32_t i = 0; i <= c->mask; i++) free_slot(c, &c->slots[i]);
+    }
+    free(c->slots);
+    c->slots = NULL;
+    if (c->udp.fd >= 0) {
+        ev_del(c->loop, &c->udp);
+        close(c->udp.fd);
+        c->udp.fd = -1;
+    }
+    c->loop = NULL;
+}
@@ -0,0 +1,82 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Probes ohne ICMP, für Pfade, auf denen ICMP gefiltert oder nachrangig
+ * behandelt wird (unprivilegiert, IPv4 und IPv6):
+ *
+ *   TCP: pro Probe ein nicht-blockierendes connect(); die RTT ist SYN bis
+ *        SYN-ACK. Nach Möglichkeit aus der ersten RTT-Messung des Kernels
+ *        (TCP_INFO), sonst Userspace-Zeit bis EPOLLOUT. Danach wird die
+ *        Verbindung mit RST geschlossen (kein TIME_WAIT).
+ *   UDP: ein verbundener Socket, jede Probe ein Datagramm mit Sequenz und
+ *        Sendezeit an einen Echo-Dienst (RFC 862), der es zurückschickt.
+ *
+ * Beliebig viele Probes sind gleichzeitig offen (so viele, wie der Aufrufer
+ * Slots anfordert), alles läuft über den Eventloop des Aufrufers.
+ */
+
+#ifndef PINGMON_CONNPROBE_H
+#define PINGMON_CONNPROBE_H
+
+#include <stdint.h>
+
+#include "evloop.h"
+#include "resolve.h"
+
+#define CONN_SLOTS_MIN   64         // Slots = offene Probes (TCP: je ein Socket)
+#define CONN_SLOTS_MAX   32768      // halber Sequenzraum
+#define CONN_SLOTS_SLACK 16         // Takte über den Timeout hinaus (Verzug des Timers)
+
+typedef enum {
+    CONN_NONE = 0,           // ICMP
+    CONN_TCP,
+    CONN_UDP
+} ConnKind;
+
+typedef struct ConnProbe ConnProbe;
+
+typedef struct {
+    EvHandler h;             // TCP: Socket der Probe, h.fd < 0 = frei
+    ConnProbe *owner;
+    uint16_t seq;
+    int64_t sent_us;
+} ConnSlot;
+
+struct ConnProbe {
+    ConnKind kind;
+    EvLoop *loop;
+    ResolveAddr dst;         // mit Port
+    EvHandler udp;           // UDP: gemeinsamer Socket
+    uint16_t next_seq;
+    ConnSlot *slots;         // nach seq & mask
+    uint32_t mask;           // Slots - 1, Zweierpotenz
+
+    uint64_t sent;
+    uint64_t kernel_rtts;    // TCP: RTT aus TCP_INFO
+    uint64_t refused;        // RST bzw. ICMP Port Unreachable
+    uint64_t errors;         // Senden gescheitert (z. B. keine Sockets mehr)
+    uint64_t aborted;        // noch offen, von einer neueren Probe verdrängt
+
+    void (*on_reply)(uint16_t seq, double rtt_ms);
+    void (*on_refused)(int seq);     // -1 = Probe nicht bekannt (UDP)
+};
+
+// Ziel setzen (UDP: Socket öffnen). slots wird auf eine Zweierpotenz in
+// [CONN_SLOTS_MIN, CONN_SLOTS_MAX] gerundet. 0 = OK, -1 = Fehler (errno)
+int conn_open(ConnProbe *c, EvLoop *loop, ConnKind kind, const ResolveAddr *addr, uint16_t port,
+              uint32_t slots);
+
+// Eine Probe starten. Rückgabe: Sequenznummer oder -1 (errno).
+// *refused = 1: Port sofort abgelehnt (TCP, meist lokale Ziele); on_refused
+// kommt dann nicht, der Aufrufer trägt die Probe ein und meldet sie selbst
+int conn_send(ConnProbe *c, int64_t now_us, int *refused);
+
+// Offene Probe aufgeben (vom Tracker als verloren gezählt)
+void conn_abort(ConnProbe *c, uint16_t seq);
+
+void conn_close(ConnProbe *c);
+
+const char *conn_kind_name(ConnKind kind);
+
+#endif
@@ -0,0 +1,381 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Gepufferte Datensätze für den Betrieb ohne Oberfläche (siehe emit.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <arpa/inet.h>
+
+#include "emit.h"
+#include "icmp.h"
+
+#define PUT_LIT(p, s) (memcpy((p), (s), sizeof(s) - 1), (p) + sizeof(s) - 1)
+
+const char *emit_format_name(EmitFormat format) {
+    return format == EMIT_BINARY ? "binary" : "json";
+}
+
+// ========== ZAHLEN OHNE PRINTF ==========
+
+static char *put_u64(char *p, uint64_t v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+// Mikrosekunden als Millisekunden mit drei Nachkommastellen
+static char *put_ms(char *p, uint32_t us) {
+    p = put_u64(p, us / 1000);
+    uint32_t frac = us % 1000;
+    *p++ = '.';
+    *p++ = (char)('0' + frac / 100);
+    *p++ = (char)('0' + frac / 10 % 10);
+    *p++ = (char)('0' + frac % 10);
+    return p;
+}
+
+static uint32_t ms_to_us(double ms) {
+    if (ms <= 0) return 0;
+    if (ms >= 4294967.0) return UINT32_MAX;
+    return (uint32_t)(ms * 1000.0 + 0.5);
+}
+
+// ========== SCHREIBEN ==========
+
+static int write_all(Emitter *e, const char *data, size_t len) {
+    if (e->error) {
+        e->dropped += len;
+        return -1;
+    }
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = write(e->fd, data + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            e->error = errno;
+            e->dropped += len - off;
+            return -1;
+        }
+        off += (size_t)n;
+        e->bytes += (uint64_t)n;
+        e->writes++;
+    }
+    return 0;
+}
+
+int emit_flush(Emitter *e) {
+    if (!e->buf || e->len == 0) return e->error ? -1 : 0;
+    int rc = write_all(e, e->buf, e->len);
+    e->len = 0;
+    return rc;
+}
+
+// Datensatz liegt ab e->buf + e->len bis end: übernehmen, ggf. schreiben
+static void commit(Emitter *e, char *end) {
+    e->len = (size_t)(end - e->buf);
+    e->records++;
+    if (e->len >= e->flush_bytes) {
+        emit_flush(e);
+    } else if (!e->flush_armed) {
+        ev_timer_arm(e->flush_timer.fd, e->flush_ms * 1000, 0);
+        e->flush_armed = 1;
+    }
+}
+
+// Platz für einen weiteren Datensatz schaffen
+static char *reserve(Emitter *e) {
+    if (e->len + EMIT_RECORD_MAX > EMIT_BUF_SIZE) emit_flush(e);
+    return e->buf + e->len;
+}
+
+static void put_record(Emitter *e, const EmitRecord *r) {
+    char *p = reserve(e);
+    memcpy(p, r, sizeof(*r));
+    commit(e, p + sizeof(*r));
+}
+
+static char *json_begin(Emitter *e, uint32_t id, int64_t ts_ms) {
+    char *p = reserve(e);
+    p = PUT_LIT(p, "{\"ts\":");
+    p = put_u64(p, ts_ms > 0 ? (uint64_t)ts_ms : 0);
+    memcpy(p, e->names[id].json, e->names[id].json_len);
+    return p + e->names[id].json_len;
+}
+
+static void json_end(Emitter *e, char *p) {
+    p = PUT_LIT(p, "}\n");
+    commit(e, p);
+}
+
+// ========== DATENSÄTZE ==========
+
+void emit_probe(Emitter *e, uint32_t id, int64_t ts_ms, int seq, int ttl, uint32_t rtt_us) {
+    if (!e->buf || id >= e->count) return;
+    e->probes++;
+
+    if (e->interval_ms) {
+        EmitAgg *a = &e->agg[id];
+        a->sent++;
+        if (rtt_us) lat_add(&a->lat, rtt_us / 1000.0);
+        return;
+    }
+
+    if (e->format == EMIT_BINARY) {
+        EmitRecord r;
+        memset(&r, 0, sizeof(r));
+        r.ts_ms = ts_ms;
+        r.target = id;
+        r.type = rtt_us ? EMIT_REC_REPLY : EMIT_REC_LOST;
+        r.ttl = ttl > 0 && ttl < 256 ? (uint8_t)ttl : 0;
+        r.seq = seq >= 0 ? (uint16_t)seq : 0;
+        r.u.rtt_us = rtt_us;
+        put_record(e, &r);
+        return;
+    }
+
+    char *p = json_begin(e, id, ts_ms);
+    if (seq >= 0) {
+        p = PUT_LIT(p, ",\"seq\":");
+        p = put_u64(p, (uint64_t)seq);
+    }
+    if (rtt_us == 0) {
+        p = PUT_LIT(p, ",\"lost\":true");
+    } else {
+        if (ttl > 0) {
+            p = PUT_LIT(p, ",\"ttl\":");
+            p = put_u64(p, (uint64_t)ttl);
+        }
+        p = PUT_LIT(p, ",\"rtt_ms\":");
+        p = put_ms(p, rtt_us);
+    }
+    json_end(e, p);
+}
+
+void emit_address(Emitter *e, uint32_t id, int64_t ts_ms, const char *addr) {
+    if (!e->buf || id >= e->count) return;
+
+    if (e->format == EMIT_BINARY) {
+        EmitRecord r;
+        memset(&r, 0, sizeof(r));
+        r.ts_ms = ts_ms;
+        r.target = id;
+        r.type = EMIT_REC_ADDRESS;
+        if (inet_pton(AF_INET, addr, r.u.addr.addr) == 1) r.u.addr.family = 4;
+        else if (inet_pton(AF_INET6, addr, r.u.addr.addr) == 1) r.u.addr.family = 6;
+        put_record(e, &r);
+        return;
+    }
+
+    char *p = json_begin(e, id, ts_ms);
+    size_t n = strnlen(addr, INET6_ADDRSTRLEN);
+    p = PUT_LIT(p, ",\"addr\":\"");
+    memcpy(p, addr, n);
+    p += n;
+    *p++ = '"';
+    json_end(e, p);
+}
+
+// Alle Ziele mit Probes im Intervall zusammenfassen, dann neu beginnen
+static void emit_interval(Emitter *e, int64_t ts_ms) {
+    for (size_t i = 0; i < e->count; i++) {
+        EmitAgg *a = &e->agg[i];
+        if (a->sent == 0) continue;
+
+        uint32_t recv = (uint32_t)a->lat.count;
+        uint32_t min_us = 0, avg_us = 0, max_us = 0, p99_us = 0;
+        if (recv) {
+            min_us = ms_to_us(a->lat.min);
+            avg_us = ms_to_us(a->lat.mean);
+            max_us = ms_to_us(a->lat.max);
+            p99_us = ms_to_us(lat_percentile(&a->lat, 99));
+        }
+
+        if (e->format == EMIT_BINARY) {
+            EmitRecord r;
+            memset(&r, 0, sizeof(r));
+            r.ts_ms = ts_ms;
+            r.target = (uint32_t)i;
+            r.type = EMIT_REC_INTERVAL;
+            r.u.iv.sent = a->sent;
+            r.u.iv.recv = recv;
+            r.u.iv.min_us = min_us;
+            r.u.iv.avg_us = avg_us;
+            r.u.iv.max_us = max_us;
+            r.u.iv.p99_us = p99_us;
+            put_record(e, &r);
+        } else {
+            // Verlust in Promille, gerundet
+            uint64_t permille = ((uint64_t)(a->sent - recv) * 2000 + a->sent) / (2 * (uint64_t)a->sent);
+            char *p = json_begin(e, (uint32_t)i, ts_ms);
+            p = PUT_LIT(p, ",\"interval_ms\":");
+            p = put_u64(p, (uint64_t)e->interval_ms);
+            p = PUT_LIT(p, ",\"sent\":");
+            p = put_u64(p, a->sent);
+            p = PUT_LIT(p, ",\"recv\":");
+            p = put_u64(p, recv);
+            p = PUT_LIT(p, ",\"loss_pct\":");
+            p = put_u64(p, permille / 10);
+            *p++ = '.';
+            *p++ = (char)('0' + permille % 10);
+            if (recv) {
+                p = PUT_LIT(p, ",\"min_ms\":");
+                p = put_ms(p, min_us);
+                p = PUT_LIT(p, ",\"avg_ms\":");
+                p = put_ms(p, avg_us);
+                p = PUT_LIT(p, ",\"max_ms\":");
+                p = put_ms(p, max_us);
+                p = PUT_LIT(p, ",\"p99_ms\":");
+                p = put_ms(p, p99_us);
+            }
+            json_end(e, p);
+        }
+        a->sent = 0;
+        lat_reset(&a->lat);
+    }
+}
+
+// ========== TIMER ==========
+
+static void on_flush_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    Emitter *e = h->ctx;
+    ev_timer_read(h->fd);
+    e->flush_armed = 0;
+    emit_flush(e);
+}
+
+// Intervallende auf volle Vielfache von interval_ms der Wanduhr gerundet
+static void on_interval_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    Emitter *e = h->ctx;
+    if (ev_timer_read(h->fd) == 0) return;
+    int64_t now_ms = wall_ms();
+    emit_interval(e, (now_ms + e->interval_ms / 2) / e->interval_ms * e->interval_ms);
+}
+
+static void set_name(EmitName *n, const char *name) {
+    snprintf(n->raw, sizeof(n->raw), "%s", name);
+    char *p = PUT_LIT(n->json, ",\"target\":\"");
+    for (const unsigned char *s = (const unsigned char *)n->raw; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            *p++ = '\\';
+            *p++ = (char)*s;
+        } else if (*s < 0x20) {
+            p += sprintf(p, "\\u%04x", *s);
+        } else {
+            *p++ = (char)*s;
+        }
+    }
+    *p++ = '"';
+    n->json_len = (uint16_t)(p - n->json);
+}
+
+static int add_timer(Emitter *e, EvHandler *h, EvCallback cb) {
+    h->fd = ev_timer_new();
+    if (h->fd == -1) return -1;
+    h->cb = cb;
+    h->ctx = e;
+    return ev_add(e->loop, h, EPOLLIN);
+}
+
+// Binär: Header und Namen direkt schreiben (können größer als der Puffer sein)
+static int write_header(Emitter *e) {
+    size_t size = sizeof(EmitHeader) + e->count * EMIT_NAME_SIZE;
+    char *block = calloc(1, size);
+    if (!block) return -1;
+
+    EmitHeader *hdr = (EmitHeader *)block;
+    memcpy(hdr->magic, EMIT_MAGIC, sizeof(hdr->magic));
+    hdr->version = EMIT_VERSION;
+    hdr->header_size = sizeof(EmitHeader);
+    hdr->record_size = sizeof(EmitRecord);
+    hdr->name_size = EMIT_NAME_SIZE;
+    hdr->count = (uint32_t)e->count;
+    hdr->interval_ms = (uint32_t)e->interval_ms;
+    hdr->created_ms = wall_ms();
+    for (size_t i = 0; i < e->count; i++) {
+        memcpy(block + sizeof(EmitHeader) + i * EMIT_NAME_SIZE, e->names[i].raw, EMIT_NAME_SIZE);
+    }
+    int rc = write_all(e, block, size);
+    free(block);
+    if (rc == -1) errno = e->error;
+    return rc;
+}
+
+int emit_open(Emitter *e, EvLoop *loop, int fd, EmitFormat format,
+              const char *const *names, size_t count, int64_t interval_ms) {
+    size_t flush_bytes = e->flush_bytes;
+    int64_t flush_ms = e->flush_ms;
+    memset(e, 0, sizeof(*e));
+    e->flush_bytes = flush_bytes > 0 ? flush_bytes : EMIT_FLUSH_BYTES;
+    if (e->flush_bytes > EMIT_BUF_SIZE - EMIT_RECORD_MAX) e->flush_bytes = EMIT_BUF_SIZE - EMIT_RECORD_MAX;
+    e->flush_ms = flush_ms > 0 ? flush_ms : EMIT_FLUSH_MS;
+    e->loop = loop;
+    e->fd = fd;
+    e->format = format;
+    e->interval_ms = interval_ms;
+    e->count = count;
+    e->flush_timer.fd = -1;
+    e->interval_timer.fd = -1;
+
+    e->buf = malloc(EMIT_BUF_SIZE);
+    e->names = calloc(count, sizeof(*e->names));
+    if (interval_ms) e->agg = calloc(count, sizeof(*e->agg));
+    if (!e->buf || !e->names || (interval_ms && !e->agg)) goto fail;
+    for (size_t i = 0; i < count; i++) {
+        set_name(&e->names[i], names[i]);
+        if (interval_ms) lat_reset(&e->agg[i].lat);
+    }
+
+    if (add_timer(e, &e->flush_timer, on_flush_timer) == -1) goto fail;
+    if (interval_ms) {
+        if (add_timer(e, &e->interval_timer, on_interval_timer) == -1) goto fail;
+        int64_t now_ms = wall_ms();
+        ev_timer_arm(e->interval_timer.fd, (interval_ms - now_ms % interval_ms) * 1000, interval_ms * 1000);
+    }
+    if (format == EMIT_BINARY && write_header(e) == -1) goto fail;
+    return 0;
+
+fail: {
+        int err = errno;
+        emit_close(e);
+        errno = err;
+        return -1;
+    }
+}
+
+void emit_close(Emitter *e) {
+    if (!e->loop) return;
+    if (e->buf) {
+        if (e->agg) emit_interval(e, wall_ms());
+        emit_flush(e);
+    }
+    EvHandler *timers[] = { &e->flush_timer, &e->interval_timer };
+    for (int i = 0; i < 2; i++) {
+        if (timers[i]->fd < 0) continue;
+        ev_del(e->loop, timers[i]);
+        close(timers[i]->fd);
+        timers[i]->fd = -1;
+    }
+    free(e->buf);
+    free(e->names);
+    free(e->agg);
+    e->buf = NULL;
+    e->names = NULL;
+    e->agg = NULL;
+    e->loop = NULL;
+}
@@ -0,0 +1,141 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Ausgabe ohne Oberfläche (--headless): pro Probe oder pro
+ * Aggregationsintervall ein Datensatz, als JSON-Zeile oder binär mit fester
+ * Größe. Datensätze sammeln sich in einem Puffer und gehen mit einem
+ * write() hinaus, sobald flush_bytes erreicht sind oder der älteste
+ * gepufferte Datensatz flush_ms alt ist. Läuft im Eventloop des Aufrufers
+ * mit eigenen timerfds für Flush und Intervallende.
+ *
+ * Binärformat (Byte-Reihenfolge der Maschine): EmitHeader, dahinter count
+ * Zielnamen zu EMIT_NAME_SIZE Bytes (nullterminiert), dann EmitRecord.
+ */
+
+#ifndef PINGMON_EMIT_H
+#define PINGMON_EMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "evloop.h"
+#include "stats.h"
+
+#define EMIT_MAGIC       "PMONREC1"
+#define EMIT_VERSION     1
+#define EMIT_NAME_SIZE   64
+#define EMIT_BUF_SIZE    (256 * 1024)
+#define EMIT_RECORD_MAX  1024       // längste JSON-Zeile (Name maskiert)
+#define EMIT_FLUSH_BYTES (64 * 1024)
+#define EMIT_FLUSH_MS    1000
+
+typedef enum {
+    EMIT_JSON = 0,
+    EMIT_BINARY
+} EmitFormat;
+
+typedef enum {
+    EMIT_REC_REPLY = 0,
+    EMIT_REC_LOST,
+    EMIT_REC_INTERVAL,       // Zusammenfassung eines Aggregationsintervalls
+    EMIT_REC_ADDRESS         // erste bzw. neue Adresse des Ziels
+} EmitRecordType;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;    // bis zum ersten Namen
+    uint32_t record_size;
+    uint32_t name_size;
+    uint32_t count;          // Ziele bzw. Namen
+    uint32_t interval_ms;    // 0 = ein Datensatz pro Probe
+    int64_t created_ms;
+} EmitHeader;
+
+typedef struct {
+    int64_t ts_ms;           // Wanduhr; INTERVAL: Ende des Intervalls
+    uint32_t target;         // Index der Namen, Einzelziel 0
+    uint8_t type;            // EmitRecordType
+    uint8_t ttl;             // 0 = unbekannt
+    uint16_t seq;            // REPLY/LOST
+    union {
+        uint32_t rtt_us;     // REPLY
+        struct {
+            uint32_t sent;
+            uint32_t recv;
+            uint32_t min_us;
+            uint32_t avg_us;
+            uint32_t max_us;
+            uint32_t p99_us;
+        } iv;                // INTERVAL, RTTs nur mit recv > 0
+        struct {
+            uint8_t family;  // 4 oder 6
+            uint8_t reserved[3];
+            uint8_t addr[16];
+        } addr;              // ADDRESS
+    } u;
+} EmitRecord;
+
+// Ziel im laufenden Intervall
+typedef struct {
+    uint32_t sent;
+    LatencyStats lat;
+} EmitAgg;
+
+// Name, für JSON fertig maskiert als ,"target":"..."
+typedef struct {
+    char raw[EMIT_NAME_SIZE];
+    uint16_t json_len;
+    char json[EMIT_NAME_SIZE * 6 + 16];
+} EmitName;
+
+typedef struct {
+    // Vor emit_open setzen, 0 = Standard
+    size_t flush_bytes;
+    int64_t flush_ms;
+
+    EvLoop *loop;
+    int fd;
+    EmitFormat format;
+    int64_t interval_ms;     // Aggregation, 0 = pro Probe
+    EvHandler flush_timer;
+    EvHandler interval_timer;
+    int flush_armed;
+
+    size_t count;
+    EmitName *names;
+    EmitAgg *agg;            // nur mit interval_ms
+
+    char *buf;
+    size_t len;
+
+    uint64_t probes;         // Antworten und Verluste, auch aggregiert
+    uint64_t records;
+    uint64_t bytes;          // geschrieben
+    uint64_t writes;
+    uint64_t dropped;        // nach einem Schreibfehler verworfene Bytes
+    int error;               // errno des ersten Schreibfehlers, 0 = OK
+} Emitter;
+
+// Ausgabe nach fd mit count Zielen starten (Binär: Header sofort in den
+// Puffer). 0 = OK, -1 = Fehler (errno)
+int emit_open(Emitter *e, EvLoop *loop, int fd, EmitFormat format,
+              const char *const *names, size_t count, int64_t interval_ms);
+
+// Probe von Ziel id: rtt_us = 0 verloren, seq/ttl < 0 unbekannt
+void emit_probe(Emitter *e, uint32_t id, int64_t ts_ms, int seq, int ttl, uint32_t rtt_us);
+
+// Adresse (IPv4/IPv6 als Text) von Ziel id
+void emit_address(Emitter *e, uint32_t id, int64_t ts_ms, const char *addr);
+
+// Puffer schreiben. 0 = OK, -1 = Fehler (e->error)
+int emit_flush(Emitter *e);
+
+// Angefangenes Intervall ausgeben, Rest schreiben, Timer abmelden.
+// fd bleibt offen (gehört dem Aufrufer)
+void emit_close(Emitter *e);
+
+const char *emit_format_name(EmitFormat format);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Minimaler epoll-Eventloop (siehe evloop.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#include "evloop.h"
+
+#define EV_MAX_EVENTS 32
+
+// Pro Thread, jeder Eventloop läuft in genau einem
+static __thread uint64_t syscalls;
+
+uint64_t ev_syscalls(void) {
+    return syscalls;
+}
+
+int ev_init(EvLoop *loop) {
+    loop->wakeups = 0;
+    loop->events = 0;
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    return loop->epfd < 0 ? -1 : 0;
+}
+
+void ev_close(EvLoop *loop) {
+    if (loop->epfd >= 0) {
+        close(loop->epfd);
+        loop->epfd = -1;
+    }
+}
+
+int ev_add(EvLoop *loop, EvHandler *h, uint32_t events) {
+    struct epoll_event ev = {0};
+    ev.events = events;
+    ev.data.ptr = h;
+    syscalls++;
+    return epoll_ctl(loop->epfd, EPOLL_CTL_ADD, h->fd, &ev);
+}
+
+int ev_mod(EvLoop *loop, EvHandler *h, uint32_t events) {
+    struct epoll_event ev = {0};
+    ev.events = events;
+    ev.data.ptr = h;
+    syscalls++;
+    return epoll_ctl(loop->epfd, EPOLL_CTL_MOD, h->fd, &ev);
+}
+
+void ev_del(EvLoop *loop, EvHandler *h) {
+    syscalls++;
+    epoll_ctl(loop->epfd, EPOLL_CTL_DEL, h->fd, NULL);
+}
+
+int ev_run_once(EvLoop *loop, int timeout_ms) {
+    struct epoll_event evs[EV_MAX_EVENTS];
+
+    int n = epoll_wait(loop->epfd, evs, EV_MAX_EVENTS, timeout_ms);
+    syscalls++;
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    loop->wakeups++;
+    loop->events += (uint64_t)n;
+
+    for (int i = 0; i < n; i++) {
+        EvHandler *h = evs[i].data.ptr;
+        h->cb(h, evs[i].events);
+    }
+    return n;
+}
+
+int ev_timer_new(void) {
+    return timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+}
+
+int ev_timer_arm(int fd, int64_t first_us, int64_t interval_us) {
+    struct itimerspec its = {0};
+
+    // 0 würde den Timer stoppen: minimale Wartezeit stattdessen
+    if (first_us <= 0 && interval_us > 0) first_us = 1;
+
+    its.it_value.tv_sec = first_us / 1000000;
+    its.it_value.tv_nsec = (first_us % 1000000) * 1000;
+    its.it_interval.tv_sec = interval_us / 1000000;
+    its.it_interval.tv_nsec = (interval_us % 1000000) * 1000;
+    syscalls++;
+    return timerfd_settime(fd, 0, &its, NULL);
+}
+
+uint64_t ev_timer_read(int fd) {
+    uint64_t expirations = 0;
+    syscalls++;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return 0;
+    }
+    return expirations;
+}
+
+int ev_signal_new(const sigset_t *mask) {
+    if (sigprocmask(SIG_BLOCK, mask, NULL) == -1) {
+        return -1;
+    }
+    return signalfd(-1, mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
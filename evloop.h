@@ -0,0 +1,55 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Minimaler epoll-Eventloop mit timerfd/signalfd-Helfern.
+ */
+
+#ifndef PINGMON_EVLOOP_H
+#define PINGMON_EVLOOP_H
+
+#include <stdint.h>
+#include <signal.h>
+
+typedef struct EvHandler EvHandler;
+typedef void (*EvCallback)(EvHandler *h, uint32_t events);
+
+// Wird als epoll_data.ptr registriert
+struct EvHandler {
+    int fd;
+    EvCallback cb;
+    void *ctx;
+};
+
+typedef struct {
+    int epfd;
+    uint64_t wakeups;        // Rückkehr aus epoll_wait
+    uint64_t events;         // Verteilte Events
+} EvLoop;
+
+int ev_init(EvLoop *loop);
+void ev_close(EvLoop *loop);
+
+int ev_add(EvLoop *loop, EvHandler *h, uint32_t events);
+int ev_mod(EvLoop *loop, EvHandler *h, uint32_t events);
+void ev_del(EvLoop *loop, EvHandler *h);
+
+// Einmal warten und alle Events verteilen. timeout_ms = -1: unbegrenzt
+int ev_run_once(EvLoop *loop, int timeout_ms);
+
+// timerfd (CLOCK_MONOTONIC, non-blocking)
+int ev_timer_new(void);
+// Erste Auslösung nach first_us, danach alle interval_us (0 = einmalig).
+// first_us = 0 und interval_us = 0 stoppt den Timer.
+int ev_timer_arm(int fd, int64_t first_us, int64_t interval_us);
+// Anzahl Auslösungen seit dem letzten Lesen (0 wenn keine)
+uint64_t ev_timer_read(int fd);
+
+// Syscalls des aufrufenden Threads über die Funktionen hier (epoll, timerfd),
+// für die Eigenmessung
+uint64_t ev_syscalls(void);
+
+// Signale blockieren und als signalfd zurückgeben
+int ev_signal_new(const sigset_t *mask);
+
+#endif
@@ -0,0 +1,838 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Mehrzielbetrieb mit Worker-Threads (siehe fleet.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "fleet.h"
+#include "icmp.h"
+#include "seqtrack.h"
+#include "spsc.h"
+#include "twheel.h"
+
+#define FLEET_OUT_BATCH 256         // Samples, die ein Worker vor dem Veröffentlichen sammelt
+
+typedef struct {
+    FleetWorker *worker;
+    uint32_t target;
+    uint16_t next_seq;
+    int64_t base_interval_us;    // eingestelltes Intervall des Ziels
+    int64_t interval_us;         // aktuell, nach Zustand und Obergrenze
+    int64_t base_us;         // geplanter Sendezeitpunkt ohne Jitter (driftfrei)
+    int64_t jitter_us;       // höchstens so viel früher/später
+    TwTimer send_timer;
+    TwTimer expire_timer;    // nächste offene Probe läuft ab
+    SeqTracker tracker;
+
+    // Adaptiver Modus
+    uint64_t outcomes;       // letzte 64 Ergebnisse, Bit gesetzt = verloren, neuestes in Bit 0
+    uint8_t noutcomes;
+    uint8_t health;          // FleetHealth
+    uint8_t calm;            // Ergebnisse in Folge, die eine niedrigere Stufe erlauben
+    float srtt_ms;           // geglättete RTT (1/8 wie bei TCP)
+} WorkerProbe;
+
+#define container_of(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+
+struct FleetWorker {
+    Fleet *fleet;
+    int index;
+    int cpu;                 // -1 = nicht gebunden
+    pthread_t tid;
+    int started;
+    int running;
+
+    // Nur im Worker-Thread
+    EvLoop loop;
+    EvHandler icmp_handler;
+    EvHandler timer_handler;     // ein timerfd für das ganze Timer-Rad
+    EvHandler stop_handler;
+    IcmpEngine icmp;
+    TimerWheel wheel;
+    int64_t armed_us;        // Zeitpunkt, auf den timer_handler steht, -1 = aus
+    int64_t now_us;          // Zeit des gerade bearbeiteten Ereignisses
+    uint64_t rng;
+    WorkerProbe *probes;
+    size_t nprobes;
+    uint32_t *slots;         // Adresse -> Index in probes + 1, offene Adressierung
+    uint32_t slot_mask;
+    IcmpProbe batch[ICMP_BATCH];     // fällige Probes für das nächste sendmmsg
+    WorkerProbe *batch_owner[ICMP_BATCH];
+    int nbatch;
+    FleetSample out[FLEET_OUT_BATCH];
+    size_t nout;
+
+    // Senderate: Summe nach Zustand der Ziele, gedeckelt auf cap
+    int64_t demand_mhz;      // Probes/s * 1000
+    double cap;              // Anteil an Fleet.max_rate, 0 = unbegrenzt
+    double tokens;           // Token-Bucket, fängt Spitzen beim Umstufen ab
+    int64_t tokens_us;
+
+    // Übergabe an den UI-Thread
+    SpscQueue queue;
+    int notify_pending;      // atomar: Weckruf unterwegs
+    uint64_t dropped;        // atomar gelesen
+    uint64_t skipped;        // atomar gelesen: wegen cap ausgelassene Probes
+    uint64_t rate_mhz;       // atomar gelesen: geplante Probes/s * 1000
+    EvHandler notify_handler;    // im UI-Loop
+};
+
+static inline uint32_t addr_hash(uint32_t a) {
+    a ^= a >> 16;
+    a *= 0x7feb352d;
+    a ^= a >> 15;
+    a *= 0x846ca68b;
+    a ^= a >> 16;
+    return a;
+}
+
+// ========== ZIELLISTE ==========
+
+int fleet_load(Fleet *f, const char *path, int *bad_line) {
+    FILE *in = fopen(path, "r");
+    if (!in) return -1;
+
+    size_t cap = 0;
+    int *lines = NULL;       // Zeilennummer je Ziel, für die Meldung doppelter Adressen
+    char line[256];
+    int lineno = 0;
+    int rc = 0;
+
+    f->targets = NULL;
+    f->count = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *save;
+        char *addr = strtok_r(line, " \t\r\n", &save);
+        if (!addr) continue;
+        char *name = strtok_r(NULL, "\r\n", &save);
+        while (name && (*name == ' ' || *name == '\t')) name++;
+
+        // Optional als letztes Wort: eigenes Intervall "interval=MS"
+        int64_t interval_us = 0;
+        if (name) {
+            char *end = name + strlen(name);
+            while (end > name && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+            char *word = end;
+            while (word > name && word[-1] != ' ' && word[-1] != '\t') word--;
+            if (strncmp(word, "interval=", 9) == 0) {
+                char *endptr;
+                double ms = strtod(word + 9, &endptr);
+                if (*endptr != '\0' || ms * 1000.0 < FLEET_MIN_INTERVAL_US) {
+                    *bad_line = lineno;
+                    rc = -2;
+                    break;
+                }
+                interval_us = (int64_t)(ms * 1000.0);
+                *word = '\0';
+                while (word > name && (word[-1] == ' ' || word[-1] == '\t')) *--word = '\0';
+            }
+        }
+
+        if (f->count == cap) {
+            size_t n = cap ? cap * 2 : 64;
+            FleetTarget *t = realloc(f->targets, n * sizeof(*t));
+            if (t) f->targets = t;
+            int *l = realloc(lines, n * sizeof(*l));
+            if (l) lines = l;
+            if (!t || !l) {
+                rc = -1;
+                break;
+            }
+            cap = n;
+        }
+        FleetTarget *t = &f->targets[f->count];
+        memset(t, 0, sizeof(*t));
+        t->addr.sin_family = AF_INET;
+        if (inet_pton(AF_INET, addr, &t->addr.sin_addr) != 1) {
+            *bad_line = lineno;
+            rc = -2;
+            break;
+        }
+        snprintf(t->name, sizeof(t->name), "%s", name && *name ? name : addr);
+        t->interval_us = interval_us;
+        lat_reset(&t->lat);
+        lines[f->count++] = lineno;
+    }
+    fclose(in);
+    if (rc != 0) {
+        free(lines);
+        return rc;
+    }
+
+    // Doppelte Adressen ließen sich den Antworten nicht zuordnen
+    uint32_t mask = 1;
+    while (mask < f->count * 2) mask <<= 1;
+    uint32_t *seen = calloc(mask, sizeof(*seen));
+    if (!seen) {
+        free(lines);
+        return -1;
+    }
+    mask--;
+    for (size_t i = 0; i < f->count && rc == 0; i++) {
+        uint32_t a = f->targets[i].addr.sin_addr.s_addr;
+        for (uint32_t h = addr_hash(a) & mask;; h = (h + 1) & mask) {
+            if (seen[h] == 0) {
+                seen[h] = (uint32_t)i + 1;
+                break;
+            }
+            if (f->targets[seen[h] - 1].addr.sin_addr.s_addr == a) {
+                *bad_line = lines[i];
+                rc = -2;
+                break;
+            }
+        }
+    }
+    free(seen);
+    free(lines);
+    if (rc == 0 && rank_init(&f->rank, (uint32_t)f->count) == -1) rc = -1;
+    return rc;
+}
+
+void fleet_free(Fleet *f) {
+    rank_free(&f->rank);
+    free(f->targets);
+    f->targets = NULL;
+    f->count = 0;
+}
+
+void fleet_reset(Fleet *f) {
+    for (size_t i = 0; i < f->count; i++) {
+        FleetTarget *t = &f->targets[i];
+        lat_reset(&t->lat);
+        t->sent = t->recv = t->dup = t->reordered = t->late = 0;
+        t->last = t->sum = 0;
+        t->hist_count = 0;
+    }
+    f->sent = f->recv = 0;
+    fleet_set_rank(f, f->rank_key);
+}
+
+uint64_t fleet_dropped(const Fleet *f) {
+    uint64_t sum = f->dropped;
+    for (int i = 0; i < f->nworkers; i++) {
+        sum += __atomic_load_n(&f->workers[i].dropped, __ATOMIC_RELAXED);
+    }
+    return sum;
+}
+
+double fleet_rate(const Fleet *f) {
+    uint64_t sum = 0;
+    for (int i = 0; i < f->nworkers; i++) {
+        sum += __atomic_load_n(&f->workers[i].rate_mhz, __ATOMIC_RELAXED);
+    }
+    return (double)sum / 1000.0;
+}
+
+uint64_t fleet_skipped(const Fleet *f) {
+    uint64_t sum = f->skipped;
+    for (int i = 0; i < f->nworkers; i++) {
+        sum += __atomic_load_n(&f->workers[i].skipped, __ATOMIC_RELAXED);
+    }
+    return sum;
+}
+
+// ========== RANGLISTE ==========
+
+double fleet_rank_value(const FleetTarget *t, FleetRankKey key) {
+    switch (key) {
+    case FLEET_RANK_LAST:
+        return fleet_hist_at(t, 0) == 0 ? INFINITY : t->last;
+    case FLEET_RANK_AVG:
+        return t->recv > 0 ? t->sum / (double)t->recv : 0.0;
+    case FLEET_RANK_P99:
+        return lat_percentile(&t->lat, 99);
+    case FLEET_RANK_LOSS:
+        return fleet_loss(t);
+    case FLEET_RANK_STABILITY:
+        return 100.0 - calculate_stability(fleet_loss(t));
+    default:
+        return 0.0;
+    }
+}
+
+const char *fleet_rank_name(FleetRankKey key) {
+    static const char *names[FLEET_RANK_KEYS] = { "last", "avg", "p99", "loss", "stability" };
+    return key < FLEET_RANK_KEYS ? names[key] : "?";
+}
+
+void fleet_set_rank(Fleet *f, FleetRankKey key) {
+    f->rank_key = key;
+    for (size_t i = 0; i < f->count; i++) {
+        rank_set(&f->rank, (uint32_t)i, fleet_rank_value(&f->targets[i], key));
+    }
+}
+
+// ========== WORKER ==========
+
+// Gesammelte Samples veröffentlichen, UI-Thread höchstens einmal wecken
+static void flush_out(FleetWorker *w) {
+    if (w->nout == 0) return;
+
+    size_t n = spsc_push(&w->queue, w->out, w->nout);
+    if (n < w->nout) __atomic_fetch_add(&w->dropped, w->nout - n, __ATOMIC_RELAXED);
+    w->nout = 0;
+
+    if (n > 0 && __atomic_exchange_n(&w->notify_pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        uint64_t one = 1;
+        if (write(w->notify_handler.fd, &one, sizeof(one)) < 0) {
+            // eventfd läuft nicht über; bei Fehler holt der nächste Weckruf alles ab
+        }
+    }
+}
+
+static void emit(FleetWorker *w, const WorkerProbe *p, FleetSampleKind kind, uint16_t seq, int ttl, int64_t rtt_ns) {
+    FleetSample *s = &w->out[w->nout++];
+    s->target = p->target;
+    s->kind = (uint8_t)kind;
+    s->ttl = (uint8_t)(ttl > 0 && ttl < 256 ? ttl : 0);
+    s->seq = seq;
+    s->rtt_us = rtt_ns > 0 ? (uint32_t)((rtt_ns + 500) / 1000) : 0;
+    if (s->rtt_us == 0 && (kind == FLEET_REPLY || kind == FLEET_REORDERED)) s->rtt_us = 1;
+    s->interval_us = p->interval_us < UINT32_MAX ? (uint32_t)p->interval_us : UINT32_MAX;
+    s->ts_ms = wall_ms();
+    if (w->nout == FLEET_OUT_BATCH) flush_out(w);
+}
+
+// ========== ADAPTIVE RATE ==========
+
+// Sendeabstand für einen Zustand, ohne Obergrenze
+static int64_t level_interval(const WorkerProbe *p, int health) {
+    int64_t iv = p->base_interval_us;
+    if (health == FLEET_OK) iv *= FLEET_ADAPT_SLOW;
+    else if (health == FLEET_CRIT) iv /= FLEET_ADAPT_FAST;
+    return iv < FLEET_MIN_INTERVAL_US ? FLEET_MIN_INTERVAL_US : iv;
+}
+
+static int64_t level_mhz(const WorkerProbe *p, int health) {
+    return (int64_t)(1e9 / (double)level_interval(p, health) + 0.5);
+}
+
+// Sendeabstand mit der Obergrenze: übersteigt die Summe cap, werden alle
+// Intervalle im selben Verhältnis gestreckt
+static int64_t effective_interval(const FleetWorker *w, const WorkerProbe *p) {
+    int64_t iv = level_interval(p, p->health);
+    double demand = (double)w->demand_mhz / 1000.0;
+    if (w->cap > 0 && demand > w->cap) iv = (int64_t)((double)iv * demand / w->cap);
+    return iv;
+}
+
+static void publish_rate(FleetWorker *w) {
+    double demand = (double)w->demand_mhz / 1000.0;
+    double rate = w->cap > 0 && demand > w->cap ? w->cap : demand;
+    __atomic_store_n(&w->rate_mhz, (uint64_t)(rate * 1000.0), __ATOMIC_RELAXED);
+}
+
+// Streuung um den Sendetermin: ein Viertel des Abstands zweier Ziele, höchstens 5 %
+static int64_t spread_jitter(const FleetWorker *w, int64_t interval_us) {
+    int64_t spacing = interval_us / (int64_t)w->fleet->count;
+    return spacing / 4 < interval_us / 20 ? spacing / 4 : interval_us / 20;
+}
+
+// Gleichverteilt in [-max, +max] (xorshift, nur für die Streuung)
+static int64_t jitter(FleetWorker *w, int64_t max) {
+    if (max <= 0) return 0;
+    w->rng ^= w->rng << 13;
+    w->rng ^= w->rng >> 7;
+    w->rng ^= w->rng << 17;
+    return (int64_t)(w->rng % (uint64_t)(2 * max + 1)) - max;
+}
+
+// Nach einem Wechsel der Stufe: nächsten Termin vom letzten Senden aus neu setzen
+static void reschedule(FleetWorker *w, WorkerProbe *p) {
+    int64_t iv = effective_interval(w, p);
+    int64_t next = p->base_us - p->interval_us + iv;
+    p->interval_us = iv;
+    p->jitter_us = spread_jitter(w, iv);
+    p->base_us = next > w->now_us ? next : w->now_us;
+    tw_add(&w->wheel, &p->send_timer, p->base_us + jitter(w, p->jitter_us));
+}
+
+// Ergebnis einer Probe verbuchen und das Ziel ggf. umstufen: CRIT ab
+// geglätteter RTT über crit oder Stabilität unter FLEET_ADAPT_CRIT_STABILITY,
+// WARN ab RTT über warn oder dem ersten Verlust im Fenster, sonst gesund.
+// Hochstufen sofort, Herabstufen erst nach FLEET_ADAPT_HOLD ruhigeren
+// Ergebnissen in Folge
+static void adapt(FleetWorker *w, WorkerProbe *p, int lost, int64_t rtt_ns) {
+    p->outcomes = (p->outcomes << 1) | (lost ? 1u : 0u);
+    if (p->noutcomes < 64) p->noutcomes++;
+    if (!lost) {
+        float rtt = (float)rtt_ns / 1e6f;
+        p->srtt_ms = p->srtt_ms > 0 ? p->srtt_ms + (rtt - p->srtt_ms) / 8 : rtt;
+    }
+
+    Fleet *f = w->fleet;
+    if (!f->adaptive) return;
+
+    double loss = __builtin_popcountll(p->outcomes) * 100.0 / p->noutcomes;
+    double stability = calculate_stability(loss);
+    int health = FLEET_OK;
+    if (p->srtt_ms >= f->crit_ms || stability < FLEET_ADAPT_CRIT_STABILITY) health = FLEET_CRIT;
+    else if (p->srtt_ms >= f->warn_ms || stability < 100.0) health = FLEET_WARN;
+    // Ganz ausgefallen: schneller proben zeigt nichts Neues
+    if ((p->outcomes & 0xff) == 0xff) health = FLEET_WARN;
+
+    if (health == p->health) {
+        p->calm = 0;
+        return;
+    }
+    if (health < p->health && ++p->calm < FLEET_ADAPT_HOLD) return;
+    p->calm = 0;
+
+    w->demand_mhz += level_mhz(p, health) - level_mhz(p, p->health);
+    p->health = (uint8_t)health;
+    publish_rate(w);
+    reschedule(w, p);
+}
+
+static void on_probe_lost(SeqTracker *t, uint16_t seq) {
+    FleetWorker *w = t->ctx;
+    WorkerProbe *p = container_of(t, WorkerProbe, tracker);
+    adapt(w, p, 1, 0);
+    emit(w, p, FLEET_LOST, seq, -1, 0);
+}
+
+static WorkerProbe *find_probe(FleetWorker *w, uint32_t addr) {
+    for (uint32_t h = addr_hash(addr) & w->slot_mask; w->slots[h]; h = (h + 1) & w->slot_mask) {
+        WorkerProbe *p = &w->probes[w->slots[h] - 1];
+        if (w->fleet->targets[p->target].addr.sin_addr.s_addr == addr) return p;
+    }
+    return NULL;
+}
+
+// timerfd auf den nächsten Termin des Rads stellen (nur bei Änderung)
+static void arm_wheel(FleetWorker *w, int64_t now_us) {
+    int64_t next = tw_next_us(&w->wheel);
+    if (next == w->armed_us) return;
+    w->armed_us = next;
+    if (next < 0) ev_timer_arm(w->timer_handler.fd, 0, 0);
+    else ev_timer_arm(w->timer_handler.fd, next > now_us ? next - now_us : 1, 0);
+}
+
+static void on_worker_icmp(EvHandler *h, uint32_t events) {
+    (void)events;
+    FleetWorker *w = h->ctx;
+    IcmpReply replies[ICMP_BATCH];
+    int n;
+
+    w->now_us = mono_us();
+    while ((n = icmp_recv_batch(&w->icmp, replies, ICMP_BATCH)) > 0) {
+        for (int i = 0; i < n; i++) {
+            WorkerProbe *p = find_probe(w, replies[i].from.s_addr);
+            if (!p) continue;
+
+            static const uint8_t kinds[] = {
+                [SEQ_REPLY_OK] = FLEET_REPLY,
+                [SEQ_REPLY_REORDERED] = FLEET_REORDERED,
+                [SEQ_REPLY_DUP] = FLEET_DUP,
+                [SEQ_REPLY_LATE] = FLEET_LATE,
+            };
+            SeqReplyKind kind = seq_reply(&p->tracker, replies[i].seq);
+            if (kind == SEQ_REPLY_UNKNOWN) continue;
+            if (kind == SEQ_REPLY_OK || kind == SEQ_REPLY_REORDERED) adapt(w, p, 0, replies[i].rtt_ns);
+            emit(w, p, kinds[kind], replies[i].seq, replies[i].ttl, replies[i].rtt_ns);
+        }
+        if (n < ICMP_BATCH) break;
+    }
+    flush_out(w);
+    arm_wheel(w, w->now_us);
+}
+
+// Gesammelte fällige Probes mit sendmmsg senden
+static void flush_sends(FleetWorker *w, int64_t now_us) {
+    int done = 0;
+    while (done < w->nbatch) {
+        int n = icmp_send_to(&w->icmp, w->batch + done, w->nbatch - done, now_us);
+        int ok = n > 0 ? n : 0;
+        for (int k = done; k < done + ok; k++) seq_sent(&w->batch_owner[k]->tracker, w->batch[k].seq, now_us);
+        if (n <= 0) {
+            // Dieses Ziel ist nicht erreichbar (z. B. keine Route): als verloren zählen
+            seq_sent(&w->batch_owner[done]->tracker, w->batch[done].seq, now_us);
+            seq_lost(&w->batch_owner[done]->tracker, w->batch[done].seq);
+            ok = 1;
+        }
+        // Ablauf der ältesten offenen Probe einplanen, falls nicht schon geschehen
+        for (int k = done; k < done + ok; k++) {
+            WorkerProbe *p = w->batch_owner[k];
+            if (!tw_pending(&p->expire_timer)) {
+                int64_t deadline = seq_next_deadline(&p->tracker, w->fleet->timeout_us);
+                if (deadline >= 0) tw_add(&w->wheel, &p->expire_timer, deadline);
+            }
+        }
+        done += ok;
+    }
+    w->nbatch = 0;
+}
+
+// Token-Bucket für die Obergrenze fasst eine Zehntelsekunde, mindestens eine Probe
+static double token_burst(const FleetWorker *w) {
+    return w->cap / 10 > 1 ? w->cap / 10 : 1;
+}
+
+// Obergrenze hart durchsetzen: ohne Token wird die Probe ausgelassen
+static int take_token(FleetWorker *w, int64_t now_us) {
+    if (w->cap <= 0) return 1;
+    w->tokens += (double)(now_us - w->tokens_us) * w->cap / 1e6;
+    w->tokens_us = now_us;
+    if (w->tokens > token_burst(w)) w->tokens = token_burst(w);
+    if (w->tokens < 1) return 0;
+    w->tokens -= 1;
+    return 1;
+}
+
+// Probe fällig: nächsten Termin driftfrei einplanen, dann in den Sendestapel
+// (ein Verlust beim Senden kann das Ziel schon umstufen)
+static void on_send_due(TwTimer *t, int64_t now_us) {
+    WorkerProbe *p = container_of(t, WorkerProbe, send_timer);
+    FleetWorker *w = p->worker;
+
+    // Obergrenze kann sich seit dem letzten Mal geändert haben
+    p->interval_us = effective_interval(w, p);
+    p->jitter_us = spread_jitter(w, p->interval_us);
+
+    // Verpasste Termine (Worker war blockiert) nicht nachholen
+    p->base_us += p->interval_us;
+    if (p->base_us <= now_us) p->base_us += ((now_us - p->base_us) / p->interval_us + 1) * p->interval_us;
+    tw_add(&w->wheel, t, p->base_us + jitter(w, p->jitter_us));
+
+    if (!take_token(w, now_us)) {
+        __atomic_fetch_add(&w->skipped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    w->batch[w->nbatch].dst = &w->fleet->targets[p->target].addr;
+    w->batch[w->nbatch].seq = p->next_seq++;
+    w->batch_owner[w->nbatch++] = p;
+    if (w->nbatch == ICMP_BATCH) flush_sends(w, now_us);
+}
+
+// Älteste offene Probe abgelaufen: verbuchen, nächsten Ablauf einplanen
+static void on_expire_due(TwTimer *t, int64_t now_us) {
+    WorkerProbe *p = container_of(t, WorkerProbe, expire_timer);
+    FleetWorker *w = p->worker;
+
+    seq_expire(&p->tracker, now_us, w->fleet->timeout_us);
+    int64_t deadline = seq_next_deadline(&p->tracker, w->fleet->timeout_us);
+    if (deadline >= 0) tw_add(&w->wheel, t, deadline);
+}
+
+static void on_worker_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    FleetWorker *w = h->ctx;
+    ev_timer_read(h->fd);
+
+    int64_t now_us = mono_us();
+    w->now_us = now_us;
+    w->armed_us = -1;
+    tw_advance(&w->wheel, now_us);
+    flush_sends(w, now_us);
+    flush_out(w);
+    arm_wheel(w, now_us);
+}
+
+static void on_worker_stop(EvHandler *h, uint32_t events) {
+    (void)events;
+    FleetWorker *w = h->ctx;
+    uint64_t v;
+    if (read(h->fd, &v, sizeof(v)) < 0) {
+        // Nur Weckruf
+    }
+    w->running = 0;
+}
+
+static void *worker_main(void *arg) {
+    FleetWorker *w = arg;
+
+    if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    // Erste Probe jedes Ziels nach seinem Platz in der Gesamtliste über das
+    // Intervall verteilt, damit alle Worker zusammen gleichmäßig senden
+    Fleet *f = w->fleet;
+    int64_t now_us = mono_us();
+    tw_init(&w->wheel, now_us, FLEET_TICK_US);
+    w->now_us = w->tokens_us = now_us;
+    w->tokens = token_burst(w);
+    w->rng = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)w->index << 32) ^ (uint64_t)now_us;
+    publish_rate(w);
+    for (size_t i = 0; i < w->nprobes; i++) {
+        WorkerProbe *p = &w->probes[i];
+        p->interval_us = effective_interval(w, p);
+        p->base_us = now_us + (int64_t)((double)p->interval_us * p->target / (double)f->count);
+        p->jitter_us = spread_jitter(w, p->interval_us);
+        tw_add(&w->wheel, &p->send_timer, p->base_us + jitter(w, p->jitter_us));
+    }
+    w->armed_us = -1;
+    arm_wheel(w, now_us);
+
+    while (w->running) {
+        if (ev_run_once(&w->loop, -1) == -1) break;
+    }
+    return NULL;
+}
+
+// ========== UI-SEITE ==========
+
+static void apply_sample(Fleet *f, const FleetSample *s) {
+    if (s->target >= f->count) return;
+    FleetTarget *t = &f->targets[s->target];
+    t->every_us = s->interval_us;
+
+    switch (s->kind) {
+    case FLEET_REORDERED:
+        t->reordered++;
+        // fallthrough
+    case FLEET_REPLY: {
+        double rtt = s->rtt_us / 1000.0;
+        t->sent++;
+        t->recv++;
+        f->sent++;
+        f->recv++;
+        t->last = rtt;
+        t->sum += rtt;
+        lat_add(&t->lat, rtt);
+        t->hist[t->hist_count++ % FLEET_HIST] = (float)rtt;
+        break;
+    }
+    case FLEET_LOST:
+        t->sent++;
+        f->sent++;
+        t->hist[t->hist_count++ % FLEET_HIST] = 0;
+        break;
+    case FLEET_DUP:
+        t->dup++;
+        break;
+    case FLEET_LATE:
+        t->late++;
+        break;
+    }
+    f->samples++;
+
+    if (s->kind == FLEET_REPLY || s->kind == FLEET_REORDERED || s->kind == FLEET_LOST) {
+        rank_set(&f->rank, s->target, fleet_rank_value(t, f->rank_key));
+    }
+    if (f->on_sample) f->on_sample(s);
+}
+
+static void on_queue_ready(EvHandler *h, uint32_t events) {
+    (void)events;
+    FleetWorker *w = h->ctx;
+    Fleet *f = w->fleet;
+    uint64_t v;
+    if (read(h->fd, &v, sizeof(v)) < 0 && errno != EAGAIN) return;
+
+    // Vor dem Leeren zurücksetzen: was danach kommt, weckt erneut
+    __atomic_exchange_n(&w->notify_pending, 0, __ATOMIC_ACQ_REL);
+
+    FleetSample batch[FLEET_OUT_BATCH];
+    size_t n, total = 0;
+    while ((n = spsc_pop(&w->queue, batch, FLEET_OUT_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) apply_sample(f, &batch[i]);
+        total += n;
+    }
+    if (total > 0 && f->on_update) f->on_update();
+}
+
+// ========== SEQUENZFENSTER ==========
+
+// Kürzester Sendeabstand eines Ziels: im adaptiven Modus der von CRIT wie
+// in level_interval (die Obergrenze streckt nur)
+static int64_t target_min_interval(const Fleet *f, size_t i) {
+    int64_t iv = f->targets[i].interval_us > 0 ? f->targets[i].interval_us : f->interval_us;
+    if (f->adaptive) iv /= FLEET_ADAPT_FAST;
+    return iv < FLEET_MIN_INTERVAL_US ? FLEET_MIN_INTERVAL_US : iv;
+}
+
+// So viele Probes können bis zum Timeout offen sein; ein kleineres Fenster
+// zählte die älteste schon vor dem Timeout als verloren
+static uint64_t target_window(const Fleet *f, size_t i) {
+    int64_t iv = target_min_interval(f, i);
+    uint64_t need = (uint64_t)((f->timeout_us + iv - 1) / iv) + FLEET_WINDOW_SLACK;
+    return need < FLEET_WINDOW ? FLEET_WINDOW : need;
+}
+
+int fleet_check_window(const Fleet *f, size_t *bad) {
+    for (size_t i = 0; i < f->count; i++) {
+        if (target_window(f, i) > SEQ_WINDOW_MAX) {
+            *bad = i;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// ========== START/STOP ==========
+
+static int worker_init(Fleet *f, FleetWorker *w, int index) {
+    memset(w, 0, sizeof(*w));
+    w->fleet = f;
+    w->index = index;
+    w->cpu = -1;
+    w->running = 1;
+    w->loop.epfd = -1;
+    w->icmp.fd = -1;
+    w->timer_handler.fd = w->stop_handler.fd = w->notify_handler.fd = -1;
+
+    // Ziele per Round-Robin: Ziel i gehört Worker i % nworkers
+    size_t n = 0;
+    for (size_t i = (size_t)index; i < f->count; i += (size_t)f->nworkers) n++;
+    w->probes = calloc(n ? n : 1, sizeof(*w->probes));
+    uint32_t mask = 1;
+    while (mask < n * 2) mask <<= 1;
+    w->slots = calloc(mask, sizeof(*w->slots));
+    w->slot_mask = mask - 1;
+    if (!w->probes || !w->slots) return -1;
+
+    for (size_t i = (size_t)index; i < f->count; i += (size_t)f->nworkers) {
+        WorkerProbe *p = &w->probes[w->nprobes];
+        p->worker = w;
+        p->target = (uint32_t)i;
+        p->base_interval_us = f->targets[i].interval_us > 0 ? f->targets[i].interval_us : f->interval_us;
+        // Start mit dem eingestellten Intervall; ohne adaptiven Modus bleibt es dabei
+        p->health = FLEET_WARN;
+        w->demand_mhz += level_mhz(p, p->health);
+        tw_timer_init(&p->send_timer, on_send_due);
+        tw_timer_init(&p->expire_timer, on_expire_due);
+        if (seq_init(&p->tracker, (uint32_t)target_window(f, i)) == -1) return -1;
+        p->tracker.on_lost = on_probe_lost;
+        p->tracker.ctx = w;
+
+        uint32_t h = addr_hash(f->targets[i].addr.sin_addr.s_addr) & w->slot_mask;
+        while (w->slots[h]) h = (h + 1) & w->slot_mask;
+        w->slots[h] = (uint32_t)++w->nprobes;
+    }
+
+    if (f->max_rate > 0) w->cap = f->max_rate * (double)n / (double)f->count;
+
+    if (spsc_init(&w->queue, FLEET_QUEUE_SIZE, sizeof(FleetSample)) == -1) return -1;
+    if (icmp_open_any(&w->icmp) == -1) return -1;
+    if (ev_init(&w->loop) == -1) return -1;
+    if ((w->timer_handler.fd = ev_timer_new()) == -1) return -1;
+    if ((w->stop_handler.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) return -1;
+    if ((w->notify_handler.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) return -1;
+
+    w->icmp_handler.fd = w->icmp.fd;
+    w->icmp_handler.cb = on_worker_icmp;
+    w->icmp_handler.ctx = w;
+    w->timer_handler.cb = on_worker_timer;
+    w->timer_handler.ctx = w;
+    w->stop_handler.cb = on_worker_stop;
+    w->stop_handler.ctx = w;
+    w->notify_handler.cb = on_queue_ready;
+    w->notify_handler.ctx = w;
+
+    if (ev_add(&w->loop, &w->icmp_handler, EPOLLIN) == -1 ||
+        ev_add(&w->loop, &w->timer_handler, EPOLLIN) == -1 ||
+        ev_add(&w->loop, &w->stop_handler, EPOLLIN) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+static void worker_close(FleetWorker *w) {
+    for (size_t i = 0; i < w->nprobes; i++) seq_free(&w->probes[i].tracker);
+    free(w->probes);
+    free(w->slots);
+    icmp_close(&w->icmp);
+    if (w->timer_handler.fd >= 0) close(w->timer_handler.fd);
+    if (w->stop_handler.fd >= 0) close(w->stop_handler.fd);
+    if (w->notify_handler.fd >= 0) close(w->notify_handler.fd);
+    if (w->loop.epfd >= 0) ev_close(&w->loop);
+    spsc_free(&w->queue);
+}
+
+int fleet_start(Fleet *f, int nworkers, EvLoop *ui_loop) {
+    // Nur CPUs, auf denen der Prozess laufen darf
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE];
+    int ncpu = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpus[ncpu++] = c;
+        }
+    }
+
+    if (nworkers <= 0) nworkers = ncpu > 0 ? ncpu : 1;
+    if ((size_t)nworkers > f->count) nworkers = f->count > 0 ? (int)f->count : 1;
+
+    f->workers = calloc((size_t)nworkers, sizeof(*f->workers));
+    if (!f->workers) return -1;
+    f->nworkers = nworkers;
+
+    // Scheitert worker_init, räumt fleet_stop alle Worker ab, auch die noch
+    // nicht initialisierten: deren fds dürfen nicht 0 (stdin) sein
+    for (int i = 0; i < nworkers; i++) {
+        FleetWorker *w = &f->workers[i];
+        w->loop.epfd = -1;
+        w->icmp.fd = -1;
+        w->timer_handler.fd = w->stop_handler.fd = w->notify_handler.fd = -1;
+    }
+
+    for (int i = 0; i < nworkers; i++) {
+        FleetWorker *w = &f->workers[i];
+        if (worker_init(f, w, i) == -1 || ev_add(ui_loop, &w->notify_handler, EPOLLIN) == -1) {
+            int err = errno;
+            fleet_stop(f);
+            errno = err;
+            return -1;
+        }
+        // Ein Worker pro CPU; mehr Worker als CPUs teilen sich reihum
+        if (ncpu > 1) w->cpu = cpus[i % ncpu];
+    }
+
+    for (int i = 0; i < nworkers; i++) {
+        FleetWorker *w = &f->workers[i];
+        // pthread_create meldet den Fehler als Rückgabewert, nicht in errno
+        int err = pthread_create(&w->tid, NULL, worker_main, w);
+        if (err != 0) {
+            fleet_stop(f);
+            errno = err;
+            return -1;
+        }
+        w->started = 1;
+    }
+    return 0;
+}
+
+void fleet_stop(Fleet *f) {
+    for (int i = 0; i < f->nworkers; i++) {
+        FleetWorker *w = &f->workers[i];
+        if (!w->started) continue;
+        uint64_t one = 1;
+        if (write(w->stop_handler.fd, &one, sizeof(one)) < 0) {
+            // eventfd-Schreiben scheitert nur bei Überlauf
+        }
+    }
+    for (int i = 0; i < f->nworkers; i++) {
+        FleetWorker *w = &f->workers[i];
+        if (w->started) pthread_join(w->tid, NULL);
+        f->dropped += w->dropped;
+        f->skipped += w->skipped;
+        worker_close(w);
+    }
+    free(f->workers);
+    f->workers = NULL;
+    f->nworkers = 0;
+}
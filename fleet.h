@@ -0,0 +1,178 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Mehrzielbetrieb: die Ziele aus einer Liste werden auf Worker-Threads
+ * verteilt (einer pro CPU, fest gebunden). Jeder Worker besitzt einen
+ * eigenen ICMP-Socket, eigenen Eventloop und die Sequenz-Tracker seiner
+ * Ziele; Ergebnisse gehen als FleetSample über eine lock-freie SPSC-Queue
+ * pro Worker an den UI-Thread, der sie per eventfd-Weckruf abholt und
+ * daraus die Anzeige-Statistik je Ziel pflegt. Auf dem Sendepfad gibt es
+ * keine gemeinsamen Locks; ist eine Queue voll, verwirft der Worker das
+ * Sample und zählt es, statt zu warten.
+ *
+ * Gesendet wird nicht im Gleichschritt: jedes Ziel hat sein eigenes
+ * Intervall und einen festen Platz darin (nach Position in der Liste, mit
+ * etwas Jitter), eingeplant in einem Timer-Rad pro Worker, das ein
+ * einziger timerfd antreibt. So entstehen keine Bursts, die sich im
+ * eigenen Sendepuffer oder im ICMP-Ratelimit der Gegenstelle stauen.
+ *
+ * Im adaptiven Modus stuft der Worker jedes Ziel nach geglätteter RTT
+ * (gegen WARN/CRIT) und Stabilität der letzten 64 Probes ein: gesunde Ziele
+ * laufen mit einem Viertel der Rate, ab WARN mit der eingestellten, ab
+ * CRIT mit der vierfachen. Eine Obergrenze für alle Probes/s streckt bei
+ * Bedarf alle Intervalle gleichmäßig.
+ */
+
+#ifndef PINGMON_FLEET_H
+#define PINGMON_FLEET_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+#include "evloop.h"
+#include "stats.h"
+#include "rank.h"
+
+#define FLEET_QUEUE_SIZE 65536      // Samples pro Worker-Queue
+#define FLEET_HIST       40         // letzte RTTs pro Ziel für die Verlaufsanzeige
+#define FLEET_WINDOW     64         // Sequenzfenster pro Ziel, mindestens
+#define FLEET_WINDOW_SLACK 16       // Reserve über Timeout/Intervall
+#define FLEET_NAME_MAX   64
+#define FLEET_TICK_US    100        // Auflösung des Sende-Timer-Rads
+#define FLEET_MIN_INTERVAL_US 1000
+#define FLEET_ADAPT_SLOW 4          // gesund: Intervall mal 4
+#define FLEET_ADAPT_FAST 4          // CRIT: Intervall durch 4
+#define FLEET_ADAPT_HOLD 10         // so viele ruhigere Ergebnisse vor dem Herabstufen
+#define FLEET_ADAPT_CRIT_STABILITY 50    // darunter CRIT (ab etwa 3,7 % Verlust)
+#define FLEET_ADAPT_MAX_RATE 10000  // Standard-Obergrenze im adaptiven Modus, Probes/s
+
+typedef enum {
+    FLEET_REPLY = 0,
+    FLEET_REORDERED,         // gültige Antwort nach einer neueren
+    FLEET_LOST,
+    FLEET_DUP,
+    FLEET_LATE
+} FleetSampleKind;
+
+// Zustand eines Ziels im adaptiven Modus, bestimmt die Senderate
+typedef enum {
+    FLEET_OK = 0,
+    FLEET_WARN,
+    FLEET_CRIT
+} FleetHealth;
+
+// Sortierschlüssel der Rangliste, jeweils "größer = schlechter"
+typedef enum {
+    FLEET_RANK_LAST = 0,     // letzte RTT, verlorene Probe zuerst
+    FLEET_RANK_AVG,
+    FLEET_RANK_P99,
+    FLEET_RANK_LOSS,
+    FLEET_RANK_STABILITY,    // 100 - Stabilität
+    FLEET_RANK_KEYS
+} FleetRankKey;
+
+typedef struct {
+    uint32_t target;         // Index in Fleet.targets
+    uint8_t kind;            // FleetSampleKind
+    uint8_t ttl;             // 0 = unbekannt
+    uint16_t seq;
+    uint32_t rtt_us;         // nur FLEET_REPLY/FLEET_REORDERED
+    uint32_t interval_us;    // aktueller Sendeabstand des Ziels
+    int64_t ts_ms;           // Wanduhr
+} FleetSample;
+
+typedef struct {
+    char name[FLEET_NAME_MAX];     // Bezeichnung aus der Liste, sonst die Adresse
+    struct sockaddr_in addr;
+    int64_t interval_us;           // 0 = Fleet.interval_us
+    uint32_t every_us;             // aktueller Sendeabstand laut Worker, 0 = unbekannt
+
+    // Nur im UI-Thread, aus den Samples
+    LatencyStats lat;
+    uint64_t sent;
+    uint64_t recv;
+    uint64_t dup;
+    uint64_t reordered;
+    uint64_t late;
+    double last;
+    double sum;
+    float hist[FLEET_HIST];  // Ring der letzten RTTs in ms, 0 = verloren
+    uint32_t hist_count;     // insgesamt eingetragene Werte
+} FleetTarget;
+
+typedef struct FleetWorker FleetWorker;
+
+typedef struct {
+    FleetTarget *targets;
+    size_t count;
+    int64_t interval_us;         // für Ziele ohne eigenes Intervall
+    int64_t timeout_us;
+    int adaptive;                // Rate nach Zustand der Ziele
+    double warn_ms, crit_ms;     // Schwellen für den adaptiven Modus
+    double max_rate;             // Probes/s über alle Ziele, 0 = unbegrenzt
+
+    FleetWorker *workers;
+    int nworkers;
+
+    void (*on_update)(void);     // nach neuen Samples, im UI-Thread
+    void (*on_sample)(const FleetSample *s);     // für jedes Sample, im UI-Thread
+    uint64_t samples;            // verarbeitete Samples (UI-Thread)
+    uint64_t sent;               // Summen über alle Ziele (UI-Thread)
+    uint64_t recv;
+
+    // Schlechteste Ziele zuerst, mit jedem Sample nachgeführt (UI-Thread)
+    RankHeap rank;
+    FleetRankKey rank_key;
+    uint64_t dropped;            // verworfene Samples bereits beendeter Worker
+    uint64_t skipped;            // ausgelassene Probes bereits beendeter Worker
+} Fleet;
+
+// Zielliste lesen: pro Zeile "ADRESSE [Bezeichnung] [interval=MS]", '#'
+// leitet Kommentare ein. 0 = OK, -1 = Fehler (errno), -2 = ungültige oder
+// doppelte Adresse bzw. ungültiges Intervall in Zeile *bad_line
+int fleet_load(Fleet *f, const char *path, int *bad_line);
+
+// Passt jedes Ziel mit timeout_us und seinem kürzesten Sendeabstand in das
+// Sequenzfenster? 0 = ja, -1 = nein, erstes solches Ziel in *bad
+int fleet_check_window(const Fleet *f, size_t *bad);
+
+// Worker starten (nworkers <= 0: einer pro CPU) und ihre Queues in ui_loop
+// eintragen. Aufrufen, nachdem die Signale für signalfd blockiert sind,
+// damit die Threads die Maske erben. 0 = OK, -1 = Fehler (errno)
+int fleet_start(Fleet *f, int nworkers, EvLoop *ui_loop);
+
+// Worker anhalten und einsammeln
+void fleet_stop(Fleet *f);
+
+void fleet_free(Fleet *f);
+
+// Anzeige-Statistik aller Ziele zurücksetzen (UI-Thread)
+void fleet_reset(Fleet *f);
+
+// Von den Workern verworfene Samples (Queue voll)
+uint64_t fleet_dropped(const Fleet *f);
+
+// Aktuell geplante Probes/s aller Worker bzw. wegen max_rate ausgelassene
+// Probes (beides aus jedem Thread lesbar)
+double fleet_rate(const Fleet *f);
+uint64_t fleet_skipped(const Fleet *f);
+
+// Rangliste nach key neu aufbauen, O(n log n); danach O(log n) pro Sample
+void fleet_set_rank(Fleet *f, FleetRankKey key);
+
+// Schlüsselwert eines Ziels bzw. Bezeichnung für die Anzeige
+double fleet_rank_value(const FleetTarget *t, FleetRankKey key);
+const char *fleet_rank_name(FleetRankKey key);
+
+static inline double fleet_loss(const FleetTarget *t) {
+    return t->sent > 0 ? (double)(t->sent - t->recv) * 100.0 / (double)t->sent : 0.0;
+}
+
+// Eintrag age (0 = neuester) aus dem Verlauf, -1 wenn nicht vorhanden
+static inline double fleet_hist_at(const FleetTarget *t, uint32_t age) {
+    if (age >= t->hist_count || age >= FLEET_HIST) return -1;
+    return t->hist[(t->hist_count - 1 - age) % FLEET_HIST];
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Latenz-Heatmap (siehe heatmap.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+
+#include "heatmap.h"
+
+void heat_init(HeatMap *h, int64_t slice_us) {
+    memset(h->cols, 0, sizeof(h->cols));
+    h->slice_us = slice_us;
+    h->slot = -1;
+    h->head = HEAT_COLS - 1;
+    h->filled = 0;
+}
+
+// Stufe = 2 * (höchstes Bit - 1) + nächstes Bit der RTT in us
+int heat_bucket(double rtt_ms) {
+    uint64_t us = (uint64_t)(rtt_ms * 1000.0);
+    if (us < 2) return 0;
+    int msb = 63 - __builtin_clzll(us);
+    int idx = 2 * (msb - 1) + (int)((us >> (msb - 1)) & 1);
+    return idx < HEAT_BUCKETS ? idx : HEAT_BUCKETS - 1;
+}
+
+double heat_bucket_lower(int idx) {
+    return (double)((uint64_t)(2 + idx % 2) << (idx / 2)) / 1000.0;
+}
+
+// Um n Zeitscheiben weiterschalten; übersprungene bleiben leer
+static void heat_advance(HeatMap *h, int64_t n) {
+    if (n > HEAT_COLS) n = HEAT_COLS;
+    for (int64_t i = 0; i < n; i++) {
+        h->head = (h->head + 1) % HEAT_COLS;
+        memset(&h->cols[h->head], 0, sizeof(HeatColumn));
+    }
+    h->filled += (int)n;
+    if (h->filled > HEAT_COLS) h->filled = HEAT_COLS;
+}
+
+void heat_add(HeatMap *h, int64_t now_us, double rtt_ms) {
+    int64_t slot = now_us / h->slice_us;
+    if (h->slot < 0) {
+        heat_advance(h, 1);
+        h->slot = slot;
+    } else if (slot > h->slot) {
+        heat_advance(h, slot - h->slot);
+        h->slot = slot;
+    }
+
+    // Ältere Zeitstempel (z. B. aus dem Log) landen in der neuesten Spalte
+    HeatColumn *c = &h->cols[h->head];
+    if (rtt_ms <= 0) {
+        if (c->lost < UINT16_MAX) c->lost++;
+        return;
+    }
+    if (c->recv == UINT16_MAX) return;
+    int idx = heat_bucket(rtt_ms);
+    if (c->recv == 0 || idx < c->lo) c->lo = (uint8_t)idx;
+    if (c->recv == 0 || idx > c->hi) c->hi = (uint8_t)idx;
+    c->count[idx]++;
+    c->recv++;
+}
+
+const HeatColumn *heat_at(const HeatMap *h, int age) {
+    if (age < 0 || age >= h->filled) return NULL;
+    return &h->cols[(h->head - age + HEAT_COLS) % HEAT_COLS];
+}
@@ -0,0 +1,47 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Latenz-Heatmap: Ring aus Zeitscheiben fester Breite, jede mit einem
+ * kleinen Histogramm in halben Zweierpotenzen der RTT. Ein Sample kostet
+ * O(1), das Zeichnen liest nur die Spalten, nie die Rohwerte.
+ */
+
+#ifndef PINGMON_HEATMAP_H
+#define PINGMON_HEATMAP_H
+
+#include <stdint.h>
+
+#define HEAT_BUCKETS 42             // ab 2 us je halbe Zweierpotenz, die oberste ab 3,1 s
+#define HEAT_COLS    256            // Zeitscheiben im Ring, breiter als SCREEN_COLS
+
+typedef struct {
+    uint16_t count[HEAT_BUCKETS];
+    uint16_t recv;           // sättigt; count[] summiert sich zu recv
+    uint16_t lost;
+    uint8_t lo;              // kleinste bzw. größte belegte Stufe, nur mit recv > 0
+    uint8_t hi;
+} HeatColumn;
+
+typedef struct {
+    int64_t slice_us;
+    int64_t slot;            // Zeitscheibe der neuesten Spalte, -1 = noch keine
+    int head;                // Index der neuesten Spalte
+    int filled;
+    HeatColumn cols[HEAT_COLS];
+} HeatMap;
+
+void heat_init(HeatMap *h, int64_t slice_us);
+
+// Ein Sample in die Spalte seiner Zeitscheibe, O(1). rtt_ms <= 0 = verloren
+void heat_add(HeatMap *h, int64_t now_us, double rtt_ms);
+
+// Spalte; age 0 = neueste. NULL wenn nicht (mehr) vorhanden
+const HeatColumn *heat_at(const HeatMap *h, int age);
+
+int heat_bucket(double rtt_ms);
+
+// Untergrenze einer Stufe in ms
+double heat_bucket_lower(int idx);
+
+#endif
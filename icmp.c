@@ -0,0 +1,546 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * ICMP-Echo-Engine (siehe icmp.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/icmp6.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+#include "icmp.h"
+
+#define ICMP_PACKET_SIZE (sizeof(struct icmphdr) + ICMP_PAYLOAD_SIZE)
+
+int64_t mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Internet-Prüfsumme (RFC 1071)
+static uint16_t icmp_checksum(const void *data, size_t len) {
+    const uint16_t *p = data;
+    uint32_t sum = 0;
+
+    while (len > 1) {
+        sum += *p++;
+        len -= 2;
+    }
+    if (len == 1) sum += *(const uint8_t *)p;
+
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum += (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+static int64_t real_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline int64_t ts_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+// Kernel-Zeitstempel einschalten: zuerst TX+RX, sonst nur RX
+static void enable_timestamps(IcmpEngine *e) {
+    int flags = SOF_TIMESTAMPING_SOFTWARE |
+                SOF_TIMESTAMPING_RX_SOFTWARE |
+                SOF_TIMESTAMPING_TX_SOFTWARE |
+                SOF_TIMESTAMPING_OPT_ID |
+                SOF_TIMESTAMPING_OPT_TSONLY;
+    if (setsockopt(e->fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+        e->ts_mode = ICMP_TS_RX_TX;
+        return;
+    }
+    int on = 1;
+    if (setsockopt(e->fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0) {
+        e->ts_mode = ICMP_TS_RX;
+    }
+}
+
+static int open_family(IcmpEngine *e, int family) {
+    int proto = family == AF_INET6 ? IPPROTO_ICMPV6 : IPPROTO_ICMP;
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+    e->family = family;
+    e->dst.sin_family = AF_INET;
+    e->dst6.sin6_family = AF_INET6;
+
+    // Unprivilegierter ICMP-Socket (net.ipv4.ping_group_range, gilt auch für IPv6)
+    e->fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, proto);
+    if (e->fd >= 0) {
+        e->raw = 0;
+    } else {
+        // Fallback: Raw-Socket (root oder CAP_NET_RAW)
+        e->fd = socket(family, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, proto);
+        if (e->fd < 0) return -1;
+        e->raw = 1;
+    }
+
+    int on = 1;
+    if (family == AF_INET6) {
+        setsockopt(e->fd, IPPROTO_IPV6, IPV6_RECVHOPLIMIT, &on, sizeof(on));
+        if (e->raw) {
+            // Raw-ICMPv6 sieht sonst auch Neighbor Discovery usw.
+            struct icmp6_filter filter;
+            ICMP6_FILTER_SETBLOCKALL(&filter);
+            ICMP6_FILTER_SETPASS(ICMP6_ECHO_REPLY, &filter);
+            setsockopt(e->fd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter));
+        }
+    } else {
+        setsockopt(e->fd, IPPROTO_IP, IP_RECVTTL, &on, sizeof(on));
+    }
+    enable_timestamps(e);
+
+    if (e->raw) {
+        e->ident = (uint16_t)(getpid() & 0xffff);
+    } else {
+        // Beim Datagram-Socket ersetzt der Kernel die ID durch den lokalen "Port"
+        union {
+            struct sockaddr sa;
+            struct sockaddr_in in;
+            struct sockaddr_in6 in6;
+        } local;
+        memset(&local, 0, sizeof(local));
+        local.sa.sa_family = (sa_family_t)family;
+        socklen_t len = family == AF_INET6 ? sizeof(local.in6) : sizeof(local.in);
+        if (bind(e->fd, &local.sa, len) == 0 && getsockname(e->fd, &local.sa, &len) == 0) {
+            e->ident = ntohs(family == AF_INET6 ? local.in6.sin6_port : local.in.sin_port);
+        }
+    }
+
+    return 0;
+}
+
+int icmp_open(IcmpEngine *e, const char *target) {
+    struct in_addr addr;
+    struct in6_addr addr6;
+    if (inet_pton(AF_INET, target, &addr) == 1) {
+        if (open_family(e, AF_INET) == -1) return -1;
+        e->dst.sin_addr = addr;
+        return 0;
+    }
+    if (inet_pton(AF_INET6, target, &addr6) == 1) {
+        if (open_family(e, AF_INET6) == -1) return -1;
+        e->dst6.sin6_addr = addr6;
+        return 0;
+    }
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+    errno = EINVAL;
+    return -1;
+}
+
+int icmp_open_any(IcmpEngine *e) {
+    return open_family(e, AF_INET);
+}
+
+int icmp_enable_errors(IcmpEngine *e) {
+    // Raw-Sockets sehen die Fehlermeldungen ohnehin im normalen Empfang
+    int on = 1;
+    if (e->family != AF_INET) {
+        errno = EAFNOSUPPORT;
+        return -1;
+    }
+    if (!e->raw && setsockopt(e->fd, IPPROTO_IP, IP_RECVERR, &on, sizeof(on)) == -1) return -1;
+    e->errors = 1;
+    return 0;
+}
+
+// Payload: monotone Sendezeit (us), Wanduhr (ns) vor dem Senden und die
+// OPT_ID des Pakets für den TX-Zeitstempel
+typedef struct {
+    int64_t mono_us;
+    int64_t real_ns;
+    uint32_t tx_id;
+    uint32_t reserved;
+} IcmpStamp;
+
+int icmp_send_to(IcmpEngine *e, const IcmpProbe *probes, int count, int64_t now_us) {
+    static __thread unsigned char packets[ICMP_BATCH][ICMP_PACKET_SIZE];
+    struct mmsghdr msgs[ICMP_BATCH];
+    struct iovec iovs[ICMP_BATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl[ICMP_BATCH];
+
+    if (count > ICMP_BATCH) count = ICMP_BATCH;
+    if (count <= 0) return 0;
+
+    IcmpStamp stamp = { now_us, real_ns(), 0, 0 };
+    for (int i = 0; i < count; i++) {
+        unsigned char *packet = packets[i];
+        struct icmphdr *icmp = (struct icmphdr *)packet;
+        unsigned char *payload = packet + sizeof(struct icmphdr);
+        uint16_t seq = probes[i].seq;
+        stamp.tx_id = e->tx_next_id + (uint32_t)i;
+
+        memset(packet, 0, ICMP_PACKET_SIZE);
+        icmp->type = e->family == AF_INET6 ? ICMP6_ECHO_REQUEST : ICMP_ECHO;
+        icmp->code = 0;
+        icmp->un.echo.id = htons(e->ident);
+        icmp->un.echo.sequence = htons(seq);
+
+        // Sendezeitpunkt im Payload, Rest mit Muster füllen (wie ping)
+        memcpy(payload, &stamp, sizeof(stamp));
+        for (size_t k = sizeof(stamp); k < ICMP_PAYLOAD_SIZE; k++) {
+            payload[k] = (unsigned char)k;
+        }
+        // ICMPv6: Prüfsumme über den Pseudo-Header berechnet der Kernel
+        if (e->family == AF_INET) icmp->checksum = icmp_checksum(packet, ICMP_PACKET_SIZE);
+
+        iovs[i].iov_base = packet;
+        iovs[i].iov_len = ICMP_PACKET_SIZE;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = (void *)probes[i].dst;
+        msgs[i].msg_hdr.msg_namelen = e->family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+
+        // TTL nur für diese Nachricht (Pfadansicht)
+        if (probes[i].ttl) {
+            int ttl = probes[i].ttl;
+            msgs[i].msg_hdr.msg_control = ctl[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(ctl[i].buf);
+            struct cmsghdr *c = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+            c->cmsg_level = e->family == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+            c->cmsg_type = e->family == AF_INET6 ? IPV6_HOPLIMIT : IP_TTL;
+            c->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(c), &ttl, sizeof(ttl));
+        }
+    }
+
+    int n;
+    do {
+        n = sendmmsg(e->fd, msgs, (unsigned int)count, 0);
+    } while (n < 0 && errno == EINTR);
+    e->send_calls++;
+    if (n <= 0) return -1;
+
+    // OPT_ID zählt jedes gesendete Paket; Platz für den TX-Zeitstempel
+    for (int i = 0; i < n; i++) {
+        uint32_t id = e->tx_next_id + (uint32_t)i;
+        e->tx_ts[id & (ICMP_TX_RING - 1)].id = id;
+        e->tx_ts[id & (ICMP_TX_RING - 1)].ns = 0;
+    }
+    e->tx_next_id += (uint32_t)n;
+    return n;
+}
+
+int icmp_send_batch(IcmpEngine *e, int count, int64_t now_us, uint16_t *seqs) {
+    IcmpProbe probes[ICMP_BATCH];
+
+    if (count > ICMP_BATCH) count = ICMP_BATCH;
+    for (int i = 0; i < count; i++) {
+        probes[i].dst = e->family == AF_INET6 ? (const void *)&e->dst6 : (const void *)&e->dst;
+        probes[i].seq = seqs[i] = (uint16_t)(e->next_seq + i);
+        probes[i].ttl = 0;
+    }
+    int n = icmp_send_to(e, probes, count, now_us);
+    if (n > 0) e->next_seq = (uint16_t)(e->next_seq + n);
+    return n;
+}
+
+int icmp_send(IcmpEngine *e, int64_t now_us) {
+    uint16_t seq;
+    return icmp_send_batch(e, 1, now_us, &seq) == 1 ? seq : -1;
+}
+
+// RTT einer Antwort: Kernel-TX (sonst Zeit vor sendmmsg) bis Kernel-RX
+// (sonst jetzt). stamp = NULL: Payload nicht zitiert, RTT bleibt offen
+static void set_rtt(IcmpEngine *e, IcmpReply *r, const IcmpStamp *stamp, int64_t rx_ns, int64_t now, int64_t now_real) {
+    r->recv_us = now;
+    r->kernel_ts = 0;
+    if (!stamp) {
+        r->sent_us = 0;
+        r->rtt_ns = 0;
+        return;
+    }
+    r->sent_us = stamp->mono_us;
+
+    int64_t tx_ns = stamp->real_ns;
+    uint32_t slot = stamp->tx_id & (ICMP_TX_RING - 1);
+    if (e->tx_ts[slot].id == stamp->tx_id && e->tx_ts[slot].ns) {
+        int64_t k = e->tx_ts[slot].ns;
+        int64_t err = k - stamp->real_ns;
+        e->ts.tx_count++;
+        e->ts.tx_sum_ns += err;
+        if (err > e->ts.tx_max_ns) e->ts.tx_max_ns = err;
+        tx_ns = k;
+    }
+    if (rx_ns) {
+        int64_t err = now_real - rx_ns;
+        e->ts.rx_count++;
+        e->ts.rx_sum_ns += err;
+        if (err > e->ts.rx_max_ns) e->ts.rx_max_ns = err;
+    }
+
+    int64_t rtt = (rx_ns ? rx_ns : now_real) - tx_ns;
+    if (rx_ns && tx_ns != stamp->real_ns && rtt > 0) {
+        r->kernel_ts = 1;
+        e->ts.kernel_rtts++;
+    } else {
+        e->ts.user_rtts++;
+    }
+    // Wanduhr gesprungen: monotone Userspace-Messung verwenden
+    if (rtt <= 0 || rtt > (now - stamp->mono_us + 1000000) * 1000) {
+        rtt = (now - stamp->mono_us) * 1000;
+        r->kernel_ts = 0;
+    }
+    r->rtt_ns = rtt;
+}
+
+// Zitierte eigene Probe (ICMP-Header und, falls vorhanden, Payload) einer
+// Fehlermeldung prüfen. Rückgabe: Zeiger auf den Stempel, NULL wenn nicht
+// zitiert; -1 in *ok, wenn es keine eigene Probe ist
+static const IcmpStamp *quoted_probe(const IcmpEngine *e, const unsigned char *p, ssize_t len,
+                                     uint16_t *seq, IcmpStamp *stamp, int *ok) {
+    *ok = 0;
+    if (len < (ssize_t)sizeof(struct icmphdr)) return NULL;
+    const struct icmphdr *orig = (const struct icmphdr *)p;
+    if (orig->type != ICMP_ECHO) return NULL;
+    if (e->raw && ntohs(orig->un.echo.id) != e->ident) return NULL;
+    *seq = ntohs(orig->un.echo.sequence);
+    *ok = 1;
+    if (len < (ssize_t)(sizeof(struct icmphdr) + sizeof(IcmpStamp))) return NULL;
+    memcpy(stamp, p + sizeof(struct icmphdr), sizeof(*stamp));
+    return stamp->mono_us > 0 ? stamp : NULL;
+}
+
+// Fehlerqueue leeren: TX-Zeitstempel übernehmen und (mit errors) ICMP-Fehler
+// zu eigenen Probes als Antworten liefern. Rückgabe: Anzahl in replies
+static int drain_errqueue(IcmpEngine *e, IcmpReply *replies, int max) {
+    unsigned char cbuf[512];
+    unsigned char data[ICMP_PACKET_SIZE];
+    int count = 0;
+
+    while (count < max) {
+        struct sockaddr_in dst;
+        struct iovec iov = { data, sizeof(data) };
+        struct msghdr msg = {0};
+        msg.msg_name = &dst;
+        msg.msg_namelen = sizeof(dst);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+
+        ssize_t len = recvmsg(e->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return count;
+        }
+
+        int64_t kernel_ns = 0;
+        struct sock_extended_err ee = {0};
+        struct sockaddr_in offender = {0};
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPING) {
+                struct scm_timestamping tss;
+                memcpy(&tss, CMSG_DATA(c), sizeof(tss));
+                kernel_ns = ts_ns(&tss.ts[0]);
+            } else if ((c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR) ||
+                       (c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR)) {
+                memcpy(&ee, CMSG_DATA(c), sizeof(ee));
+                if (c->cmsg_len >= CMSG_LEN(sizeof(ee) + sizeof(offender))) {
+                    memcpy(&offender, CMSG_DATA(c) + sizeof(ee), sizeof(offender));
+                }
+            }
+        }
+
+        if (ee.ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+            uint32_t id = ee.ee_data;
+            // Zu alt, Ring schon überschrieben
+            if (kernel_ns == 0 || e->tx_ts[id & (ICMP_TX_RING - 1)].id != id) continue;
+            e->tx_ts[id & (ICMP_TX_RING - 1)].ns = kernel_ns;
+            continue;
+        }
+        if (ee.ee_origin != SO_EE_ORIGIN_ICMP || !e->errors) continue;
+        if (ee.ee_type != ICMP_TIME_EXCEEDED && ee.ee_type != ICMP_DEST_UNREACH) continue;
+
+        // Der Kernel liefert die zitierte eigene Probe ab dem ICMP-Header
+        IcmpStamp stamp;
+        uint16_t seq = 0;
+        int ok;
+        const IcmpStamp *st = quoted_probe(e, data, len, &seq, &stamp, &ok);
+        if (!ok) continue;
+
+        IcmpReply *r = &replies[count++];
+        r->seq = seq;
+        r->type = ee.ee_type;
+        r->code = ee.ee_code;
+        r->from = offender.sin_family == AF_INET ? offender.sin_addr : dst.sin_addr;
+        memset(&r->from6, 0, sizeof(r->from6));
+        r->ttl = -1;
+        set_rtt(e, r, st, kernel_ns, mono_us(), real_ns());
+    }
+    return count;
+}
+
+int icmp_recv_batch(IcmpEngine *e, IcmpReply *replies, int max) {
+    static __thread unsigned char bufs[ICMP_BATCH][1024];
+    static __thread unsigned char cbufs[ICMP_BATCH][256];
+    union {
+        struct sockaddr_in in;
+        struct sockaddr_in6 in6;
+    } from[ICMP_BATCH];
+    struct mmsghdr msgs[ICMP_BATCH];
+    struct iovec iovs[ICMP_BATCH];
+
+    if (max > ICMP_BATCH) max = ICMP_BATCH;
+    int count = 0;
+    if (e->ts_mode == ICMP_TS_RX_TX || (e->errors && !e->raw)) count = drain_errqueue(e, replies, max);
+    int want = max - count;
+    if (want == 0) return count;
+
+    for (;;) {
+        for (int i = 0; i < want; i++) {
+            iovs[i].iov_base = bufs[i];
+            iovs[i].iov_len = sizeof(bufs[i]);
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = cbufs[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(cbufs[i]);
+        }
+
+        int n = recvmmsg(e->fd, msgs, (unsigned int)want, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return count;
+            if (errno == EINTR) continue;
+            // Mit IP_RECVERR meldet der Socket den ICMP-Fehler einmal auch
+            // hier; die Einzelheiten liegen in der Fehlerqueue
+            if (e->errors) return count + drain_errqueue(e, replies + count, want);
+            return count > 0 ? count : -1;
+        }
+        e->recv_calls++;
+        int64_t now = mono_us();
+        int64_t now_real = real_ns();
+
+        int found = 0;
+        for (int i = 0; i < n; i++) {
+            struct msghdr *msg = &msgs[i].msg_hdr;
+            ssize_t len = (ssize_t)msgs[i].msg_len;
+            unsigned char *p = bufs[i];
+            int ttl = -1;
+            int64_t rx_ns = 0;
+
+            for (struct cmsghdr *c = CMSG_FIRSTHDR(msg); c; c = CMSG_NXTHDR(msg, c)) {
+                if ((c->cmsg_level == IPPROTO_IP && c->cmsg_type == IP_TTL) ||
+                    (c->cmsg_level == IPPROTO_IPV6 && c->cmsg_type == IPV6_HOPLIMIT)) {
+                    memcpy(&ttl, CMSG_DATA(c), sizeof(ttl));
+                } else if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPING) {
+                    struct scm_timestamping tss;
+                    memcpy(&tss, CMSG_DATA(c), sizeof(tss));
+                    rx_ns = ts_ns(&tss.ts[0]);
+                } else if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                    struct timespec ts;
+                    memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                    rx_ns = ts_ns(&ts);
+                }
+            }
+
+            // Raw-IPv4 liefert den IP-Header mit, Raw-ICMPv6 nicht
+            if (e->raw && e->family == AF_INET) {
+                if (len < (ssize_t)sizeof(struct iphdr)) continue;
+                struct iphdr *ip = (struct iphdr *)p;
+                size_t hlen = (size_t)ip->ihl * 4;
+                if ((size_t)len < hlen) continue;
+                ttl = ip->ttl;
+                p += hlen;
+                len -= (ssize_t)hlen;
+            }
+            if (len < (ssize_t)sizeof(struct icmphdr)) continue;
+            struct icmphdr *icmp = (struct icmphdr *)p;
+
+            // Fehlermeldung eines Routers zu einer eigenen Probe (nur Raw-Socket,
+            // zitiert werden IP-Header, ICMP-Header und meist der Payload)
+            if (e->raw && e->errors && e->family == AF_INET && (icmp->type == ICMP_TIME_EXCEEDED || icmp->type == ICMP_DEST_UNREACH)) {
+                unsigned char *q = p + sizeof(struct icmphdr);
+                ssize_t qlen = len - (ssize_t)sizeof(struct icmphdr);
+                if (qlen < (ssize_t)sizeof(struct iphdr)) continue;
+                struct iphdr *inner = (struct iphdr *)q;
+                size_t ihlen = (size_t)inner->ihl * 4;
+                if (inner->protocol != IPPROTO_ICMP || qlen < (ssize_t)ihlen) continue;
+
+                IcmpStamp stamp;
+                uint16_t seq = 0;
+                int ok;
+                const IcmpStamp *st = quoted_probe(e, q + ihlen, qlen - (ssize_t)ihlen, &seq, &stamp, &ok);
+                if (!ok) continue;
+
+                IcmpReply *r = &replies[count + found++];
+                r->seq = seq;
+                r->type = icmp->type;
+                r->code = icmp->code;
+                r->from = from[i].in.sin_addr;
+                memset(&r->from6, 0, sizeof(r->from6));
+                r->ttl = ttl;
+                set_rtt(e, r, st, rx_ns, now, now_real);
+                continue;
+            }
+
+            if (e->family == AF_INET6) {
+                if (!IN6_IS_ADDR_UNSPECIFIED(&e->dst6.sin6_addr) &&
+                    !IN6_ARE_ADDR_EQUAL(&from[i].in6.sin6_addr, &e->dst6.sin6_addr)) continue;
+                if (icmp->type != ICMP6_ECHO_REPLY) continue;
+            } else {
+                if (e->dst.sin_addr.s_addr != INADDR_ANY && from[i].in.sin_addr.s_addr != e->dst.sin_addr.s_addr) continue;
+                if (icmp->type != ICMP_ECHOREPLY) continue;
+            }
+            if (len < (ssize_t)(sizeof(struct icmphdr) + sizeof(IcmpStamp))) continue;
+            // Raw-Sockets sehen alle ICMP-Pakete des Hosts
+            if (e->raw && ntohs(icmp->un.echo.id) != e->ident) continue;
+
+            IcmpStamp stamp;
+            memcpy(&stamp, p + sizeof(struct icmphdr), sizeof(stamp));
+            if (stamp.mono_us <= 0 || stamp.mono_us > now) continue;
+
+            IcmpReply *r = &replies[count + found++];
+            r->seq = ntohs(icmp->un.echo.sequence);
+            r->type = ICMP_ECHOREPLY;
+            r->code = 0;
+            if (e->family == AF_INET6) {
+                r->from.s_addr = 0;
+                r->from6 = from[i].in6.sin6_addr;
+            } else {
+                r->from = from[i].in.sin_addr;
+                memset(&r->from6, 0, sizeof(r->from6));
+            }
+            r->ttl = ttl;
+            set_rtt(e, r, &stamp, rx_ns, now, now_real);
+        }
+        if (found > 0 || n < want) return count + found;
+    }
+}
+
+void icmp_close(IcmpEngine *e) {
+    if (e->fd >= 0) {
+        close(e->fd);
+        e->fd = -1;
+    }
+}
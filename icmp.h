@@ -0,0 +1,128 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * ICMP-Echo-Engine: sendet und empfängt Echo-Requests direkt über einen
+ * ICMP-Datagram-Socket (unprivilegiert) bzw. einen Raw-Socket als Fallback.
+ * Senden und Empfangen erfolgt gebündelt (sendmmsg/recvmmsg). Die RTT wird
+ * nach Möglichkeit aus Kernel-Zeitstempeln (SO_TIMESTAMPING, Software-TX
+ * und -RX) berechnet, damit Scheduling-Verzögerungen im Userspace nicht in
+ * die Messung eingehen.
+ *
+ * IPv6-Ziele laufen über ICMPv6 (Echo-Request 128/Reply 129, Prüfsumme
+ * vom Kernel); die Antworten melden trotzdem ICMP_ECHOREPLY.
+ *
+ * Ein Socket kann auch viele Ziele bedienen (icmp_open_any/icmp_send_to);
+ * die Antworten tragen dann ihre Absenderadresse. Die Puffer sind
+ * thread-lokal, jeder Thread braucht nur seine eigene Engine.
+ *
+ * Für die Pfadansicht lässt sich die TTL pro Probe setzen; mit
+ * icmp_enable_errors() kommen dann auch "Time Exceeded" und "Unreachable"
+ * der Router als Antworten an (Raw-Socket: aus dem zitierten Header,
+ * Datagram-Socket: über IP_RECVERR und die Fehlerqueue).
+ */
+
+#ifndef PINGMON_ICMP_H
+#define PINGMON_ICMP_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+#define ICMP_PAYLOAD_SIZE 56
+#define ICMP_BATCH        64        // Nachrichten pro sendmmsg/recvmmsg
+#define ICMP_TX_RING      4096      // Zweierpotenz
+
+typedef enum {
+    ICMP_TS_USER = 0,         // nur Userspace-Uhren
+    ICMP_TS_RX,               // Kernel-Empfangszeit (SO_TIMESTAMPNS)
+    ICMP_TS_RX_TX             // Kernel-Empfangs- und Sendezeit (SO_TIMESTAMPING)
+} IcmpTsMode;
+
+// Abweichung Userspace gegenüber Kernel-Zeitstempel (Fehlerbudget)
+typedef struct {
+    uint64_t tx_count;
+    int64_t tx_sum_ns;        // Kernel-TX minus Zeit vor sendmmsg
+    int64_t tx_max_ns;
+    uint64_t rx_count;
+    int64_t rx_sum_ns;        // Rückkehr aus recvmmsg minus Kernel-RX
+    int64_t rx_max_ns;
+    uint64_t kernel_rtts;     // RTTs aus Kernel-Zeitstempeln
+    uint64_t user_rtts;       // RTTs mit Userspace-Fallback
+} IcmpTsStats;
+
+typedef struct {
+    int fd;
+    int raw;                  // 1 = SOCK_RAW, Empfangspuffer enthält IP-Header
+    int errors;               // 1 = ICMP-Fehler zu eigenen Probes melden
+    uint16_t ident;           // Echo-Identifier (bei SOCK_DGRAM vom Kernel vergeben)
+    uint16_t next_seq;
+    int family;               // AF_INET oder AF_INET6
+    struct sockaddr_in dst;
+    struct sockaddr_in6 dst6; // Ziel bei AF_INET6
+    IcmpTsMode ts_mode;
+    uint32_t tx_next_id;      // SOF_TIMESTAMPING_OPT_ID des nächsten Pakets, steht im Payload
+    struct {
+        uint32_t id;
+        int64_t ns;           // 0 = kein Kernel-Zeitstempel
+    } tx_ts[ICMP_TX_RING];    // nach OPT_ID
+    uint64_t send_calls;      // sendmmsg-Aufrufe
+    uint64_t recv_calls;      // recvmmsg-Aufrufe
+    IcmpTsStats ts;
+} IcmpEngine;
+
+// Eine Probe im Mehrzielbetrieb
+typedef struct {
+    const void *dst;          // sockaddr_in bzw. sockaddr_in6 passend zur Engine
+    uint16_t seq;
+    uint8_t ttl;              // 0 = Standard des Sockets
+} IcmpProbe;
+
+typedef struct {
+    uint16_t seq;
+    uint8_t type;             // ICMP_ECHOREPLY, mit icmp_enable_errors auch
+                              // ICMP_TIME_EXCEEDED/ICMP_DEST_UNREACH
+    uint8_t code;
+    struct in_addr from;      // Absender (Ziel bzw. meldender Router)
+    struct in6_addr from6;    // Absender bei AF_INET6
+    int ttl;                  // -1 wenn unbekannt
+    int64_t sent_us;          // Monotone Sendezeit (aus dem Payload), 0 = nicht zitiert
+    int64_t recv_us;          // Monotone Empfangszeit
+    int64_t rtt_ns;           // 0 = unbekannt (Router hat den Payload nicht zitiert)
+    int kernel_ts;            // 1 = RTT aus Kernel-Zeitstempeln
+} IcmpReply;
+
+// Monotone Uhr in Mikrosekunden
+int64_t mono_us(void);
+
+// Wanduhr in Millisekunden seit Epoch (für Zeitstempel in Exporten)
+int64_t wall_ms(void);
+
+// Socket für eine IPv4- oder IPv6-Adresse öffnen: zuerst SOCK_DGRAM, dann
+// SOCK_RAW. 0 = OK, -1 = Fehler (auch kein Adressliteral)
+int icmp_open(IcmpEngine *e, const char *target);
+
+// Socket ohne festes Ziel (IPv4): Antworten von allen Absendern werden angenommen
+int icmp_open_any(IcmpEngine *e);
+
+// ICMP-Fehler zu eigenen Probes als Antworten melden. 0 = OK, -1 = Fehler
+int icmp_enable_errors(IcmpEngine *e);
+
+// Probes an beliebige Ziele mit einem sendmmsg senden (höchstens ICMP_BATCH).
+// Rückgabe: Anzahl gesendeter Probes ab probes[0] oder -1 (errno), wenn
+// schon die erste scheitert
+int icmp_send_to(IcmpEngine *e, const IcmpProbe *probes, int count, int64_t now_us);
+
+// count Echo-Requests mit einem sendmmsg senden (höchstens ICMP_BATCH).
+// Die verwendeten Sequenznummern landen in seqs. Rückgabe: Anzahl oder -1
+int icmp_send_batch(IcmpEngine *e, int count, int64_t now_us, uint16_t *seqs);
+
+// Einen Echo-Request senden. Rückgabe: verwendete Sequenznummer oder -1
+int icmp_send(IcmpEngine *e, int64_t now_us);
+
+// Bis zu max Antworten lesen (non-blocking), vorher TX-Zeitstempel aus der
+// Fehlerqueue abholen. Rückgabe: Anzahl Antworten, 0 = nichts da, -1 = Fehler
+int icmp_recv_batch(IcmpEngine *e, IcmpReply *replies, int max);
+
+void icmp_close(IcmpEngine *e);
+
+#endif
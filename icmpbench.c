@@ -0,0 +1,148 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * icmpbench: Dauerlast mit der nativen ICMP-Engine (Standard: Loopback,
+ * 1 ms Takt) und Ausgabe von Probes/s, RTT-Verteilung und dem
+ * Zeitstempel-Fehlerbudget (Userspace gegen Kernel).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+
+#include "icmp.h"
+#include "evloop.h"
+#include "seqtrack.h"
+#include "stats.h"
+
+static IcmpEngine icmp;
+static SeqTracker tracker;
+static LatencyStats user_lat;        // monotone Userspace-Messung
+static LatencyStats kernel_lat;      // aus Kernel-Zeitstempeln
+
+static void on_readable(EvHandler *h, uint32_t events) {
+    (void)h; (void)events;
+    IcmpReply replies[ICMP_BATCH];
+    int n;
+    while ((n = icmp_recv_batch(&icmp, replies, ICMP_BATCH)) > 0) {
+        for (int i = 0; i < n; i++) {
+            SeqReplyKind kind = seq_reply(&tracker, replies[i].seq);
+            if (kind != SEQ_REPLY_OK && kind != SEQ_REPLY_REORDERED) continue;
+            lat_add(&user_lat, (replies[i].recv_us - replies[i].sent_us) / 1000.0);
+            if (replies[i].kernel_ts) lat_add(&kernel_lat, replies[i].rtt_ns / 1e6);
+        }
+        if (n < ICMP_BATCH) break;
+    }
+}
+
+static void print_lat(const char *name, const LatencyStats *s) {
+    if (s->count == 0) {
+        printf("%-14s -\n", name);
+        return;
+    }
+    printf("%-14s P50 %7.1f us  P99 %7.1f us  max %8.1f us  stddev %6.1f us\n", name,
+           lat_percentile(s, 50) * 1000.0, lat_percentile(s, 99) * 1000.0,
+           s->max * 1000.0, lat_stddev(s) * 1000.0);
+}
+
+int main(int argc, char *argv[]) {
+    const char *target = argc > 1 ? argv[1] : "127.0.0.1";
+    double interval_ms = argc > 2 ? atof(argv[2]) : 1.0;
+    double seconds = argc > 3 ? atof(argv[3]) : 5.0;
+    if (interval_ms < 0.001 || seconds <= 0) {
+        fprintf(stderr, "Usage: icmpbench [target] [interval_ms] [seconds]\n");
+        return 1;
+    }
+
+    if (icmp_open(&icmp, target) == -1) {
+        perror("icmpbench: icmp_open");
+        return 1;
+    }
+    if (seq_init(&tracker, SEQ_WINDOW) == -1) {
+        perror("icmpbench: seq_init");
+        return 1;
+    }
+    lat_reset(&user_lat);
+    lat_reset(&kernel_lat);
+
+    EvLoop loop;
+    EvHandler probe = { icmp.fd, on_readable, NULL };
+    EvHandler tick = { ev_timer_new(), NULL, NULL };
+    if (ev_init(&loop) == -1 || tick.fd == -1) {
+        perror("icmpbench: eventloop");
+        return 1;
+    }
+    ev_add(&loop, &probe, EPOLLIN);
+    ev_add(&loop, &tick, EPOLLIN);
+
+    int64_t interval_us = (int64_t)(interval_ms * 1000.0);
+    if (interval_us < 1) interval_us = 1;
+    ev_timer_arm(tick.fd, 0, interval_us);
+
+    int64_t start = mono_us();
+    int64_t end = start + (int64_t)(seconds * 1e6);
+    uint64_t missed = 0;
+
+    for (;;) {
+        int64_t now = mono_us();
+        if (now >= end) break;
+
+        // Tick-Timer direkt auswerten; Antworten über on_readable
+        struct epoll_event ev;
+        int n = epoll_wait(loop.epfd, &ev, 1, (int)((end - now) / 1000) + 1);
+        if (n <= 0) continue;
+        EvHandler *h = ev.data.ptr;
+        if (h != &tick) {
+            h->cb(h, ev.events);
+            continue;
+        }
+
+        uint64_t due = ev_timer_read(tick.fd);
+        if (due == 0) continue;
+        if (due > ICMP_BATCH) {
+            missed += due - ICMP_BATCH;
+            due = ICMP_BATCH;
+        }
+        now = mono_us();
+        uint16_t seqs[ICMP_BATCH];
+        int sent = icmp_send_batch(&icmp, (int)due, now, seqs);
+        for (int i = 0; i < sent; i++) seq_sent(&tracker, seqs[i], now);
+        seq_expire(&tracker, now, 1000000);
+    }
+
+    // Nachzügler abwarten
+    int64_t drain_end = mono_us() + 200000;
+    while (mono_us() < drain_end && tracker.outstanding > 0) ev_run_once(&loop, 10);
+    double secs = (mono_us() - start) / 1e6;
+
+    const IcmpTsStats *ts = &icmp.ts;
+    printf("target         %s, interval %.3f ms, %.1f s\n", target, interval_ms, secs);
+    printf("probes         %llu sent, %llu received, %llu lost, %llu outstanding, %llu ticks skipped\n",
+           (unsigned long long)tracker.sent, (unsigned long long)tracker.received,
+           (unsigned long long)tracker.lost, (unsigned long long)tracker.outstanding,
+           (unsigned long long)missed);
+    printf("rate           %.0f probes/s sustained (target %.0f)\n",
+           tracker.sent / secs, 1000.0 / interval_ms);
+    printf("batching       %.2f probes/sendmmsg, %.2f replies/recvmmsg\n",
+           icmp.send_calls ? (double)tracker.sent / icmp.send_calls : 0.0,
+           icmp.recv_calls ? (double)tracker.received / icmp.recv_calls : 0.0);
+    printf("timestamps     %s\n",
+           icmp.ts_mode == ICMP_TS_RX_TX ? "kernel tx+rx (SO_TIMESTAMPING)" :
+           icmp.ts_mode == ICMP_TS_RX ? "kernel rx (SO_TIMESTAMPNS)" : "user space only");
+    print_lat("rtt user", &user_lat);
+    print_lat("rtt kernel", &kernel_lat);
+    printf("error budget   tx: avg %.1f us, max %.1f us (%llu samples)\n",
+           ts->tx_count ? ts->tx_sum_ns / 1e3 / ts->tx_count : 0.0, ts->tx_max_ns / 1e3,
+           (unsigned long long)ts->tx_count);
+    printf("               rx: avg %.1f us, max %.1f us (%llu samples)\n",
+           ts->rx_count ? ts->rx_sum_ns / 1e3 / ts->rx_count : 0.0, ts->rx_max_ns / 1e3,
+           (unsigned long long)ts->rx_count);
+
+    icmp_close(&icmp);
+    ev_close(&loop);
+    return 0;
+}
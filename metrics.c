@@ -0,0 +1,386 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * OpenMetrics-Endpunkt (siehe metrics.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "metrics.h"
+#include "icmp.h"
+
+#define CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+// Histogramm-Grenzen in Mikrosekunden (ausgegeben in Sekunden)
+static const uint64_t bucket_bounds_us[] = {
+    250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+#define BOUND_COUNT (sizeof(bucket_bounds_us) / sizeof(bucket_bounds_us[0]))
+
+// ========== ANTWORT AUFBAUEN ==========
+
+typedef struct {
+    char *p;
+    size_t left;
+} Out;
+
+static void out(Out *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void out(Out *o, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->p, o->left, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n >= o->left) n = o->left ? (int)o->left - 1 : 0;
+    o->p += n;
+    o->left -= (size_t)n;
+}
+
+// Label-Wert nach OpenMetrics: Backslash, Anführungszeichen und
+// Zeilenumbruch maskiert; kürzt bei vollem Puffer nie mitten in einer Folge
+static void escape_label(char *dst, size_t size, const char *src) {
+    char *p = dst, *end = dst + size - 1;
+    for (; *src && p < end; src++) {
+        if (*src == '\\' || *src == '"' || *src == '\n') {
+            if (end - p < 2) break;
+            *p++ = '\\';
+            *p++ = *src == '\n' ? 'n' : *src;
+        } else {
+            *p++ = *src;
+        }
+    }
+    *p = '\0';
+}
+
+static void build_body(MetricsBody *b, const MetricsSnapshot *s) {
+    Out o = { b->data, sizeof(b->data) };
+    char t[METRICS_LABEL_MAX];
+    escape_label(t, sizeof(t), s->target);
+
+    out(&o, "# TYPE pingmon_probes_sent counter\n"
+            "# HELP pingmon_probes_sent Echo requests sent.\n"
+            "pingmon_probes_sent_total{target=\"%s\"} %llu\n", t, (unsigned long long)s->sent);
+    out(&o, "# TYPE pingmon_probes_received counter\n"
+            "# HELP pingmon_probes_received Echo replies received.\n"
+            "pingmon_probes_received_total{target=\"%s\"} %llu\n", t, (unsigned long long)s->recv);
+    out(&o, "# TYPE pingmon_replies_duplicate counter\n"
+            "pingmon_replies_duplicate_total{target=\"%s\"} %llu\n", t, (unsigned long long)s->dup);
+    out(&o, "# TYPE pingmon_replies_reordered counter\n"
+            "pingmon_replies_reordered_total{target=\"%s\"} %llu\n", t, (unsigned long long)s->reordered);
+    out(&o, "# TYPE pingmon_replies_late counter\n"
+            "# HELP pingmon_replies_late Replies that arrived after the probe was counted as lost.\n"
+            "pingmon_replies_late_total{target=\"%s\"} %llu\n", t, (unsigned long long)s->late);
+    out(&o, "# TYPE pingmon_rtt_last_seconds gauge\n"
+            "# UNIT pingmon_rtt_last_seconds seconds\n"
+            "pingmon_rtt_last_seconds{target=\"%s\"} %.6f\n", t, s->last_ms / 1000.0);
+    out(&o, "# TYPE pingmon_rtt_avg_seconds gauge\n"
+            "# UNIT pingmon_rtt_avg_seconds seconds\n"
+            "pingmon_rtt_avg_seconds{target=\"%s\"} %.6f\n", t, s->avg_ms / 1000.0);
+    out(&o, "# TYPE pingmon_loss_ratio gauge\n"
+            "pingmon_loss_ratio{target=\"%s\"} %.6f\n", t, s->loss_percent / 100.0);
+    out(&o, "# TYPE pingmon_quality_score gauge\n"
+            "# HELP pingmon_quality_score Quality 0..100 from the last RTT.\n"
+            "pingmon_quality_score{target=\"%s\"} %.1f\n", t, s->quality);
+    out(&o, "# TYPE pingmon_stability_score gauge\n"
+            "# HELP pingmon_stability_score Stability 0..100 from packet loss.\n"
+            "pingmon_stability_score{target=\"%s\"} %.1f\n", t, s->stability);
+
+    // Kumulative Buckets aus dem log-linearen Histogramm; ein Bucket zählt
+    // zur ersten Grenze, die seine Obergrenze einschließt
+    out(&o, "# TYPE pingmon_rtt_seconds histogram\n"
+            "# UNIT pingmon_rtt_seconds seconds\n");
+    const LatencyStats *lat = s->lat;
+    uint64_t cum = 0;
+    int idx = 0;
+    for (size_t k = 0; k < BOUND_COUNT; k++) {
+        while (idx < LAT_BUCKETS && lat_bucket_upper(idx) <= bucket_bounds_us[k]) {
+            cum += lat->counts[idx++];
+        }
+        out(&o, "pingmon_rtt_seconds_bucket{target=\"%s\",le=\"%g\"} %llu\n",
+            t, (double)bucket_bounds_us[k] / 1e6, (unsigned long long)cum);
+    }
+    out(&o, "pingmon_rtt_seconds_bucket{target=\"%s\",le=\"+Inf\"} %llu\n",
+        t, (unsigned long long)lat->count);
+    out(&o, "pingmon_rtt_seconds_count{target=\"%s\"} %llu\n", t, (unsigned long long)lat->count);
+    out(&o, "pingmon_rtt_seconds_sum{target=\"%s\"} %.6f\n", t, lat->mean * (double)lat->count / 1000.0);
+    out(&o, "# EOF\n");
+
+    b->len = (size_t)(o.p - b->data);
+}
+
+// Aktuelle Antwort liefern; neu aufbauen, falls ein Sample dazukam und ein
+// Puffer frei ist (sonst bleibt die vorige Antwort bis zum nächsten Abruf)
+static MetricsBody *current_body(MetricsServer *m) {
+    if (m->stale || m->builds == 0) {
+        int next = m->builds == 0 ? m->cur : 1 - m->cur;
+        if (m->bodies[next].users == 0) {
+            MetricsSnapshot snap;
+            m->fill(&snap);
+            build_body(&m->bodies[next], &snap);
+            m->cur = next;
+            m->stale = 0;
+            m->builds++;
+        }
+    }
+    return &m->bodies[m->cur];
+}
+
+// ========== VERBINDUNGEN ==========
+
+static void conn_close(MetricsConn *c) {
+    ev_del(c->srv->loop, &c->h);
+    close(c->h.fd);
+    c->h.fd = -1;
+    if (c->body) c->body->users--;
+    c->body = NULL;
+}
+
+static void conn_write(MetricsConn *c) {
+    for (;;) {
+        struct iovec iov[2];
+        int n = 0;
+        size_t body_len = c->body ? c->body->len : 0;
+
+        if (c->sent < c->head_len) {
+            iov[n].iov_base = c->head + c->sent;
+            iov[n++].iov_len = c->head_len - c->sent;
+        }
+        if (c->body) {
+            size_t off = c->sent > c->head_len ? c->sent - c->head_len : 0;
+            if (off < body_len) {
+                iov[n].iov_base = c->body->data + off;
+                iov[n++].iov_len = body_len - off;
+            }
+        }
+        if (n == 0) {
+            conn_close(c);
+            return;
+        }
+
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = (size_t)n };
+        ssize_t w = sendmsg(c->h.fd, &msg, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                ev_mod(c->srv->loop, &c->h, EPOLLOUT);
+                return;
+            }
+            conn_close(c);
+            return;
+        }
+        c->sent += (size_t)w;
+    }
+}
+
+static void conn_respond(MetricsConn *c) {
+    MetricsServer *m = c->srv;
+    int ok = strncmp(c->req, "GET /metrics ", 13) == 0 || strncmp(c->req, "GET / ", 6) == 0;
+    int head_only = 0;
+
+    if (!ok && (strncmp(c->req, "HEAD /metrics ", 14) == 0)) {
+        ok = 1;
+        head_only = 1;
+    }
+
+    if (ok) {
+        MetricsBody *b = current_body(m);
+        c->head_len = (size_t)snprintf(c->head, sizeof(c->head),
+                                       "HTTP/1.0 200 OK\r\n"
+                                       "Content-Type: " CONTENT_TYPE "\r\n"
+                                       "Content-Length: %zu\r\n\r\n", b->len);
+        if (!head_only) {
+            c->body = b;
+            b->users++;
+        }
+        m->requests++;
+    } else {
+        c->head_len = (size_t)snprintf(c->head, sizeof(c->head),
+                                       "HTTP/1.0 404 Not Found\r\n"
+                                       "Content-Length: 0\r\n\r\n");
+    }
+    c->sent = 0;
+    conn_write(c);
+}
+
+static void on_conn(EvHandler *h, uint32_t events) {
+    MetricsConn *c = h->ctx;
+
+    if (c->head_len > 0) {
+        // Antwort läuft bereits
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) conn_write(c);
+        return;
+    }
+
+    for (;;) {
+        ssize_t n = read(h->fd, c->req + c->req_len, sizeof(c->req) - 1 - c->req_len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return;
+        if (n <= 0) {
+            conn_close(c);
+            return;
+        }
+        c->req_len += (size_t)n;
+        c->req[c->req_len] = '\0';
+
+        // Header vollständig (oder Puffer voll): antworten, Rest ignorieren
+        if (strstr(c->req, "\r\n\r\n") || strstr(c->req, "\n\n") ||
+            c->req_len == sizeof(c->req) - 1) {
+            conn_respond(c);
+            return;
+        }
+    }
+}
+
+static void on_accept(EvHandler *h, uint32_t events) {
+    MetricsServer *m = h->ctx;
+    (void)events;
+
+    for (;;) {
+        int fd = accept4(h->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        // Freien Platz suchen, sonst die älteste Verbindung verdrängen
+        MetricsConn *slot = NULL, *oldest = NULL;
+        for (int i = 0; i < METRICS_MAX_CONNS; i++) {
+            MetricsConn *c = &m->conns[i];
+            if (c->h.fd < 0) {
+                slot = c;
+                break;
+            }
+            if (!oldest || c->since_us < oldest->since_us) oldest = c;
+        }
+        if (!slot) {
+            conn_close(oldest);
+            slot = oldest;
+        }
+
+        slot->h.fd = fd;
+        slot->h.cb = on_conn;
+        slot->h.ctx = slot;
+        slot->srv = m;
+        slot->req_len = 0;
+        slot->head_len = 0;
+        slot->body = NULL;
+        slot->sent = 0;
+        slot->since_us = mono_us();
+        if (ev_add(m->loop, &slot->h, EPOLLIN) == -1) {
+            close(fd);
+            slot->h.fd = -1;
+        }
+    }
+}
+
+// ========== LISTENER ==========
+
+static int listen_unix(MetricsServer *m, const char *path) {
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(sa.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(sa.sun_path, path);
+
+    // Verwaisten Socket einer früheren Instanz entfernen, andere Dateien nicht
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) == -1) {
+        close(fd);
+        return -1;
+    }
+    strcpy(m->unix_path, path);
+    return fd;
+}
+
+static int listen_tcp(const char *addr) {
+    char host[64] = "127.0.0.1";
+    const char *port = addr;
+    const char *colon = strrchr(addr, ':');
+    if (colon) {
+        size_t n = (size_t)(colon - addr);
+        if (n >= sizeof(host)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (n > 0) {
+            memcpy(host, addr, n);
+            host[n] = '\0';
+        }
+        port = colon + 1;
+    }
+
+    char *end;
+    long p = strtol(port, &end, 10);
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons((uint16_t)p) };
+    if (*port == '\0' || *end != '\0' || p <= 0 || p > 65535 ||
+        inet_pton(AF_INET, host, &sa.sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int metrics_open(MetricsServer *m, const char *addr, EvLoop *loop, MetricsFill fill) {
+    memset(m, 0, sizeof(*m));
+    m->loop = loop;
+    m->fill = fill;
+    m->stale = 1;
+    for (int i = 0; i < METRICS_MAX_CONNS; i++) m->conns[i].h.fd = -1;
+
+    int fd = strncmp(addr, "unix:", 5) == 0 ? listen_unix(m, addr + 5) : listen_tcp(addr);
+    if (fd < 0) return -1;
+    if (listen(fd, 16) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    m->listener.fd = fd;
+    m->listener.cb = on_accept;
+    m->listener.ctx = m;
+    if (ev_add(loop, &m->listener, EPOLLIN) == -1) {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+void metrics_close(MetricsServer *m) {
+    if (!m->loop) return;
+    for (int i = 0; i < METRICS_MAX_CONNS; i++) {
+        if (m->conns[i].h.fd >= 0) conn_close(&m->conns[i]);
+    }
+    ev_del(m->loop, &m->listener);
+    close(m->listener.fd);
+    if (m->unix_path[0]) unlink(m->unix_path);
+    m->loop = NULL;
+}
@@ -0,0 +1,85 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * OpenMetrics-Endpunkt (HTTP/1.0, GET /metrics) auf TCP oder Unix-Socket.
+ * Läuft non-blocking im Eventloop. Die Antwort wird höchstens einmal pro
+ * Sample neu aufgebaut und danach für alle Abfragen wiederverwendet.
+ */
+
+#ifndef PINGMON_METRICS_H
+#define PINGMON_METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "evloop.h"
+#include "stats.h"
+
+#define METRICS_MAX_CONNS 16
+#define METRICS_BODY_MAX  32768     // reicht für ~30 Zeilen mit maskiertem Zielnamen
+#define METRICS_LABEL_MAX 512       // Zielname (bis 255 Zeichen) maskiert
+#define METRICS_REQ_MAX   1024
+
+// Momentaufnahme, die pingmon beim Neuaufbau liefert
+typedef struct {
+    const char *target;
+    uint64_t sent;
+    uint64_t recv;
+    uint64_t dup;            // doppelte Antworten
+    uint64_t reordered;      // vertauschte Antworten
+    uint64_t late;           // Antworten nach dem Timeout
+    double last_ms;
+    double avg_ms;
+    double loss_percent;
+    double quality;
+    double stability;
+    const LatencyStats *lat;
+} MetricsSnapshot;
+
+typedef void (*MetricsFill)(MetricsSnapshot *snap);
+
+// Fertige Antwort; während sie gesendet wird, nicht überschreiben
+typedef struct {
+    char data[METRICS_BODY_MAX];
+    size_t len;
+    int users;
+} MetricsBody;
+
+typedef struct {
+    EvHandler h;             // h.fd < 0 = frei
+    struct MetricsServer *srv;
+    char req[METRICS_REQ_MAX];
+    size_t req_len;
+    char head[160];
+    size_t head_len;
+    MetricsBody *body;       // NULL bei Fehlerantwort
+    size_t sent;
+    int64_t since_us;
+} MetricsConn;
+
+typedef struct MetricsServer {
+    EvHandler listener;
+    EvLoop *loop;
+    MetricsFill fill;
+    MetricsBody bodies[2];
+    int cur;                 // Index der aktuellen Antwort
+    int stale;               // neues Sample seit dem letzten Aufbau
+    char unix_path[108];
+    MetricsConn conns[METRICS_MAX_CONNS];
+    uint64_t requests;
+    uint64_t builds;
+} MetricsServer;
+
+// Lauschen auf "unix:/pfad", "host:port" oder "port" (dann 127.0.0.1).
+// 0 = OK, -1 = Fehler (errno)
+int metrics_open(MetricsServer *m, const char *addr, EvLoop *loop, MetricsFill fill);
+
+// Nach jedem Sample aufrufen; kostet nur ein Flag
+static inline void metrics_invalidate(MetricsServer *m) {
+    m->stale = 1;
+}
+
+void metrics_close(MetricsServer *m);
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Asynchrone MyIP-Abfrage mit Cache (siehe myip.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+#include "myip.h"
+#include "icmp.h"
+
+static const char *default_ip_urls[] = {
+    "http://ifconfig.me",
+    "http://checkip.amazonaws.com",
+    "http://ipinfo.io/ip",
+};
+
+static const struct {
+    const char *code;
+    const char *name;
+} countries[] = {
+    {"DE", "Germany"}, {"US", "USA"}, {"GB", "UK"}, {"FR", "France"},
+    {"ES", "Spain"}, {"IT", "Italy"}, {"NL", "Netherlands"},
+    {"CH", "Switzerland"}, {"AT", "Austria"}, {"PL", "Poland"},
+    {"BE", "Belgium"}, {"SE", "Sweden"}, {"NO", "Norway"}, {"DK", "Denmark"},
+    {"FI", "Finland"}, {"CZ", "Czech Republic"}, {"HU", "Hungary"},
+    {"RO", "Romania"},
+};
+
+static int valid_ipv4(const char *s) {
+    struct in_addr a;
+    return inet_pton(AF_INET, s, &a) == 1;
+}
+
+static void notify(MyIpLookup *m) {
+    if (m->on_update) m->on_update();
+}
+
+// ========== CACHE ==========
+
+void myip_init(MyIpLookup *m, EvLoop *loop) {
+    memset(m, 0, sizeof(*m));
+    m->loop = loop;
+    m->org_url = "http://ipinfo.io/org";
+    m->country_url = "http://ipinfo.io/country";
+    m->cache_ttl = MYIP_DEFAULT_TTL;
+    for (size_t i = 0; i < sizeof(default_ip_urls) / sizeof(default_ip_urls[0]); i++) {
+        m->ip_urls[m->ip_url_count++] = default_ip_urls[i];
+    }
+    for (int i = 0; i < MYIP_JOBS; i++) m->jobs[i].h.fd = -1;
+
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    if (xdg && *xdg) {
+        snprintf(m->cache_path, sizeof(m->cache_path), "%s/pingmon/myip", xdg);
+    } else if (home && *home) {
+        snprintf(m->cache_path, sizeof(m->cache_path), "%s/.cache/pingmon/myip", home);
+    }
+}
+
+int myip_add_ip_url(MyIpLookup *m, const char *url) {
+    if (!m->custom_ip_urls) {
+        m->ip_url_count = 0;
+        m->custom_ip_urls = 1;
+    }
+    if (m->ip_url_count == MYIP_MAX_URLS) return -1;
+    m->ip_urls[m->ip_url_count++] = url;
+    return 0;
+}
+
+// Kopieren mit Abschneiden
+static void copy_field(char *dst, size_t size, const char *src) {
+    size_t n = strnlen(src, size - 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+int myip_load_cache(MyIpLookup *m) {
+    if (!m->cache_path[0] || m->cache_ttl <= 0) return 0;
+
+    FILE *f = fopen(m->cache_path, "r");
+    if (!f) return 0;
+
+    IPInfo info = {0};
+    long long stamp = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *eq = strchr(line, '=');
+        if (!eq || line[0] == '#') continue;
+        *eq = '\0';
+        const char *val = eq + 1;
+        if (strcmp(line, "time") == 0) stamp = atoll(val);
+        else if (strcmp(line, "ip") == 0) copy_field(info.ip, sizeof(info.ip), val);
+        else if (strcmp(line, "isp") == 0) copy_field(info.isp, sizeof(info.isp), val);
+        else if (strcmp(line, "location") == 0) copy_field(info.location, sizeof(info.location), val);
+    }
+    fclose(f);
+
+    long long age = (long long)time(NULL) - stamp;
+    if (!valid_ipv4(info.ip) || age < 0 || age > m->cache_ttl) return 0;
+
+    info.fetched = 1;
+    m->info = info;
+    m->state = MYIP_DONE;
+    return 1;
+}
+
+// Atomar über temporäre Datei und rename()
+static void save_cache(const MyIpLookup *m) {
+    if (!m->cache_path[0]) return;
+
+    char dir[256];
+    copy_field(dir, sizeof(dir), m->cache_path);
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        // Elternverzeichnisse anlegen (~/.cache/pingmon)
+        for (char *p = dir + 1; *p; p++) {
+            if (*p == '/') {
+                *p = '\0';
+                mkdir(dir, 0700);
+                *p = '/';
+            }
+        }
+        mkdir(dir, 0700);
+    }
+
+    char tmp[300];
+    snprintf(tmp, sizeof(tmp), "%s.%d", m->cache_path, (int)getpid());
+    FILE *f = fopen(tmp, "w");
+    if (!f) return;
+    fprintf(f, "# pingmon myip cache\n");
+    fprintf(f, "time=%lld\n", (long long)time(NULL));
+    fprintf(f, "ip=%s\nisp=%s\nlocation=%s\n", m->info.ip, m->info.isp, m->info.location);
+    if (fclose(f) != 0 || rename(tmp, m->cache_path) == -1) unlink(tmp);
+}
+
+// ========== KINDPROZESSE ==========
+
+static void job_kill(MyIpLookup *m, MyIpJob *j) {
+    if (j->h.fd < 0) return;
+    ev_del(m->loop, &j->h);
+    close(j->h.fd);
+    j->h.fd = -1;
+    if (j->pid > 0) kill(j->pid, SIGTERM);  // eingesammelt wird über SIGCHLD
+}
+
+static int jobs_running(const MyIpLookup *m, MyIpJobKind kind) {
+    int n = 0;
+    for (int i = 0; i < MYIP_JOBS; i++) {
+        if (m->jobs[i].h.fd >= 0 && m->jobs[i].kind == kind) n++;
+    }
+    return n;
+}
+
+static void on_job_readable(EvHandler *h, uint32_t events);
+
+// curl (Fallback wget) ohne Shell starten, Ausgabe über eine Pipe
+static int job_spawn(MyIpLookup *m, MyIpJobKind kind, const char *url) {
+    MyIpJob *j = NULL;
+    for (int i = 0; i < MYIP_JOBS && !j; i++) {
+        if (m->jobs[i].h.fd < 0 && m->jobs[i].pid <= 0) j = &m->jobs[i];
+    }
+    if (!j) return -1;
+
+    int pipefd[2];
+    if (pipe2(pipefd, O_CLOEXEC) == -1) return -1;
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        dup2(pipefd[1], STDOUT_FILENO);
+        int devnull = open("/dev/null", O_RDWR);
+        if (devnull >= 0) {
+            dup2(devnull, STDIN_FILENO);
+            dup2(devnull, STDERR_FILENO);
+        }
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+
+        char *argv[] = {"curl", "-s", "--max-time", "3",
+                        "-H", "Accept: text/plain", (char *)url, NULL};
+        execvp("curl", argv);
+
+        char *wget_argv[] = {"wget", "-qO-", "--timeout=3", (char *)url, NULL};
+        execvp("wget", wget_argv);
+        _exit(127);
+    }
+
+    close(pipefd[1]);
+    fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+
+    j->h.fd = pipefd[0];
+    j->h.cb = on_job_readable;
+    j->h.ctx = m;
+    j->pid = pid;
+    j->kind = kind;
+    j->len = 0;
+    if (ev_add(m->loop, &j->h, EPOLLIN) == -1) {
+        job_kill(m, j);
+        return -1;
+    }
+    return 0;
+}
+
+// ========== ABLAUF ==========
+
+static void finish(MyIpLookup *m) {
+    if (!m->info.isp[0]) strcpy(m->info.isp, "Unknown ISP");
+    if (!m->info.location[0]) strcpy(m->info.location, "Unknown");
+    m->info.fetched = 1;
+    m->state = MYIP_DONE;
+    save_cache(m);
+    notify(m);
+}
+
+static void fail(MyIpLookup *m) {
+    for (int i = 0; i < MYIP_JOBS; i++) job_kill(m, &m->jobs[i]);
+    strcpy(m->info.ip, "Not available");
+    strcpy(m->info.isp, "No connection");
+    strcpy(m->info.location, "Unknown");
+    m->info.fetched = 1;
+    m->state = MYIP_IDLE;    // nächstes 'm' versucht es erneut
+    notify(m);
+}
+
+static void start_details(MyIpLookup *m, int64_t now_us) {
+    m->state = MYIP_QUERY_DETAILS;
+    m->deadline_us = now_us + MYIP_TIMEOUT_US;
+    if (m->org_url[0]) job_spawn(m, JOB_ORG, m->org_url);
+    if (m->country_url[0]) job_spawn(m, JOB_COUNTRY, m->country_url);
+    if (!jobs_running(m, JOB_ORG) && !jobs_running(m, JOB_COUNTRY)) finish(m);
+    else notify(m);
+}
+
+// "AS3320 Deutsche Telekom AG" -> "Deutsche Telekom AG"
+static void set_isp(MyIpLookup *m, const char *s) {
+    if (s[0] == 'A' && s[1] == 'S') {
+        const char *sp = strchr(s, ' ');
+        if (sp) s = sp + 1;
+    }
+    if (*s) copy_field(m->info.isp, sizeof(m->info.isp), s);
+}
+
+static void set_country(MyIpLookup *m, const char *code) {
+    if (!*code || strcmp(code, "undefined") == 0) return;
+    for (size_t i = 0; i < sizeof(countries) / sizeof(countries[0]); i++) {
+        if (strcmp(code, countries[i].code) == 0) {
+            copy_field(m->info.location, sizeof(m->info.location), countries[i].name);
+            return;
+        }
+    }
+    copy_field(m->info.location, sizeof(m->info.location), code);
+}
+
+static void job_done(MyIpLookup *m, MyIpJob *j) {
+    MyIpJobKind kind = j->kind;
+    j->buf[j->len] = '\0';
+    j->buf[strcspn(j->buf, "\r\n")] = '\0';
+
+    // Kindprozess lebt evtl. noch kurz; pid bleibt bis zum Einsammeln belegt
+    ev_del(m->loop, &j->h);
+    close(j->h.fd);
+    j->h.fd = -1;
+
+    if (kind == JOB_IP) {
+        if (m->state != MYIP_QUERY_IP) return;
+        if (valid_ipv4(j->buf)) {
+            copy_field(m->info.ip, sizeof(m->info.ip), j->buf);
+            // Langsamere Quellen abbrechen
+            for (int i = 0; i < MYIP_JOBS; i++) {
+                if (m->jobs[i].kind == JOB_IP) job_kill(m, &m->jobs[i]);
+            }
+            start_details(m, mono_us());
+        } else if (!jobs_running(m, JOB_IP)) {
+            fail(m);
+        }
+        return;
+    }
+
+    if (m->state != MYIP_QUERY_DETAILS) return;
+    if (kind == JOB_ORG) set_isp(m, j->buf);
+    else set_country(m, j->buf);
+    if (!jobs_running(m, JOB_ORG) && !jobs_running(m, JOB_COUNTRY)) finish(m);
+}
+
+static void on_job_readable(EvHandler *h, uint32_t events) {
+    (void)events;
+    MyIpLookup *m = h->ctx;
+    MyIpJob *j = (MyIpJob *)h;   // h ist erstes Feld
+
+    for (;;) {
+        if (j->len == sizeof(j->buf) - 1) {
+            job_done(m, j);
+            return;
+        }
+        ssize_t n = read(h->fd, j->buf + j->len, sizeof(j->buf) - 1 - j->len);
+        if (n > 0) {
+            j->len += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return;
+        job_done(m, j);      // EOF oder Fehler
+        return;
+    }
+}
+
+void myip_start(MyIpLookup *m, int64_t now_us) {
+    if (m->state != MYIP_IDLE) return;
+
+    memset(&m->info, 0, sizeof(m->info));
+    m->state = MYIP_QUERY_IP;
+    m->deadline_us = now_us + MYIP_TIMEOUT_US;
+    for (int i = 0; i < m->ip_url_count; i++) job_spawn(m, JOB_IP, m->ip_urls[i]);
+    if (!jobs_running(m, JOB_IP)) fail(m);
+    else notify(m);
+}
+
+void myip_tick(MyIpLookup *m, int64_t now_us) {
+    if (m->state != MYIP_QUERY_IP && m->state != MYIP_QUERY_DETAILS) return;
+    if (now_us < m->deadline_us) return;
+
+    if (m->state == MYIP_QUERY_IP) {
+        fail(m);
+    } else {
+        for (int i = 0; i < MYIP_JOBS; i++) job_kill(m, &m->jobs[i]);
+        finish(m);
+    }
+}
+
+int myip_reap(MyIpLookup *m, pid_t pid) {
+    for (int i = 0; i < MYIP_JOBS; i++) {
+        if (m->jobs[i].pid == pid) {
+            m->jobs[i].pid = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void myip_cancel(MyIpLookup *m) {
+    for (int i = 0; i < MYIP_JOBS; i++) {
+        job_kill(m, &m->jobs[i]);
+        m->jobs[i].pid = 0;
+    }
+    if (m->state != MYIP_DONE) m->state = MYIP_IDLE;
+}
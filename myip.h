@@ -0,0 +1,91 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Asynchrone MyIP-Abfrage: alle IP-Quellen werden parallel über curl/wget
+ * abgefragt, die erste gültige Antwort gewinnt. Danach laufen ISP- und
+ * Länderabfrage ebenfalls parallel. Das Ergebnis wird mit TTL auf Platte
+ * zwischengespeichert, damit spätere Starts es sofort anzeigen.
+ */
+
+#ifndef PINGMON_MYIP_H
+#define PINGMON_MYIP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "evloop.h"
+
+#define MYIP_MAX_URLS      8
+#define MYIP_JOBS          (MYIP_MAX_URLS + 2)
+#define MYIP_TIMEOUT_US    5000000     // Gesamtfrist pro Phase
+#define MYIP_DEFAULT_TTL   3600        // Sekunden
+
+typedef struct {
+    char ip[64];
+    char isp[128];
+    char location[128];
+    int fetched;
+} IPInfo;
+
+typedef enum {
+    MYIP_IDLE = 0,
+    MYIP_QUERY_IP,           // IP-Quellen laufen
+    MYIP_QUERY_DETAILS,      // ISP und Land laufen
+    MYIP_DONE
+} MyIpState;
+
+typedef enum {
+    JOB_IP = 0,
+    JOB_ORG,
+    JOB_COUNTRY
+} MyIpJobKind;
+
+typedef struct {
+    EvHandler h;             // Lesende Seite der Pipe, h.fd < 0 = frei
+    pid_t pid;
+    MyIpJobKind kind;
+    char buf[256];
+    size_t len;
+} MyIpJob;
+
+typedef struct {
+    EvLoop *loop;
+    const char *ip_urls[MYIP_MAX_URLS];
+    int ip_url_count;
+    int custom_ip_urls;      // Standardliste wurde ersetzt
+    const char *org_url;
+    const char *country_url;
+    char cache_path[256];    // leer = kein Cache
+    int cache_ttl;
+
+    MyIpState state;
+    int64_t deadline_us;
+    MyIpJob jobs[MYIP_JOBS];
+    IPInfo info;
+    void (*on_update)(void); // nach jedem Zustandswechsel
+} MyIpLookup;
+
+// Standard-Quellen und Cache-Pfad setzen ($XDG_CACHE_HOME bzw. ~/.cache)
+void myip_init(MyIpLookup *m, EvLoop *loop);
+
+// Eigene IP-Quelle; die erste ersetzt die Standardliste. 0 = OK, -1 = voll
+int myip_add_ip_url(MyIpLookup *m, const char *url);
+
+// Gültigen Cache laden. 1 = geladen, 0 = fehlt/abgelaufen
+int myip_load_cache(MyIpLookup *m);
+
+// Abfrage starten, falls nicht schon aktiv oder erledigt (nach einem
+// Fehlschlag wird erneut gefragt)
+void myip_start(MyIpLookup *m, int64_t now_us);
+
+// Frist prüfen (aus dem Sekundentakt)
+void myip_tick(MyIpLookup *m, int64_t now_us);
+
+// Beendeten Kindprozess einsammeln. 1 = gehörte zur Abfrage
+int myip_reap(MyIpLookup *m, pid_t pid);
+
+// Laufende Abfragen abbrechen
+void myip_cancel(MyIpLookup *m);
+
+#endif
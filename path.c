@@ -0,0 +1,228 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Parallele Pfadansicht (siehe path.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/ip_icmp.h>
+#include <sys/epoll.h>
+
+#include "path.h"
+
+#define PATH_TTL_BITS  5
+#define PATH_ROUND_MASK (0xffffu >> PATH_TTL_BITS)     // 11 Bit Runde in der Sequenz
+
+// Sequenz: Runde in den oberen 11 Bit, TTL - 1 in den unteren 5
+static inline uint16_t path_seq(uint32_t round, int ttl) {
+    return (uint16_t)(((round & PATH_ROUND_MASK) << PATH_TTL_BITS) | (uint32_t)(ttl - 1));
+}
+
+static void hop_sample(PathHop *h, double rtt_ms) {
+    h->sent++;
+    if (rtt_ms > 0) {
+        h->recv++;
+        h->last = rtt_ms;
+        h->sum += rtt_ms;
+        lat_add(&h->lat, rtt_ms);
+    }
+    h->hist[h->hist_count++ % PATH_HIST] = (float)rtt_ms;
+}
+
+static void hop_clear(PathHop *h) {
+    memset(h, 0, sizeof(*h));
+    lat_reset(&h->lat);
+}
+
+// Offene Probes einer Runde als verloren zählen
+static void expire_round(PathProbe *p, PathRound *r) {
+    while (r->pending) {
+        int bit = __builtin_ctz(r->pending);
+        r->pending &= r->pending - 1;
+        hop_sample(&p->hops[bit], 0);
+    }
+}
+
+// Hinter dem Ziel gibt es keine Hops: Zähler und offene Probes ab TTL
+// last + 1 verwerfen (der Pfad ist kürzer als angenommen)
+static void trim(PathProbe *p, int last) {
+    uint32_t keep = (1u << last) - 1;
+    for (int ttl = last + 1; ttl <= PATH_MAX_HOPS; ttl++) hop_clear(&p->hops[ttl - 1]);
+    for (int i = 0; i < PATH_ROUNDS; i++) p->rounds[i].pending &= keep;
+    if (p->max_reply_ttl > last) p->max_reply_ttl = last;
+}
+
+int path_hops(const PathProbe *p) {
+    if (p->dest_ttl) return p->dest_ttl;
+    int n = p->max_reply_ttl + 1;
+    return n > PATH_MAX_HOPS ? PATH_MAX_HOPS : n;
+}
+
+void path_reset(PathProbe *p) {
+    for (int i = 0; i < PATH_MAX_HOPS; i++) {
+        struct in_addr addr = p->hops[i].addr;
+        hop_clear(&p->hops[i]);
+        p->hops[i].addr = addr;
+    }
+    for (int i = 0; i < PATH_ROUNDS; i++) p->rounds[i].pending = 0;
+}
+
+// Eine Runde: alle Hops bis zum Ziel (unbekannt: bis PATH_MAX_HOPS) auf einmal
+static void send_round(PathProbe *p, int64_t now_us) {
+    PathRound *r = &p->rounds[p->round % PATH_ROUNDS];
+    expire_round(p, r);      // Platz wird wiederverwendet
+    r->round = p->round;
+    r->sent_us = now_us;
+    r->pending = 0;
+
+    int limit = p->dest_ttl ? p->dest_ttl : PATH_MAX_HOPS;
+    IcmpProbe probes[PATH_MAX_HOPS];
+    for (int ttl = 1; ttl <= limit; ttl++) {
+        probes[ttl - 1].dst = &p->dst;
+        probes[ttl - 1].seq = path_seq(p->round, ttl);
+        probes[ttl - 1].ttl = (uint8_t)ttl;
+    }
+
+    int done = 0;
+    while (done < limit) {
+        int n = icmp_send_to(&p->icmp, probes + done, limit - done, now_us);
+        if (n <= 0) {
+            // Z. B. keine Route: dieser Hop gilt als verloren
+            p->send_errors++;
+            hop_sample(&p->hops[done], 0);
+            done++;
+            continue;
+        }
+        for (int k = done; k < done + n; k++) r->pending |= 1u << k;
+        p->probes += (uint64_t)n;
+        done += n;
+    }
+    p->round++;
+}
+
+static void expire(PathProbe *p, int64_t now_us) {
+    for (int i = 0; i < PATH_ROUNDS; i++) {
+        PathRound *r = &p->rounds[i];
+        if (r->pending && now_us - r->sent_us >= p->timeout_us) expire_round(p, r);
+    }
+}
+
+static void on_reply(PathProbe *p, const IcmpReply *reply) {
+    int ttl = (reply->seq & ((1u << PATH_TTL_BITS) - 1)) + 1;
+    uint32_t round = reply->seq >> PATH_TTL_BITS;
+    if (ttl > PATH_MAX_HOPS) return;
+
+    // PATH_ROUNDS teilt 2^11: der Platz folgt aus den unteren Bits der Runde
+    PathRound *r = &p->rounds[round % PATH_ROUNDS];
+    uint32_t bit = 1u << (ttl - 1);
+    if ((r->round & PATH_ROUND_MASK) != round || !(r->pending & bit)) return;
+    if (reply->type == ICMP_ECHOREPLY && reply->from.s_addr != p->dst.sin_addr.s_addr) return;
+    r->pending &= ~bit;
+
+    if (reply->type == ICMP_ECHOREPLY) {
+        // Das Ziel antwortet ab dieser TTL: der Pfad endet hier
+        if (!p->dest_ttl || ttl < p->dest_ttl) {
+            p->dest_ttl = ttl;
+            trim(p, ttl);
+        }
+    } else if (reply->type == ICMP_DEST_UNREACH) {
+        // Der Router meldet das Ziel als unerreichbar: weiter geht es nicht
+        if (!p->dest_ttl || ttl < p->dest_ttl) {
+            p->dest_ttl = ttl;
+            trim(p, ttl);
+        }
+    } else if (ttl >= p->dest_ttl && p->dest_ttl) {
+        // Ein Router, wo das Ziel erwartet wurde: der Pfad ist länger geworden
+        p->dest_ttl = 0;
+    }
+
+    PathHop *h = &p->hops[ttl - 1];
+    if (h->addr.s_addr && h->addr.s_addr != reply->from.s_addr) h->changed = 1;
+    h->addr = reply->from;
+
+    // Ohne zitierten Payload aus der eigenen Sendezeit der Runde
+    double rtt = reply->rtt_ns > 0 ? reply->rtt_ns / 1e6 : (reply->recv_us - r->sent_us) / 1000.0;
+    hop_sample(h, rtt > 0 ? rtt : 0.001);
+    if (ttl > p->max_reply_ttl) p->max_reply_ttl = ttl;
+}
+
+static void on_path_icmp(EvHandler *h, uint32_t events) {
+    (void)events;
+    PathProbe *p = h->ctx;
+    IcmpReply replies[ICMP_BATCH];
+    int n, total = 0;
+
+    while ((n = icmp_recv_batch(&p->icmp, replies, ICMP_BATCH)) > 0) {
+        for (int i = 0; i < n; i++) on_reply(p, &replies[i]);
+        total += n;
+        if (n < ICMP_BATCH) break;
+    }
+    if (total > 0 && p->on_update) p->on_update();
+}
+
+static void on_path_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    PathProbe *p = h->ctx;
+    ev_timer_read(h->fd);
+
+    int64_t now_us = mono_us();
+    expire(p, now_us);
+    send_round(p, now_us);
+    if (p->on_update) p->on_update();
+}
+
+int path_start(PathProbe *p, EvLoop *loop, const struct in_addr *dst, int64_t interval_us, int64_t timeout_us) {
+    void (*on_update)(void) = p->on_update;
+    memset(p, 0, sizeof(*p));
+    p->on_update = on_update;
+    p->loop = loop;
+    p->icmp_handler.fd = p->timer_handler.fd = -1;
+    p->dst.sin_family = AF_INET;
+    p->dst.sin_addr = *dst;
+    p->interval_us = interval_us;
+    p->timeout_us = timeout_us;
+    for (int i = 0; i < PATH_MAX_HOPS; i++) lat_reset(&p->hops[i].lat);
+
+    if (icmp_open_any(&p->icmp) == -1) return -1;
+    // Raw-Sockets sehen alle Echo-Replies: eigene ID neben den normalen Probes
+    if (p->icmp.raw) p->icmp.ident = (uint16_t)~p->icmp.ident;
+    if (icmp_enable_errors(&p->icmp) == -1 ||
+        (p->timer_handler.fd = ev_timer_new()) == -1) {
+        int err = errno;
+        path_stop(p);
+        errno = err;
+        return -1;
+    }
+    p->icmp_handler.fd = p->icmp.fd;
+    p->icmp_handler.cb = on_path_icmp;
+    p->icmp_handler.ctx = p;
+    p->timer_handler.cb = on_path_timer;
+    p->timer_handler.ctx = p;
+
+    if (ev_add(loop, &p->icmp_handler, EPOLLIN) == -1 ||
+        ev_add(loop, &p->timer_handler, EPOLLIN) == -1 ||
+        ev_timer_arm(p->timer_handler.fd, 0, interval_us) == -1) {
+        int err = errno;
+        path_stop(p);
+        errno = err;
+        return -1;
+    }
+    p->running = 1;
+    return 0;
+}
+
+void path_stop(PathProbe *p) {
+    if (!p->loop) return;    // nie gestartet
+    if (p->icmp_handler.fd >= 0) ev_del(p->loop, &p->icmp_handler);
+    if (p->timer_handler.fd >= 0) ev_del(p->loop, &p->timer_handler);
+    if (p->timer_handler.fd >= 0) close(p->timer_handler.fd);
+    icmp_close(&p->icmp);
+    p->icmp_handler.fd = p->timer_handler.fd = -1;
+    p->loop = NULL;
+    p->running = 0;
+}
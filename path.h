@@ -0,0 +1,88 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Pfadansicht wie mtr, aber parallel: pro Runde geht an jeden Hop eine
+ * Probe mit passender TTL, alle zusammen in einem sendmmsg. Antworten
+ * ("Time Exceeded" der Router, Echo-Reply des Ziels) werden über die
+ * Sequenznummer (Runde und TTL) dem Hop zugeordnet, der ganze Pfad ist
+ * damit nach einem Intervall aktualisiert. Läuft im Eventloop des Aufrufers
+ * mit eigenem ICMP-Socket und eigenem timerfd.
+ */
+
+#ifndef PINGMON_PATH_H
+#define PINGMON_PATH_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+#include "evloop.h"
+#include "icmp.h"
+#include "stats.h"
+
+#define PATH_MAX_HOPS 30            // passt in die unteren 5 Bit der Sequenz
+#define PATH_HIST     40            // letzte RTTs pro Hop für die Verlaufsanzeige
+#define PATH_ROUNDS   64            // offene Runden; ältere zählen als verloren
+#define PATH_MIN_INTERVAL_US 100000    // Router drosseln ICMP-Fehler (Linux: 1/s, Burst 6)
+
+typedef struct {
+    struct in_addr addr;     // zuletzt antwortender Router, 0 = noch keiner
+    int changed;             // mehr als eine Adresse gesehen (ECMP, Routenwechsel)
+    uint64_t sent;
+    uint64_t recv;
+    double last;
+    double sum;
+    LatencyStats lat;
+    float hist[PATH_HIST];   // Ring der letzten RTTs in ms, 0 = verloren
+    uint32_t hist_count;
+} PathHop;
+
+typedef struct {
+    uint32_t round;          // Rundennummer, die diesen Platz belegt
+    int64_t sent_us;
+    uint32_t pending;        // Bit ttl-1: noch offen
+} PathRound;
+
+typedef struct {
+    IcmpEngine icmp;
+    EvLoop *loop;
+    EvHandler icmp_handler;
+    EvHandler timer_handler;
+    struct sockaddr_in dst;
+    int64_t interval_us;
+    int64_t timeout_us;
+    int running;
+
+    uint32_t round;          // nächste zu sendende Runde
+    int dest_ttl;            // kleinste TTL, bei der das Ziel selbst antwortet, 0 = unbekannt
+    int max_reply_ttl;       // höchste TTL mit irgendeiner Antwort
+    PathHop hops[PATH_MAX_HOPS];
+    PathRound rounds[PATH_ROUNDS];
+    uint64_t probes;         // gesendete Probes insgesamt
+    uint64_t send_errors;
+
+    void (*on_update)(void); // nach neuen Antworten oder Verlusten
+} PathProbe;
+
+// Socket öffnen und im Takt interval_us Runden an dst senden.
+// 0 = OK, -1 = Fehler (errno)
+int path_start(PathProbe *p, EvLoop *loop, const struct in_addr *dst, int64_t interval_us, int64_t timeout_us);
+void path_stop(PathProbe *p);
+
+// Zähler und Verlauf aller Hops zurücksetzen, der bekannte Pfad bleibt
+void path_reset(PathProbe *p);
+
+// Anzuzeigende Hops: bis zum Ziel, sonst bis eine hinter der letzten Antwort
+int path_hops(const PathProbe *p);
+
+static inline double path_loss(const PathHop *h) {
+    return h->sent > 0 ? (double)(h->sent - h->recv) * 100.0 / (double)h->sent : 0.0;
+}
+
+// Eintrag age (0 = neuester) aus dem Verlauf, -1 wenn nicht vorhanden
+static inline double path_hist_at(const PathHop *h, uint32_t age) {
+    if (age >= h->hist_count || age >= PATH_HIST) return -1;
+    return h->hist[(h->hist_count - 1 - age) % PATH_HIST];
+}
+
+#endif
@@ -24,11 +24,12 @@
  * For commercial licensing inquiries, contact: flyingzeroc@gmail.com
  */
 
+#define _GNU_SOURCE
+
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
-#include <regex.h>
 #include <sys/wait.h>
 #include <stdio.h>
 #include <signal.h>
@@ -36,11 +37,58 @@
 #include <time.h>
 #include <termios.h>
 #include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <arpa/inet.h>
+#include <netdb.h>
 #include <errno.h>
+#include <getopt.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+
+#include "icmp.h"
+#include "pingparse.h"
+#include "evloop.h"
+#include "screen.h"
+#include "stats.h"
+#include "rollup.h"
+#include "series.h"
+#include "samplelog.h"
+#include "metrics.h"
+#include "myip.h"
+#include "seqtrack.h"
+#include "fleet.h"
+#include "rank.h"
+#include "path.h"
+#include "resolve.h"
+#include "connprobe.h"
+#include "emit.h"
+#include "shmstats.h"
+#include "heatmap.h"
+
+#define HIST_SIZE 40        // Maximale Breite der History-Grafik
+#define FLEET_BAR_LEN 10    // Stabilitätsbalken pro Zeile der Rangliste
+#define FLEET_FIXED_W 62    // Rangliste ohne Name und Verlauf (Auswahl bis Every)
+#define FLEET_NAME_W_MIN 12 // Namensspalte der Rangliste
+#define FLEET_NAME_W_MAX 20
+#define PATH_FIXED_W  78    // Pfadansicht ohne Verlauf (# bis Worst)
+#define HEAT_LABEL_W  8     // Latenzbeschriftung links der Heatmap
+#define HEAT_SLICE_PROBES 10        // Zeitscheibe der Heatmap: 10 Probes,
+#define HEAT_SLICE_MIN_US 1000000   // aber mindestens 1 s
+
+// Zusatzspalten im Metrikblock (Perzentile, StdDev, Jitter)
+#define STAT_COL_1        23
+#define STAT_COL_2        43
+#define STAT_LABEL_WIDTH  8
+#define VALUE_WIDTH 8
 
-#define BUF_SIZE 512
-#define HIST_SIZE 40
+// Native ICMP-Probes
+#define PROBE_INTERVAL_US 1000000
+#define PROBE_TIMEOUT_US  2000000
+#define MIN_INTERVAL_US   1000      // Schnellmodus bis 1 ms
+#define RENDER_MIN_US     50000     // Höchstens 20 Frames/s
+#define PUBLISH_MIN_US    50000     // --publish: höchstens 20 Kopien/s
+#define ATTACH_POLL_US    50000     // --attach: Abfragetakt
 
 // ANSI Escape Codes
 #define ANSI_RESET      "\033[0m"
@@ -64,18 +112,18 @@
 #define ANSI_ORANGE  "\033[38;5;214m"
 #define ANSI_BG_BLACK "\033[40m"
 
+// Heatmap: Anteil an den Antworten der Spalte, kalt nach heiß
+#define ANSI_HEAT_1  "\033[38;5;25m"
+#define ANSI_HEAT_2  "\033[38;5;37m"
+#define ANSI_HEAT_3  "\033[38;5;40m"
+#define ANSI_HEAT_4  "\033[38;5;220m"
+#define ANSI_HEAT_5  "\033[38;5;196m"
+
 // Cursor positionieren
 #define CURSOR_POS(y, x) printf("\033[%d;%dH", (y), (x))
 
-// MyIP-Struktur
-typedef struct {
-    char ip[64];
-    char isp[128];
-    char location[128];
-    int fetched;
-} IPInfo;
-
-IPInfo my_ip = {0};
+// MyIP-Abfrage (asynchron, mit Cache)
+MyIpLookup myip;
 
 // Variablen umbenannt wegen Namenskonflikt mit socket.h
 int packets_sent = 0;
@@ -85,24 +133,70 @@ double last = 0;
 time_t last_ping_time = 0;
 int show_ip_info = 0;
 
-// History-Puffer
-double history[HIST_SIZE] = {0};
-int hist_idx = 0;
+// History: Rohwerte pro Probe plus 10s/1min/10min-Verdichtungen
+Rollups rollups;
+int history_tier = TIER_RAW;
+
+// Heatmap (Taste g): Latenzverteilung pro Zeitscheibe
+HeatMap heat;
+int heat_view = 0;
+
+// Jede einzelne Probe, komprimiert (für Exporte und lange Analysen)
+Series series;
+
+// Optionales Sample-Log auf Platte (--log)
+SampleLog sample_log = { .fd = -1 };
+
+// Optionaler OpenMetrics-Endpunkt (--metrics)
+MetricsServer metrics;
+char status_msg[128] = "";
+
+// Perzentile, StdDev und Jitter über die ganze Sitzung
+LatencyStats lat_stats;
 
 // Global für Signal-Handler
 pid_t ping_pid = -1;
+int ping_opt_O = 1;          // -O gibt es nur bei iputils; entfällt nach einem Fehlstart
+IcmpEngine icmp = { .fd = -1 };
+
+// Offene Probes nach Sequenznummer, Timeout auf der monotonen Uhr
+SeqTracker tracker;
+int64_t probe_timeout_us = PROBE_TIMEOUT_US;
+int64_t probe_interval_us = PROBE_INTERVAL_US;
+int64_t start_us;
 struct termios saved_termios;
 
-// Regex für ping-Ausgaben
-regex_t re_time;
+// Zeilenparser für die Ausgabe des ping-Kindprozesses
+PingReader ping_reader;
+
+// Mehrzielbetrieb (--targets): Worker-Threads statt eigener Probes
+Fleet fleet;
+const char* fleet_path = NULL;
+int term_rows = 0;           // Terminalhöhe für Rangliste und Pfadansicht, höchstens SCREEN_ROWS
+int term_cols = 0;           // Terminalbreite der Vollbildansichten, höchstens SCREEN_COLS
+int fleet_focus = -1;        // Ziel in der Einzelansicht, -1 = Rangliste
+int fleet_sel = 0;           // markierte Zeile der Rangliste
+uint32_t fleet_shown[SCREEN_ROWS];   // Ziele der zuletzt gezeichneten Rangliste
+int fleet_nshown = 0;
+
+// Pfadansicht (p): eigener Socket, die normalen Probes laufen weiter
+PathProbe path;
+int path_view = 0;
+char path_name[FLEET_NAME_MAX];      // Bezeichnung aus der Zielliste, sonst leer
+
+// --headless: kein Terminal, Datensätze nach stdout bzw. --output
+Emitter emitter;
+int headless = 0;
 
 // ========== SICHERHEITSVERBESSERUNGEN ==========
 
 // Signal-Handler für alle kritischen Signale
 void cleanup_and_exit(int sig) {
-    // Terminal zurücksetzen
-    printf("%s%s", ANSI_CURSOR_SHOW, ANSI_RESET);
-    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    // Terminal zurücksetzen (headless gehört stdout den Datensätzen)
+    if (!headless) {
+        printf("%s%s", ANSI_CURSOR_SHOW, ANSI_RESET);
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    }
     
     // Ping-Prozess sicher beenden
     if (ping_pid > 0) {
@@ -111,8 +205,7 @@ void cleanup_and_exit(int sig) {
         waitpid(ping_pid, &status, 0);  // Auf Beendigung warten
     }
     
-    // Regex freigeben
-    regfree(&re_time);
+    icmp_close(&icmp);
     
     fflush(stdout);
     exit(sig);
@@ -124,22 +217,55 @@ void reset_stats(void) {
     last_ping_time = time(NULL);
     
     // History auch zurücksetzen
-    memset(history, 0, sizeof(history));
-    hist_idx = 0;
+    // Schneller als die Bildrate: Rohspalte fasst einen Render-Frame zusammen
+    rollup_init(&rollups, probe_interval_us < RENDER_MIN_US ? RENDER_MIN_US : 0);
+    heat_init(&heat, probe_interval_us * HEAT_SLICE_PROBES > HEAT_SLICE_MIN_US ?
+                     probe_interval_us * HEAT_SLICE_PROBES : HEAT_SLICE_MIN_US);
+    series_free(&series);
+    lat_reset(&lat_stats);
+    
+    // Noch offene Probes nicht mehr zählen
+    seq_reset(&tracker);
+    metrics_invalidate(&metrics);
 }
 
-// IPv4-Validierungsfunktion
-int is_valid_ipv4(const char *str) {
-    struct sockaddr_in sa;
-    return inet_pton(AF_INET, str, &(sa.sin_addr)) == 1;
+// Wert zur History hinzufügen
+// Werte <= 0 sind verlorene Probes und werden ebenfalls festgehalten
+void add_to_history_at(int64_t ts_ms, double value) {
+    rollup_add(&rollups, ts_ms * 1000, value);
+    heat_add(&heat, ts_ms * 1000, value);
+    series_append(&series, ts_ms, value);
 }
 
-// Wert zur History hinzufügen
 void add_to_history(double value) {
-    if (value > 0) {
-        history[hist_idx] = value;
-        hist_idx = (hist_idx + 1) % HIST_SIZE;
+    add_to_history_at(wall_ms(), value);
+}
+
+// Zeitreihe ab from_ms als CSV exportieren (Streaming-Dekoder, kein
+// Zwischenpuffer); ältere Blöcke überspringt die Bereichsabfrage ungelesen
+int export_series(const char* target, int64_t from_ms, char* path, size_t path_size) {
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    snprintf(path, path_size, "pingmon-%s-%04d%02d%02d-%02d%02d%02d.csv", target,
+             tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    
+    fprintf(f, "timestamp_ms,rtt_ms,lost\n");
+    
+    SeriesIter it;
+    SeriesSample smp;
+    int count = 0;
+    series_iter_init(&it, &series, from_ms, INT64_MAX);
+    while (series_iter_next(&it, &smp)) {
+        fprintf(f, "%lld,%.3f,%d\n", (long long)smp.ts_ms, smp.rtt_ms, smp.lost);
+        count++;
     }
+    
+    if (fclose(f) != 0) return -1;
+    return count;
 }
 
 // NEU: Farbe basierend auf WARN/CRIT (wie Quality-Balken)
@@ -151,7 +277,7 @@ const char* get_history_color(double value, double warn, double crit) {
 
 // History anzeigen (automatisch an Fußleiste ausgerichtet)
 void draw_history(int line, int total_width, double warn, double crit) {
-    CURSOR_POS(line, 1);
+    scr_clear_row(line);
     
     // Korrekte Breitenberechnung:
     // "History: " = 9 Zeichen
@@ -167,200 +293,47 @@ void draw_history(int line, int total_width, double warn, double crit) {
     if (graph_width < 10) graph_width = 10;
     if (graph_width > total_width - 5) graph_width = total_width - 15;
     
-    printf("%sHistory:%s ", ANSI_BOLD ANSI_WHITE, ANSI_RESET);
+    // Beschriftung zeigt die gewählte Auflösung
+    const RollupTier *tier = &rollups.tiers[history_tier];
+    char label[16];
+    if (history_tier == TIER_RAW) snprintf(label, sizeof(label), "History:");
+    else snprintf(label, sizeof(label), "Hist%3s:", tier->label);
+    
+    int col = scr_put(line, 1, ANSI_BOLD ANSI_WHITE, label);
+    col++;
     
     // History-Grafik zeichnen MIT DEN SELBEN FARBEN WIE QUALITY
+    // Nur die verdichteten Einträge lesen, nie die Rohwerte neu auswerten
     for (int i = 0; i < graph_width; i++) {
-        int idx = (hist_idx + i) % HIST_SIZE;
-        double val = history[idx];
+        const RollupBucket *b = rollup_at(&rollups, history_tier, graph_width - 1 - i);
         
-        if (val == 0) {
-            printf("%s·%s", ANSI_WHITE, ANSI_RESET);
+        if (!b || (b->recv == 0 && b->lost == 0)) {
+            col = scr_put(line, col, ANSI_WHITE, "·");
+        } else if (b->recv == 0) {
+            col = scr_put(line, col, ANSI_RED, "×");
         } else {
             // WICHTIG: Gleiche Farblogik wie beim Quality-Balken!
-            const char* color = get_history_color(val, warn, crit);
-            printf("%s█%s", color, ANSI_RESET);
+            const char* color = get_history_color(rollup_avg(b), warn, crit);
+            col = scr_put(line, col, color, b->lost ? "▒" : "█");
         }
     }
     
     // Letzten Wert als Zahl anzeigen (rechtsbündig)
-    int last_idx = (hist_idx - 1 + HIST_SIZE) % HIST_SIZE;
-    if (history[last_idx] > 0) {
-        const char* color = get_history_color(history[last_idx], warn, crit);
-        printf(" %s%.0fms%s", color, history[last_idx], ANSI_RESET);
-    }
-    
-    // WICHTIG: Rest der Zeile löschen für exakte Breite
-    // Wir müssen bis zum Ende der Fußleiste löschen
-    int current_pos = label_width + graph_width + 6; // +6 für " XXms" + Farbcodes
-    if (current_pos < total_width) {
-        // Cursor ans Ende bewegen und Rest löschen
-        CURSOR_POS(line, current_pos + 1);
-        printf("%s", ANSI_CLEAR_LINE);
+    const RollupBucket *newest = rollup_at(&rollups, history_tier, 0);
+    if (newest && newest->recv > 0) {
+        double val = rollup_avg(newest);
+        const char* color = get_history_color(val, warn, crit);
+        scr_printf(line, col + 1, color, "%.0fms", val);
     }
 }
 
 // ========== SICHERES POPEN-REPLACEMENT ==========
 
-// NEU: Sichere Ausführung von curl/wget ohne shell
-int safe_exec_http_get(const char* url, char* buffer, size_t buf_size) {
-    int pipefd[2];
-    if (pipe(pipefd) == -1) {
-        return -1;
-    }
-    
-    pid_t pid = fork();
-    if (pid == -1) {
-        close(pipefd[0]);
-        close(pipefd[1]);
-        return -1;
-    }
-    
-    if (pid == 0) { // Child
-        close(pipefd[0]);
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[1]);
-        
-        // Sichere execvp ohne Shell
-        if (strstr(url, "ipinfo.io") != NULL) {
-            // Für ipinfo.io spezifische Kopfzeile
-            char* argv[] = {"curl", "-s", "--max-time", "3", 
-                           "-H", "Accept: application/json",
-                           (char*)url, NULL};
-            execvp("curl", argv);
-        } else {
-            // Allgemeiner Fall
-            char* argv[] = {"curl", "-s", "--max-time", "3", (char*)url, NULL};
-            execvp("curl", argv);
-        }
-        
-        // Fallback zu wget wenn curl fehlschlägt
-        char* wget_argv[] = {"wget", "-qO-", "--timeout=3", (char*)url, NULL};
-        execvp("wget", wget_argv);
-        
-        _exit(127); // exec fehlgeschlagen
-    }
-    
-    // Parent
-    close(pipefd[1]);
-    
-    // Timeout für read
-    fd_set fds;
-    struct timeval tv = {3, 0}; // 3 Sekunden timeout
-    
-    FD_ZERO(&fds);
-    FD_SET(pipefd[0], &fds);
-    
-    if (select(pipefd[0] + 1, &fds, NULL, NULL, &tv) > 0) {
-        ssize_t bytes = read(pipefd[0], buffer, buf_size - 1);
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            // Newline entfernen
-            buffer[strcspn(buffer, "\n\r")] = '\0';
-        }
-    }
-    
-    close(pipefd[0]);
-    
-    int status;
-    waitpid(pid, &status, 0);
-    
-    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
-}
-
-// NEU: MyIP-Abfrage mit sicheren execvp Aufrufen
-void fetch_ip_info(IPInfo *info) {
-    if (info->fetched) return;
-    
-    char buffer[128];
-    
-    // 1. IP-Adresse abrufen (mit mehreren Quellen für Redundanz)
-    const char* ip_urls[] = {
-        "http://ifconfig.me",
-        "http://checkip.amazonaws.com",
-        "http://ipinfo.io/ip",
-        NULL
-    };
-    
-    for (int i = 0; ip_urls[i] && strlen(info->ip) == 0; i++) {
-        if (safe_exec_http_get(ip_urls[i], buffer, sizeof(buffer)) == 0) {
-            if (strlen(buffer) >= 7) {
-                int dots = 0;
-                for (int j = 0; buffer[j]; j++) {
-                    if (buffer[j] == '.') dots++;
-                }
-                if (dots >= 3 && is_valid_ipv4(buffer)) {
-                    strncpy(info->ip, buffer, sizeof(info->ip) - 1);
-                    info->ip[sizeof(info->ip) - 1] = '\0';
-                }
-            }
-        }
-    }
-    
-    // 2. ISP/Organisation abrufen (wenn IP gefunden)
-    if (strlen(info->ip) > 0) {
-        if (safe_exec_http_get("http://ipinfo.io/org", buffer, sizeof(buffer)) == 0) {
-            if (strlen(buffer) > 0) {
-                char *first_space = strchr(buffer, ' ');
-                if (first_space) {
-                    char *second_space = strchr(first_space + 1, ' ');
-                    if (second_space) {
-                        strncpy(info->isp, second_space + 1, sizeof(info->isp) - 1);
-                        info->isp[sizeof(info->isp) - 1] = '\0';
-                    } else {
-                        strncpy(info->isp, first_space + 1, sizeof(info->isp) - 1);
-                        info->isp[sizeof(info->isp) - 1] = '\0';
-                    }
-                } else {
-                    strncpy(info->isp, buffer, sizeof(info->isp) - 1);
-                    info->isp[sizeof(info->isp) - 1] = '\0';
-                }
-            } else {
-                strcpy(info->isp, "Unknown ISP");
-            }
-        } else {
-            strcpy(info->isp, "Unknown ISP");
-        }
-        
-        // 3. Nur LANDESCODE abrufen
-        if (safe_exec_http_get("http://ipinfo.io/country", buffer, sizeof(buffer)) == 0) {
-            if (strlen(buffer) > 0 && strcmp(buffer, "undefined") != 0) {
-                // Länderkürzel in Namen umwandeln
-                if (strcmp(buffer, "DE") == 0) strcpy(info->location, "Germany");
-                else if (strcmp(buffer, "US") == 0) strcpy(info->location, "USA");
-                else if (strcmp(buffer, "GB") == 0) strcpy(info->location, "UK");
-                else if (strcmp(buffer, "FR") == 0) strcpy(info->location, "France");
-                else if (strcmp(buffer, "ES") == 0) strcpy(info->location, "Spain");
-                else if (strcmp(buffer, "IT") == 0) strcpy(info->location, "Italy");
-                else if (strcmp(buffer, "NL") == 0) strcpy(info->location, "Netherlands");
-                else if (strcmp(buffer, "CH") == 0) strcpy(info->location, "Switzerland");
-                else if (strcmp(buffer, "AT") == 0) strcpy(info->location, "Austria");
-                else if (strcmp(buffer, "PL") == 0) strcpy(info->location, "Poland");
-                else if (strcmp(buffer, "BE") == 0) strcpy(info->location, "Belgium");
-                else if (strcmp(buffer, "SE") == 0) strcpy(info->location, "Sweden");
-                else if (strcmp(buffer, "NO") == 0) strcpy(info->location, "Norway");
-                else if (strcmp(buffer, "DK") == 0) strcpy(info->location, "Denmark");
-                else if (strcmp(buffer, "FI") == 0) strcpy(info->location, "Finland");
-                else if (strcmp(buffer, "CZ") == 0) strcpy(info->location, "Czech Republic");
-                else if (strcmp(buffer, "HU") == 0) strcpy(info->location, "Hungary");
-                else if (strcmp(buffer, "RO") == 0) strcpy(info->location, "Romania");
-                else {
-                    strncpy(info->location, buffer, sizeof(info->location) - 1);
-                    info->location[sizeof(info->location) - 1] = '\0';
-                }
-            } else {
-                strcpy(info->location, "Unknown");
-            }
-        } else {
-            strcpy(info->location, "Unknown");
-        }
-    } else {
-        strcpy(info->ip, "Not available");
-        strcpy(info->isp, "No connection");
-        strcpy(info->location, "Unknown");
-    }
-    
-    info->fetched = 1;
+// Im Kindprozess: die für signalfd blockierten Signale wieder freigeben
+void unblock_signals(void) {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
 }
 
 // Hilfsfunktion: Farbe basierend auf Wert
@@ -370,47 +343,63 @@ const char* get_color(double value, double warn, double crit) {
     return ANSI_GREEN;
 }
 
-// Ping-Qualität berechnen
-double calculate_quality(double last_ms) {
-    if (last_ms <= 5) return 100.0;
-    else if (last_ms <= 20) return 80.0 + (20.0 - last_ms) * 1.3333;
-    else if (last_ms <= 30) return 60.0 + (30.0 - last_ms) * 2.0;
-    else if (last_ms <= 60) return 30.0 + (60.0 - last_ms) * 1.0;
-    else if (last_ms <= 100) return 10.0 + (100.0 - last_ms) * 0.5;
-    else return 0.0;
+// Farben der Quality-/Stability-Balken
+const char* get_quality_color(double quality) {
+    if (quality >= 80) return ANSI_GREEN;
+    if (quality >= 60) return ANSI_YELLOW;
+    if (quality >= 40) return ANSI_ORANGE;
+    return ANSI_RED;
 }
 
-// Stabilität berechnen
-double calculate_stability(double loss_percent) {
-    if (loss_percent <= 0.1) return 100.0;
-    else if (loss_percent <= 1.0) return 100.0 - loss_percent * 10.0;
-    else if (loss_percent <= 5.0) return 90.0 - (loss_percent - 1.0) * 15.0;
-    else if (loss_percent <= 10.0) return 30.0 - (loss_percent - 5.0) * 6.0;
-    else return 0.0;
+const char* get_stability_color(double stability) {
+    if (stability >= 90) return ANSI_GREEN;
+    if (stability >= 70) return ANSI_YELLOW;
+    if (stability >= 50) return ANSI_ORANGE;
+    return ANSI_RED;
 }
 
-// Dynamischen Balken zeichnen
-void draw_dynamic_bar(double percentage, int length, const char* color) {
+// Dynamischen Balken zeichnen, Rückgabe: Spalte nach dem Balken
+int draw_dynamic_bar(int line, int col, double percentage, int length, const char* color) {
     int filled = (int)(percentage / 100.0 * length + 0.5);
     if (filled > length) filled = length;
     if (filled < 0) filled = 0;
     
-    printf("%s", color);
-    for (int i = 0; i < filled; i++) printf("█");
-    for (int i = filled; i < length; i++) printf("░");
-    printf("%s", ANSI_RESET);
+    col = scr_fill(line, col, filled, color, "█");
+    return scr_fill(line, col, length - filled, color, "░");
 }
 
 // Rechtsbündige Ausrichtung
 void draw_line_right(int line, const char* label, const char* value, const char* color, int width) {
-    CURSOR_POS(line, 1);
-    printf("%s%s%s", ANSI_BOLD ANSI_WHITE, label, ANSI_RESET);
+    scr_clear_row(line);
+    scr_put(line, 1, ANSI_BOLD ANSI_WHITE, label);
+    
+    int value_len = strlen(value);
+    int padding = (value_len < width) ? (width - value_len) : 0;
+    
+    scr_put(line, 20 - width + padding, color, value);
+}
+
+// Wert in einer weiteren Spalte rechts neben draw_line_right()
+void draw_value_at(int line, int col, const char* label, const char* value, const char* color, int width) {
+    scr_put(line, col, ANSI_BOLD ANSI_WHITE, label);
     
     int value_len = strlen(value);
     int padding = (value_len < width) ? (width - value_len) : 0;
     
-    CURSOR_POS(line, 20 - width);
-    printf("%s%*s%s%s%s", color, padding, "", value, ANSI_CLEAR_LINE, ANSI_RESET);
+    scr_put(line, col + STAT_LABEL_WIDTH + padding, color, value);
+}
+
+// Sendeabstand kurz: "250ms" bzw. "4.0s"
+void format_interval(char* buf, size_t size, int64_t us) {
+    if (us < 1000000) snprintf(buf, size, "%.0fms", us / 1000.0);
+    else snprintf(buf, size, "%.1fs", us / 1e6);
+}
+
+// Latenzwert (ms) mit WARN/CRIT-Farbe in einer Zusatzspalte
+void draw_latency_at(int line, int col, const char* label, double value, double warn, double crit) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f ms", value);
+    draw_value_at(line, col, label, buf, get_color(value, warn, crit), VALUE_WIDTH);
 }
 
 // NEU: Sichere execvp für ping mit Fehlerbehandlung
@@ -431,10 +420,15 @@ int safe_start_ping(const char* target, int* pipefd) {
         close(pipefd[0]);
         dup2(pipefd[1], STDOUT_FILENO);
         close(pipefd[1]);
+        unblock_signals();
         
         // Sichere execvp ohne Shell
-        char* argv[] = {"ping", (char*)target, NULL};
-        execvp("ping", argv);
+        // -O: "no answer yet" für jede unbeantwortete Probe
+        char interval[32];
+        snprintf(interval, sizeof(interval), "%.3f", probe_interval_us / 1e6);
+        char* argv[] = {"ping", "-O", "-i", interval, (char*)target, NULL};
+        char* argv_plain[] = {"ping", "-i", interval, (char*)target, NULL};
+        execvp("ping", ping_opt_O ? argv : argv_plain);
         
         // Wenn execvp fehlschlägt
         _exit(127);
@@ -447,308 +441,2232 @@ int safe_start_ping(const char* target, int* pipefd) {
     return 0;
 }
 
-int main(int argc, char *argv[]) {
-    // Terminal-Einstellungen für Cleanup speichern
-    tcgetattr(STDIN_FILENO, &saved_termios);
-    
-    // ========== ERWEITERTE SIGNAL-HANDLER ==========
-    struct sigaction sa;
-    sa.sa_handler = cleanup_and_exit;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART;
+// ========== EVENTLOOP ==========
+
+#define UI_ROWS 16             // Vom Framebuffer verwaltete Zeilen
+
+EvLoop loop = { .epfd = -1 };
+EvHandler probe_handler, stdin_handler, tick_handler, render_handler, signal_handler;
+EvHandler expire_handler;
+
+// Zustand der Hauptschleife
+int running = 1;
+int native = 0;
+int dirty = 1;
+int timeout_state = 0;
+time_t last_success_time = 0;
+int64_t last_render_us = 0;
+int render_armed = 0;
+
+// --publish/--attach: Live-Werte in /dev/shm (siehe shmstats.h)
+EvHandler publish_handler;           // Schreiber: Ratenbegrenzung, Leser: Abfragetakt
+ShmStats shm;
+const char* attach_name = NULL;      // Nur anzeigen, keine eigenen Probes
+int publish_dirty = 0;
+int publish_armed = 0;
+int64_t last_publish_us = 0;
+uint64_t attach_seen = UINT64_MAX;   // publishes der zuletzt übernommenen Kopie
+int attach_gone = 0;                 // Schreiber beendet, Werte eingefroren
+
+// Anzeige-Parameter
+double warn = 30, crit = 60;
+char target[RESOLVE_NAME_MAX] = "8.8.8.8";
+
+// Name oder Adresse aus target; Probes gehen an resolver.addr_str
+Resolver resolver;
+int target_family = AF_UNSPEC;       // -4/-6
+int resolve_ttl = RESOLVE_DEFAULT_TTL;
+int path_pending = 0;                // -p: Pfadansicht nach der ersten Auflösung
+
+// --tcp/--udp: Probes über Verbindungsaufbau bzw. UDP-Echo statt ICMP
+ConnProbe conn;
+ConnKind probe_kind = CONN_NONE;
+int probe_port = 0;
+int probe_ready = 0;                 // Probes laufen (Adresse bekannt, Socket offen)
+char footer[] = "© zeroc 2026 | pingmon [warn] [crit] [target] | e.g., pingmon 50 100 1.1.1.1";
+int footer_len = 0;
+int bar_length = 5;
+
+void request_redraw(void) {
+    dirty = 1;
+}
+
+// ========== EIGENMESSUNG ==========
+
+// Was kostet pingmon selbst? Zähler des UI-Threads für die Debugzeile
+// (Taste d) und den Dump auf SIGUSR1
+typedef struct {
+    uint64_t renders;
+    uint64_t render_ns;          // draw_frame + scr_flush, Summe
+    uint64_t render_last_ns;
+    int64_t pending_us;          // älteste noch nicht gezeichnete Antwort, 0 = keine
+    uint64_t lags;
+    int64_t lag_sum_us;          // Antwort verbucht bis Frame geschrieben
+    int64_t lag_last_us;
+    int64_t lag_max_us;
+    uint64_t backlog_last;       // pro Aufwachen abgeholt: Bytes (ping) bzw. Antworten
+    uint64_t backlog_max;
+
+    // Raten über das letzte Fenster von etwa einer Sekunde
+    int64_t window_us;
+    uint64_t window_wakeups;
+    uint64_t window_syscalls;
+    double loops_per_s;
+    double syscalls_per_loop;
+} SelfStats;
+
+SelfStats self;
+int debug_row = 0;
+const char* dump_path = NULL;        // --dump, sonst stderr
+
+int64_t self_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Gezählte Syscalls des UI-Threads: Eventloop und Timer, ping-Pipe,
+// ICMP-Batches, Frames und Ausgabe ohne Oberfläche
+uint64_t self_syscalls(void) {
+    return ev_syscalls() + ping_reader.reads + icmp.send_calls + icmp.recv_calls +
+           scr_stats()->frames + emitter.writes;
+}
+
+// Aus dem Probe-Takt: Raten nach Ablauf des Fensters neu berechnen. 1 = neu
+int self_window(int64_t now_us) {
+    int64_t dt = now_us - self.window_us;
+    if (dt < 950000) return 0;     // Sekundentakt darf etwas früher kommen
     
-    sigaction(SIGINT, &sa, NULL);   // Ctrl+C
-    sigaction(SIGTERM, &sa, NULL);  // kill
-    sigaction(SIGSEGV, &sa, NULL);  // Segmentation Fault
-    sigaction(SIGPIPE, &sa, NULL);  // Broken Pipe
-    sigaction(SIGABRT, &sa, NULL);  // Abort
+    uint64_t wakeups = loop.wakeups, sys = self_syscalls();
+    // Erstes Fenster erst ab hier; Zähler einer neu geöffneten
+    // Probe-Quelle beginnen bei 0
+    if (self.window_us && sys >= self.window_syscalls && wakeups > self.window_wakeups) {
+        uint64_t loops = wakeups - self.window_wakeups;
+        self.loops_per_s = loops * 1e6 / (double)dt;
+        self.syscalls_per_loop = (double)(sys - self.window_syscalls) / (double)loops;
+    }
+    self.window_us = now_us;
+    self.window_wakeups = wakeups;
+    self.window_syscalls = sys;
+    return 1;
+}
+
+// Neue Antwort, die noch gezeichnet werden muss
+void self_reply(void) {
+    if (!self.pending_us && !headless) self.pending_us = mono_us();
+}
+
+// Pro Aufwachen abgeholte Menge (Rückstau im Kernel)
+void self_backlog(uint64_t amount) {
+    self.backlog_last = amount;
+    if (amount > self.backlog_max) self.backlog_max = amount;
+}
+
+// Frame geschrieben: Renderzeit und Verzögerung seit der ältesten Antwort
+void self_frame(int64_t start_ns) {
+    int64_t end_ns = self_ns();
+    self.renders++;
+    self.render_last_ns = (uint64_t)(end_ns - start_ns);
+    self.render_ns += self.render_last_ns;
+    if (self.pending_us) {
+        int64_t lag = end_ns / 1000 - self.pending_us;
+        self.lags++;
+        self.lag_sum_us += lag;
+        self.lag_last_us = lag;
+        if (lag > self.lag_max_us) self.lag_max_us = lag;
+        self.pending_us = 0;
+    }
+}
+
+// Sample in alle Statistiken übernehmen (live und beim Laden des Logs)
+void account_sample(int64_t ts_ms, double rtt_ms) {
+    packets_sent++;
+    if (rtt_ms > 0) {
+        packets_recv++;
+        last = rtt_ms;
+        sum += last;
+        lat_add(&lat_stats, last);
+    }
+    add_to_history_at(ts_ms, rtt_ms);
+    metrics_invalidate(&metrics);
+}
+
+// Momentaufnahme für den Metrics-Endpunkt, nur bei Abruf nach neuem Sample
+void fill_metrics(MetricsSnapshot *snap) {
+    double loss = (packets_sent > 0) ? (packets_sent - packets_recv) * 100.0 / packets_sent : 0.0;
     
-    double warn = 30, crit = 60;
-    char target[64] = "8.8.8.8";
+    snap->target = target;
+    snap->sent = (uint64_t)packets_sent;
+    snap->recv = (uint64_t)packets_recv;
+    snap->dup = tracker.dup;
+    snap->reordered = tracker.reordered;
+    snap->late = tracker.late;
+    snap->last_ms = last;
+    snap->avg_ms = packets_recv > 0 ? sum / packets_recv : 0.0;
+    snap->loss_percent = loss;
+    snap->quality = calculate_quality(last);
+    snap->stability = calculate_stability(loss);
+    snap->lat = &lat_stats;
+}
 
-    // Argument-Parsing mit Fehlerprüfung
-    if (argc > 1) {
-        char* endptr;
-        warn = strtod(argv[1], &endptr);
-        if (*endptr != '\0' || warn <= 0) {
-            warn = 30; // Default bei Fehler
-        }
+// Erfolgreiche Antwort verbuchen
+void record_reply(int seq, int ttl, double rtt_ms) {
+    int64_t now_ms = wall_ms();
+    
+    if (rtt_ms <= 0) rtt_ms = 0.001;  // 0 steht für "verloren"
+    account_sample(now_ms, rtt_ms);
+    if (sample_log.map) slog_append(&sample_log, now_ms, rtt_ms, seq, ttl);
+    if (headless) {
+        uint32_t rtt_us = rtt_ms < 4294967.0 ? (uint32_t)(rtt_ms * 1000.0 + 0.5) : UINT32_MAX;
+        emit_probe(&emitter, 0, now_ms, seq, ttl, rtt_us ? rtt_us : 1);
     }
     
-    if (argc > 2) {
-        char* endptr;
-        crit = strtod(argv[2], &endptr);
-        if (*endptr != '\0' || crit <= warn) {
-            crit = warn + 30; // Mindestens 30 über WARN
+    last_ping_time = time(NULL);
+    last_success_time = last_ping_time;
+    timeout_state = 0;
+    self_reply();
+    dirty = 1;
+}
+
+// Verlorene Probe verbuchen (seq = -1 wenn unbekannt)
+void record_loss(int seq) {
+    int64_t now_ms = wall_ms();
+    
+    account_sample(now_ms, 0);
+    if (sample_log.map) slog_append(&sample_log, now_ms, 0, seq, -1);
+    if (headless) emit_probe(&emitter, 0, now_ms, seq, -1, 0);
+    
+    timeout_state = 1;
+    dirty = 1;
+}
+
+// Zähler und History aus dem Sample-Log wiederherstellen
+void resume_from_log(void) {
+    for (uint64_t i = 0; i < sample_log.count; i++) {
+        const SampleRecord *r = slog_record(&sample_log, i);
+        if (r->flags & SLOG_RESET) {
+            reset_stats();
+            continue;
         }
+        account_sample(r->ts_ms, (r->flags & SLOG_LOST) ? 0 : r->rtt_us / 1000.0);
     }
-    
-    if (argc > 3) {
-        strncpy(target, argv[3], sizeof(target) - 1);
-        target[sizeof(target) - 1] = '\0';
+}
+
+// Nur offene Probes zählen; Duplikate und Nachzügler nur erfassen
+void track_reply(uint16_t seq, int ttl, double rtt_ms) {
+    SeqReplyKind kind = seq_reply(&tracker, seq);
+    if (kind == SEQ_REPLY_OK || kind == SEQ_REPLY_REORDERED) {
+        record_reply(seq, ttl, rtt_ms);
+    } else {
+        metrics_invalidate(&metrics);
+        dirty = 1;
     }
+}
 
-    // IPv4-Validierung mit stiller Korrektur
-    if (!is_valid_ipv4(target)) {
-        strcpy(target, "8.8.8.8");
+// Native Antworten vom ICMP-Socket
+void on_icmp_readable(EvHandler *h, uint32_t events) {
+    (void)h; (void)events;
+    IcmpReply replies[ICMP_BATCH];
+    uint64_t total = 0;
+    int n;
+    
+    while ((n = icmp_recv_batch(&icmp, replies, ICMP_BATCH)) > 0) {
+        for (int i = 0; i < n; i++) track_reply(replies[i].seq, replies[i].ttl, replies[i].rtt_ns / 1e6);
+        total += (uint64_t)n;
+        if (n < ICMP_BATCH) break;
     }
+    self_backlog(total);
+}
 
-    // Terminal auf raw mode setzen
-    struct termios newt = saved_termios;
-    newt.c_lflag &= ~(ICANON | ECHO);
-    if (tcsetattr(STDIN_FILENO, TCSANOW, &newt) == -1) {
-        fprintf(stderr, "Fehler: Terminal konnte nicht konfiguriert werden\n");
-        return 1;
+// TCP-Handshake bzw. UDP-Echo beantwortet
+void on_conn_reply(uint16_t seq, double rtt_ms) {
+    track_reply(seq, -1, rtt_ms);
+}
+
+// Port geschlossen: die Probe ist sofort verloren, die Meldung zählt mit
+void on_conn_refused(int seq) {
+    if (seq >= 0) seq_lost(&tracker, (uint16_t)seq);
+    snprintf(status_msg, sizeof(status_msg), "%s port %d: connection refused (%llu times)",
+             conn_kind_name(probe_kind), probe_port, (unsigned long long)conn.refused);
+    dirty = 1;
+}
+
+// Vom Tracker für jede abgelaufene Probe aufgerufen
+void on_probe_lost(SeqTracker *t, uint16_t seq) {
+    (void)t;
+    if (probe_kind) conn_abort(&conn, seq);
+    record_loss(seq);
+}
+
+// Timer auf den Ablauf der ältesten offenen Probe stellen
+void arm_expiry(void) {
+    int64_t deadline = seq_next_deadline(&tracker, probe_timeout_us);
+    if (deadline < 0) {
+        ev_timer_arm(expire_handler.fd, 0, 0);
+        return;
     }
+    int64_t wait_us = deadline - mono_us();
+    ev_timer_arm(expire_handler.fd, wait_us > 0 ? wait_us : 1, 0);
+}
 
-    // Regex kompilieren mit Fehlerprüfung
-    int regex_err = regcomp(&re_time, "time[=<]([0-9.]+)", REG_EXTENDED);
-    if (regex_err != 0) {
-        char regex_errbuf[100];
-        regerror(regex_err, &re_time, regex_errbuf, sizeof(regex_errbuf));
-        fprintf(stderr, "Regex Fehler: %s\n", regex_errbuf);
-        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
-        return 1;
+void on_expire_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    ev_timer_read(h->fd);
+    seq_expire(&tracker, mono_us(), probe_timeout_us);
+    arm_expiry();
+}
+
+// ========== SICHERES READ MIT FEHLERBEHANDLUNG ==========
+// Chunkweise in den Ringpuffer lesen, Zeilen direkt im Puffer auswerten
+void on_ping_readable(EvHandler *h, uint32_t events) {
+    (void)events;
+    long bytes_read;
+    uint64_t total = 0;
+    
+    while ((bytes_read = ping_reader_fill(&ping_reader, h->fd)) > 0) {
+        total += (uint64_t)bytes_read;
+        PingLine lines[64];
+        int count;
+        
+        do {
+            count = ping_reader_parse(&ping_reader, lines, 64);
+            
+            int64_t now_us = mono_us();
+            for (int i = 0; i < count; i++) {
+                if (lines[i].seq < 0) continue;
+                uint16_t seq = (uint16_t)lines[i].seq;
+                
+                // Sendezeitpunkt aus der Ausgabe rekonstruieren; Lücken in
+                // icmp_seq trägt der Tracker als offen nach
+                if (lines[i].kind == PING_LINE_TIMEOUT) {
+                    seq_sent(&tracker, seq, now_us - probe_interval_us);
+                    seq_lost(&tracker, seq);
+                    continue;
+                }
+                seq_sent(&tracker, seq, now_us - (int64_t)(lines[i].rtt_ms * 1000.0));
+                
+                SeqReplyKind kind = seq_reply(&tracker, seq);
+                if (kind == SEQ_REPLY_OK || kind == SEQ_REPLY_REORDERED) {
+                    record_reply(lines[i].seq, lines[i].ttl, lines[i].rtt_ms);
+                } else {
+                    metrics_invalidate(&metrics);
+                    dirty = 1;
+                }
+            }
+        } while (count == 64);
+        arm_expiry();
     }
+    self_backlog(total);
     
-    // ========== SICHERES PING-STARTEN ==========
-    int pipefd[2];
-    if (safe_start_ping(target, pipefd) == -1) {
-        fprintf(stderr, "Fehler: Ping konnte nicht gestartet werden\n");
-        regfree(&re_time);
-        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
-        return 1;
+    // EOF oder Fehler: Ping-Prozess ist wahrscheinlich beendet
+    if (bytes_read == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        ev_del(&loop, h);
+        timeout_state = 1;
+        dirty = 1;
     }
+}
+
+// Probe-Takt: Probe senden bzw. Ausfall des ping-Prozesses erkennen
+void on_tick(EvHandler *h, uint32_t events) {
+    (void)events;
+    uint64_t due = ev_timer_read(h->fd);
+    if (due == 0) return;
     
-    // Non-blocking setzen
-    fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+    int64_t now_us = mono_us();
+    myip_tick(&myip, now_us);
+    if (self_window(now_us) && debug_row) dirty = 1;
     
-    reset_stats();
-    time_t last_success_time = time(NULL);
-    int timeout_state = 0;
-    int running = 1;
-
-    char line[BUF_SIZE];
-    int line_len = 0;
+    // Nur Ansicht (--attach): keine eigenen Probes
+    if (attach_name) return;
+    
+    // Im Mehrzielbetrieb senden die Worker selbst
+    if (fleet.count) return;
+    
+    // Noch keine Adresse: nichts zu senden, nichts zu verlieren
+    resolve_tick(&resolver, now_us);
+    if (!probe_ready) return;
+    
+    if (probe_kind) {
+        // Jede Probe ein eigener Verbindungsaufbau bzw. ein Datagramm,
+        // beliebig viele gleichzeitig offen
+        if (due > conn.mask + 1) due = conn.mask + 1;
+        for (uint64_t i = 0; i < due; i++) {
+            int refused;
+            int seq = conn_send(&conn, now_us, &refused);
+            if (seq < 0) continue;
+            seq_sent(&tracker, (uint16_t)seq, now_us);
+            if (refused) on_conn_refused(seq);
+        }
+        arm_expiry();
+        return;
+    }
+    
+    if (native) {
+        // Verpasste Takte (Schnellmodus) in einem sendmmsg nachholen
+        if (due > ICMP_BATCH) due = ICMP_BATCH;
+        uint16_t seqs[ICMP_BATCH];
+        int sent = icmp_send_batch(&icmp, (int)due, now_us, seqs);
+        for (int i = 0; i < sent; i++) seq_sent(&tracker, seqs[i], now_us);
+        if (sent > 0) arm_expiry();
+        return;
+    }
+    
+    // Nur Anzeige: ping-Kindprozess meldet nichts mehr. Verluste zählt der
+    // Tracker über "no answer yet" (ping -O) bzw. die Lücken in icmp_seq
+    if (last_success_time > 0) {
+        time_t now = time(NULL);
+        int was_timeout = timeout_state;
+        if (now - last_success_time > 2) {
+            timeout_state = 1;
+        } else {
+            timeout_state = 0;
+        }
+        if (timeout_state != was_timeout) dirty = 1;
+    }
+}
 
-    // Terminal vorbereiten und Cursor unsichtbar machen
-    printf("%s%s%s", ANSI_HOME, ANSI_CLEAR, ANSI_CURSOR_HIDE);
-    fflush(stdout);
+// Zeile 2 der Einzelansicht: Name und aufgelöste Adresse bzw. Fehler
+void draw_target_line(void) {
+    scr_clear_row(2);
+    int col = scr_printf(2, 1, ANSI_WHITE, "Target: %s", target);
+    if (resolver.has_addr && strcmp(resolver.addr_str, target) != 0) {
+        col = scr_printf(2, col, ANSI_WHITE, " (%s)", resolver.addr_str);
+    } else if (!resolver.has_addr && !resolver.error) {
+        col = scr_put(2, col, ANSI_YELLOW, " (resolving...)");
+    }
+    if (resolver.error) {
+        col = scr_printf(2, col, ANSI_RED, " %s: %s", resolver.has_addr ? "re-resolve failed" : "cannot resolve",
+                         gai_strerror(resolver.error));
+    }
+    if (probe_kind) col = scr_printf(2, col, ANSI_WHITE, " | %s port %d", conn_kind_name(probe_kind), probe_port);
+    if (resolver.changes) {
+        scr_printf(2, col, ANSI_YELLOW, " | %llu address change%s", (unsigned long long)resolver.changes,
+                   resolver.changes == 1 ? "" : "s");
+    }
+}
 
+// Layout berechnen und statische Kopfzeilen in den Framebuffer legen
+void ui_init(void) {
     // Fußzeilen-Text (OHNE Version, nur Beschreibung)
-    char footer[] = "© zeroc 2026 | pingmon [warn] [crit] [target] | e.g., pingmon 50 100 1.1.1.1";
-    int footer_len = strlen(footer);
+    footer_len = strlen(footer);
 
     // Balkenlängen berechnen
     int labels_len = 21;
     int available_for_bars = footer_len - labels_len;
-    int bar_length = (available_for_bars > 0) ? available_for_bars / 2 : 5;
+    bar_length = (available_for_bars > 0) ? available_for_bars / 2 : 5;
     if (bar_length < 5) bar_length = 5;
     if (bar_length > 30) bar_length = 30;
 
     // Statische Kopfzeile zeichnen (MIT Version in der Kopfzeile)
-    CURSOR_POS(1, 1);
-    printf("%sPing Monitor v0.39%s%s", ANSI_BOLD ANSI_WHITE, ANSI_CLEAR_LINE, ANSI_RESET);
-    
-    CURSOR_POS(2, 1);
-    printf("%sTarget: %s%s%s", ANSI_WHITE, target, ANSI_CLEAR_LINE, ANSI_RESET);
+    int list = fleet.count && fleet_focus < 0 && !path_view;
+    // Vollbildansichten auf Terminalbreite: längere Zeilen würden umbrechen
+    if (list || path_view || heat_view) scr_init(term_rows, term_cols);
+    else scr_init(UI_ROWS, 0);
+    scr_put(1, 1, ANSI_BOLD ANSI_WHITE, "Ping Monitor v0.39");
+    if (path_view) {
+        char dst[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &path.dst.sin_addr, dst, sizeof(dst));
+        int col = scr_printf(2, 1, ANSI_WHITE, "Path to: %s", dst);
+        if (path_name[0]) col = scr_printf(2, col, ANSI_WHITE, " (%s)", path_name);
+        scr_printf(2, col, ANSI_WHITE, " | all hops every %.0f ms", path.interval_us / 1000.0);
+    } else if (list) {
+        int col = scr_printf(2, 1, ANSI_WHITE, "Targets: %zu from %s | %d workers | ",
+                             fleet.count, fleet_path, fleet.nworkers);
+        if (fleet.adaptive) {
+            col = scr_printf(2, col, ANSI_WHITE, "adaptive every %.0f/%.0f/%.0f ms",
+                             probe_interval_us / 1000.0 * FLEET_ADAPT_SLOW, probe_interval_us / 1000.0,
+                             probe_interval_us / 1000.0 / FLEET_ADAPT_FAST);
+        } else {
+            col = scr_printf(2, col, ANSI_WHITE, "every %.0f ms", probe_interval_us / 1000.0);
+        }
+        if (fleet.max_rate > 0) scr_printf(2, col, ANSI_WHITE, " | max %.0f/s", fleet.max_rate);
+    } else if (fleet_focus >= 0) {
+        scr_printf(2, 1, ANSI_WHITE, "Target: %s (%s)", target, fleet.targets[fleet_focus].name);
+    } else {
+        draw_target_line();
+    }
+    scr_printf(3, 1, ANSI_WHITE, "WARN %.0f ms | CRIT %.0f ms", warn, crit);
+    if (path_view) scr_put(4, 1, ANSI_WHITE, "Keys: q=quit  r=reset  m=myIP  p=back");
+    else if (list) scr_put(4, 1, ANSI_WHITE, "Keys: q=quit  r=reset  m=myIP  s=sort  j/k=select  Enter=details  p=path");
+    else if (heat_view) scr_put(4, 1, ANSI_WHITE, "Keys: q=quit  r=reset  m=myIP  x=export  p=path  g=back");
+    else if (fleet_focus >= 0) scr_put(4, 1, ANSI_WHITE, "Keys: q=quit  r=reset  m=myIP  h=history  g=heatmap  x=export  p=path  d=debug  b=back");
+    else if (attach_name) scr_printf(4, 1, ANSI_WHITE, "Keys: q=quit  m=myIP  h=history  d=debug | read-only view of %s", attach_name);
+    else scr_put(4, 1, ANSI_WHITE, "Keys: q=quit  r=reset  m=myIP  h=history  g=heatmap  x=export  p=path  d=debug");
+
+    // Trennlinie
+    scr_fill(5, 1, footer_len, ANSI_WHITE, "-");
+}
+
+
+// ========== MEHRZIELBETRIEB: EINZELANSICHT ==========
+
+// Bildschirm komplett neu aufbauen (Wechsel Rangliste <-> Einzelansicht)
+void ui_switch(void) {
+    printf("%s%s", ANSI_HOME, ANSI_CLEAR);
+    fflush(stdout);
+    ui_init();
+    dirty = 1;
+}
+
+// Samples des gewählten Ziels laufen durch dieselben Statistiken wie im Einzelbetrieb
+void on_fleet_sample(const FleetSample *s) {
+    if (headless) {
+        if (s->kind == FLEET_REPLY || s->kind == FLEET_REORDERED) {
+            emit_probe(&emitter, s->target, s->ts_ms, s->seq, s->ttl, s->rtt_us);
+        } else if (s->kind == FLEET_LOST) {
+            emit_probe(&emitter, s->target, s->ts_ms, s->seq, -1, 0);
+        }
+        return;
+    }
+    if ((int)s->target != fleet_focus) return;
     
-    CURSOR_POS(3, 1);
-    printf("%sWARN %.0f ms | CRIT %.0f ms%s%s", ANSI_WHITE, warn, crit, ANSI_CLEAR_LINE, ANSI_RESET);
+    if (s->kind == FLEET_REPLY || s->kind == FLEET_REORDERED) {
+        account_sample(s->ts_ms, s->rtt_us / 1000.0);
+        last_success_time = time(NULL);
+        timeout_state = 0;
+        self_reply();
+    } else if (s->kind == FLEET_LOST) {
+        account_sample(s->ts_ms, 0);
+        timeout_state = 1;
+    }
+}
+
+// Einzelansicht für ein Ziel der Liste öffnen: Zähler, Histogramm und der
+// kurze Verlauf kommen aus der Rangliste, alles Weitere aus neuen Samples
+void fleet_enter(uint32_t id) {
+    const FleetTarget *t = &fleet.targets[id];
     
-    CURSOR_POS(4, 1);
-    printf("%sKeys: q=quit  r=reset  m=myIP%s%s", ANSI_WHITE, ANSI_CLEAR_LINE, ANSI_RESET);
+    reset_stats();
+    fleet_focus = (int)id;
+    inet_ntop(AF_INET, &t->addr.sin_addr, target, sizeof(target));
+    packets_sent = (int)t->sent;
+    packets_recv = (int)t->recv;
+    sum = t->sum;
+    last = t->last;
+    lat_stats = t->lat;
     
-    // Trennlinie
-    CURSOR_POS(5, 1);
-    printf("%s", ANSI_WHITE);
-    for (int i = 0; i < footer_len; i++) printf("-");
-    printf("%s%s", ANSI_CLEAR_LINE, ANSI_RESET);
+    // Zeitstempel rückwärts im aktuellen Sendeabstand des Ziels (adaptiv
+    // bzw. interval= aus der Zielliste), sonst im globalen
+    int64_t every_us = t->every_us ? t->every_us : t->interval_us > 0 ? t->interval_us : fleet.interval_us;
+    int64_t now_ms = wall_ms();
+    for (int age = FLEET_HIST - 1; age >= 0; age--) {
+        double v = fleet_hist_at(t, (uint32_t)age);
+        if (v >= 0) add_to_history_at(now_ms - age * every_us / 1000, v);
+    }
+    timeout_state = fleet_hist_at(t, 0) == 0;
+    last_success_time = time(NULL);
+    status_msg[0] = '\0';
+    ui_switch();
+}
+
+void fleet_leave(void) {
+    fleet_focus = -1;
+    heat_view = 0;
+    history_tier = TIER_RAW;
+    status_msg[0] = '\0';
+    ui_switch();
+}
+
+// ========== PFADANSICHT ==========
+
+// Pfad zu addr anzeigen; die bisherige Ansicht bleibt darunter erhalten
+void path_enter(const struct in_addr *addr, const char *name) {
+    int64_t interval_us = probe_interval_us < PATH_MIN_INTERVAL_US ? PATH_MIN_INTERVAL_US : probe_interval_us;
     
-    fflush(stdout);
+    path.on_update = request_redraw;
+    if (path_start(&path, &loop, addr, interval_us, probe_timeout_us) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Path view failed: %s", strerror(errno));
+        return;
+    }
+    snprintf(path_name, sizeof(path_name), "%s", name ? name : "");
+    path_view = 1;
+    status_msg[0] = '\0';
+    ui_switch();
+}
 
-    #define VALUE_WIDTH 8
+// Pfadansicht für das (aufgelöste) Einzelziel; nur IPv4
+void path_enter_target(void) {
+    if (!resolver.has_addr) {
+        snprintf(status_msg, sizeof(status_msg), "Path view: target not resolved yet");
+    } else if (resolver.addr.sa.sa_family != AF_INET) {
+        snprintf(status_msg, sizeof(status_msg), "Path view: IPv4 targets only");
+    } else {
+        path_enter(&resolver.addr.in.sin_addr, strcmp(target, resolver.addr_str) != 0 ? target : NULL);
+    }
+}
 
-    while (running) {
-        char c;
-        ssize_t bytes_read;
+void path_leave(void) {
+    path_stop(&path);
+    path_view = 0;
+    status_msg[0] = '\0';
+    ui_switch();
+}
+
+void toggle_ip_info(void) {
+    show_ip_info = !show_ip_info;
+    if (show_ip_info) myip_start(&myip, mono_us());
+}
+
+// Taste in der Pfadansicht
+void path_key(char ch) {
+    if (ch == 'p' || ch == 'b') path_leave();
+    else if (ch == 'r') path_reset(&path);
+    else if (ch == 'm') toggle_ip_info();
+}
+
+// Taste in der Rangliste. Rückgabe: 1 = verarbeitet
+int fleet_list_key(char ch) {
+    if (ch == 's') {
+        fleet_set_rank(&fleet, (fleet.rank_key + 1) % FLEET_RANK_KEYS);
+        snprintf(status_msg, sizeof(status_msg), "Worst %s first", fleet_rank_name(fleet.rank_key));
+    } else if (ch == 'j') {
+        if (fleet_sel + 1 < fleet_nshown) fleet_sel++;
+    } else if (ch == 'k') {
+        if (fleet_sel > 0) fleet_sel--;
+    } else if (ch == '\r' || ch == '\n') {
+        if (fleet_sel < fleet_nshown) fleet_enter(fleet_shown[fleet_sel]);
+    } else if (ch == 'r') {
+        fleet_reset(&fleet);
+    } else if (ch == 'p') {
+        if (fleet_sel < fleet_nshown) {
+            const FleetTarget *t = &fleet.targets[fleet_shown[fleet_sel]];
+            path_enter(&t->addr.sin_addr, t->name);
+        }
+    } else if (ch == 'h' || ch == 'x') {
+        snprintf(status_msg, sizeof(status_msg), "Press Enter on a target for history and export");
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// ========== EIGENMESSUNG: ANZEIGE UND DUMP ==========
+
+// Zeile 15 der Einzelansicht (Taste d)
+void draw_debug_row(void) {
+    const ScreenStats *st = scr_stats();
+    int col = scr_printf(15, 1, ANSI_CYAN, "Debug: %.0f loops/s, %.1f sys/loop | frame %zu B, %.0f us",
+                         self.loops_per_s, self.syscalls_per_loop, st->bytes_last, self.render_last_ns / 1e3);
+    if (!native && !probe_kind && !fleet.count && ping_reader.lines) {
+        col = scr_printf(15, col, ANSI_CYAN, " | parse %.0f ns/line",
+                         (double)ping_reader.parse_ns / (double)ping_reader.lines);
+    }
+    col = scr_printf(15, col, ANSI_CYAN, " | backlog %llu/%llu%s",
+                     (unsigned long long)self.backlog_last, (unsigned long long)self.backlog_max,
+                     native || probe_kind || fleet.count ? "" : " B");
+    scr_printf(15, col, ANSI_CYAN, " | lag %.1f/%.1f ms", self.lag_last_us / 1e3, self.lag_max_us / 1e3);
+}
+
+// SIGUSR1: alle Zähler auf einmal nach stderr bzw. --dump
+void self_dump(void) {
+    char buf[8192];
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    double secs = (mono_us() - start_us) / 1e6;
+    const ScreenStats *st = scr_stats();
+    uint64_t sys = self_syscalls();
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == -1) memset(&ru, 0, sizeof(ru));
+    
+    int len = snprintf(buf, sizeof(buf),
+        "pingmon %04d-%02d-%02d %02d:%02d:%02d pid %d, up %.1f s, target %s\n"
+        "  loop: %llu iterations (%.0f/s), %llu events, %llu syscalls counted (%.2f/loop, %.2f now)\n"
+        "  render: %llu frames, %.0f ns/frame avg, %.0f ns last, %zu bytes last, %zu bytes first, %.0f bytes/frame avg after that\n"
+        "  parse: %llu lines, %llu bytes in %llu reads, %.0f ns/line\n"
+        "  backlog per wakeup: %llu last, %llu max (%s)\n"
+        "  display lag: %.2f ms avg, %.2f ms last, %.2f ms max over %llu frames\n"
+        "  probes: %llu sent, %llu received, %llu lost, %llu dup, %llu late\n"
+        "  cpu: %.2f s user, %.2f s system, max rss %ld KiB\n",
+        tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+        (int)getpid(), secs, fleet.count ? fleet_path : target,
+        (unsigned long long)loop.wakeups, secs > 0 ? loop.wakeups / secs : 0.0,
+        (unsigned long long)loop.events, (unsigned long long)sys,
+        loop.wakeups ? (double)sys / (double)loop.wakeups : 0.0, self.syscalls_per_loop,
+        (unsigned long long)self.renders, self.renders ? (double)self.render_ns / (double)self.renders : 0.0,
+        (double)self.render_last_ns, st->bytes_last, st->bytes_first,
+        st->frames > 1 ? (double)(st->bytes_total - st->bytes_first) / (double)(st->frames - 1) : 0.0,
+        (unsigned long long)ping_reader.lines, (unsigned long long)ping_reader.bytes,
+        (unsigned long long)ping_reader.reads,
+        ping_reader.lines ? (double)ping_reader.parse_ns / (double)ping_reader.lines : 0.0,
+        (unsigned long long)self.backlog_last, (unsigned long long)self.backlog_max,
+        native || probe_kind || fleet.count ? "replies" : "bytes from ping",
+        self.lags ? self.lag_sum_us / 1e3 / (double)self.lags : 0.0, self.lag_last_us / 1e3,
+        self.lag_max_us / 1e3, (unsigned long long)self.lags,
+        (unsigned long long)tracker.sent, (unsigned long long)tracker.received,
+        (unsigned long long)tracker.lost, (unsigned long long)tracker.dup, (unsigned long long)tracker.late,
+        ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6, ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6,
+        ru.ru_maxrss);
+    // Probe-Rate und Zeitstempel-Fehlerbudget (Userspace gegen Kernel)
+    if (native && len < (int)sizeof(buf)) {
+        const IcmpTsStats *ts = &icmp.ts;
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  icmp: %.0f probes/s, %llu sendmmsg (%.1f probes each), %llu recvmmsg (%.1f replies each)\n"
+                        "  timestamps: %s, %llu kernel / %llu user RTTs, user-space error tx avg %.1f us max %.1f us, "
+                        "rx avg %.1f us max %.1f us\n",
+                        secs > 0 ? tracker.sent / secs : 0.0,
+                        (unsigned long long)icmp.send_calls,
+                        icmp.send_calls ? (double)tracker.sent / icmp.send_calls : 0.0,
+                        (unsigned long long)icmp.recv_calls,
+                        icmp.recv_calls ? (double)tracker.received / icmp.recv_calls : 0.0,
+                        icmp.ts_mode == ICMP_TS_RX_TX ? "kernel tx+rx" :
+                        icmp.ts_mode == ICMP_TS_RX ? "kernel rx" : "user",
+                        (unsigned long long)ts->kernel_rtts, (unsigned long long)ts->user_rtts,
+                        ts->tx_count ? ts->tx_sum_ns / 1e3 / ts->tx_count : 0.0, ts->tx_max_ns / 1e3,
+                        ts->rx_count ? ts->rx_sum_ns / 1e3 / ts->rx_count : 0.0, ts->rx_max_ns / 1e3);
+    }
+    if (probe_kind && len < (int)sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  %s: port %d, %u slots, %llu sent, %llu refused, %llu send errors, %llu aborted, %llu kernel RTTs\n",
+                        conn_kind_name(probe_kind), probe_port, conn.mask + 1,
+                        (unsigned long long)conn.sent, (unsigned long long)conn.refused,
+                        (unsigned long long)conn.errors, (unsigned long long)conn.aborted,
+                        (unsigned long long)conn.kernel_rtts);
+    }
+    // Adresswechsel des Einzelziels (Statistik jeweils neu begonnen)
+    if (resolver.lookups && len < (int)sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  resolve: %llu lookups, %llu address changes, current %s\n",
+                        (unsigned long long)resolver.lookups, (unsigned long long)resolver.changes,
+                        resolver.addr_str[0] ? resolver.addr_str : "-");
+    }
+    // Zuletzt angezeigter Pfad, ein Hop pro Zeile
+    if (path.probes > 0 && len < (int)sizeof(buf)) {
+        char dst[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &path.dst.sin_addr, dst, sizeof(dst));
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len, "  path: to %s, %d hops%s, %u rounds\n",
+                        dst, path_hops(&path), path.dest_ttl ? "" : " (destination not reached)", path.round);
+        for (int i = 0; i < path_hops(&path) && len < (int)sizeof(buf); i++) {
+            const PathHop *h = &path.hops[i];
+            char addr[INET_ADDRSTRLEN] = "???";
+            if (h->addr.s_addr) inet_ntop(AF_INET, &h->addr, addr, sizeof(addr));
+            len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                            "    %2d. %-15s loss %5.1f%%  avg %.2f ms  best %.2f ms  worst %.2f ms\n",
+                            i + 1, addr, path_loss(h), h->recv ? h->sum / (double)h->recv : 0.0,
+                            h->recv ? h->lat.min : 0.0, h->recv ? h->lat.max : 0.0);
+        }
+    }
+    if (fleet.count && len < (int)sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  fleet: %zu targets, %d workers, %llu sent, %llu received, %llu samples (%.0f/s), %llu dropped, %llu skipped\n",
+                        fleet.count, fleet.nworkers, (unsigned long long)fleet.sent, (unsigned long long)fleet.recv,
+                        (unsigned long long)fleet.samples, secs > 0 ? fleet.samples / secs : 0.0,
+                        (unsigned long long)fleet_dropped(&fleet), (unsigned long long)fleet_skipped(&fleet));
+    }
+    if (headless && len < (int)sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  output: %llu records, %llu bytes in %llu writes, %zu buffered, %llu dropped\n",
+                        (unsigned long long)emitter.records, (unsigned long long)emitter.bytes,
+                        (unsigned long long)emitter.writes, emitter.len, (unsigned long long)emitter.dropped);
+    }
+    if (shm.seg && len < (int)sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        "  shm: %s %s, %llu publishes, %llu read retries\n",
+                        attach_name ? "attached to" : "publishing", shm.name,
+                        (unsigned long long)__atomic_load_n(&shm.seg->publishes, __ATOMIC_RELAXED),
+                        (unsigned long long)shm.retries);
+    }
+    if (len >= (int)sizeof(buf)) len = (int)sizeof(buf) - 1;
+    
+    int fd = dump_path ? open(dump_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644) : STDERR_FILENO;
+    if (fd < 0) {
+        snprintf(status_msg, sizeof(status_msg), "Stats dump to %s failed: %s", dump_path, strerror(errno));
+        dirty = 1;
+        return;
+    }
+    for (int off = 0; off < len; ) {
+        ssize_t n = write(fd, buf + off, (size_t)(len - off));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        off += (int)n;
+    }
+    if (dump_path) {
+        close(fd);
+        snprintf(status_msg, sizeof(status_msg), "Stats dumped to %s", dump_path);
+        dirty = 1;
+    } else if (!headless && isatty(STDERR_FILENO)) {
+        // Der Dump steht im Bild: komplett neu aufbauen
+        ui_switch();
+    }
+}
+
+// ========== VERÖFFENTLICHUNG IN /dev/shm ==========
+
+// Momentaufnahme direkt ins Segment schreiben; Leser warten nie auf uns
+void publish(void) {
+    ShmSnapshot *s = shm_publish_begin(&shm);
+    double loss = packets_sent > 0 ? (packets_sent - packets_recv) * 100.0 / packets_sent : 0.0;
+    s->updated_ms = wall_ms();
+    snprintf(s->target, sizeof(s->target), "%s", target);
+    snprintf(s->addr, sizeof(s->addr), "%s", resolver.has_addr ? resolver.addr_str : "");
+    snprintf(s->status_msg, sizeof(s->status_msg), "%s", status_msg);
+    s->resolve_error = resolver.error;
+    s->timeout_state = timeout_state;
+    s->probe_kind = probe_kind;
+    s->probe_port = probe_port;
+    s->interval_us = probe_interval_us;
+    s->warn = warn;
+    s->crit = crit;
+    s->sent = (uint64_t)packets_sent;
+    s->recv = (uint64_t)packets_recv;
+    s->dup = tracker.dup;
+    s->reordered = tracker.reordered;
+    s->late = tracker.late;
+    s->last_ms = last;
+    s->sum_ms = sum;
+    s->quality = calculate_quality(last);
+    s->stability = calculate_stability(loss);
+    s->lat = lat_stats;
+    for (int t = 0; t < ROLLUP_TIERS; t++) {
+        const RollupBucket *b;
+        int n = 0;
+        while (n < SHM_HIST && (b = rollup_at(&rollups, t, n)) != NULL) s->hist[t][n++] = *b;
+        s->hist_len[t] = n;
+    }
+    shm_publish_end(&shm);
+}
+
+// Wie maybe_render: nur nach Änderungen und höchstens alle PUBLISH_MIN_US
+void maybe_publish(void) {
+    if (!shm.writer || !publish_dirty || publish_armed) return;
+    
+    int64_t now_us = mono_us();
+    int64_t wait_us = last_publish_us + PUBLISH_MIN_US - now_us;
+    if (wait_us > 0) {
+        ev_timer_arm(publish_handler.fd, wait_us, 0);
+        publish_armed = 1;
+        return;
+    }
+    publish();
+    publish_dirty = 0;
+    last_publish_us = now_us;
+}
+
+// Kopie des Schreibers in die Anzeige übernehmen
+void attach_apply(const ShmSnapshot *s) {
+    int relayout = strcmp(target, s->target) != 0 || warn != s->warn || crit != s->crit;
+    snprintf(target, sizeof(target), "%s", s->target);
+    warn = s->warn;
+    crit = s->crit;
+    if (probe_interval_us != s->interval_us) {
+        probe_interval_us = s->interval_us;
+        rollup_init(&rollups, probe_interval_us < RENDER_MIN_US ? RENDER_MIN_US : 0);
+    }
+    
+    // Kopfzeile 2 nur bei Änderung neu
+    int has_addr = s->addr[0] != '\0';
+    if (has_addr != resolver.has_addr || strcmp(resolver.addr_str, s->addr) != 0 ||
+        resolver.error != s->resolve_error || (int)probe_kind != s->probe_kind || probe_port != s->probe_port) {
+        resolver.has_addr = has_addr;
+        snprintf(resolver.addr_str, sizeof(resolver.addr_str), "%s", s->addr);
+        resolver.error = s->resolve_error;
+        probe_kind = (ConnKind)s->probe_kind;
+        probe_port = s->probe_port;
+        if (!relayout) draw_target_line();
+    }
+    
+    snprintf(status_msg, sizeof(status_msg), "%s", s->status_msg);
+    timeout_state = s->timeout_state;
+    packets_sent = (int)s->sent;
+    packets_recv = (int)s->recv;
+    tracker.dup = s->dup;
+    tracker.reordered = s->reordered;
+    tracker.late = s->late;
+    last = s->last_ms;
+    sum = s->sum_ms;
+    lat_stats = s->lat;
+    for (int t = 0; t < ROLLUP_TIERS; t++) rollup_restore(&rollups, t, s->hist[t], s->hist_len[t]);
+    
+    if (relayout) ui_switch();
+    dirty = 1;
+}
+
+// Schreiber beendet? Ein neu gestarteter legt das Segment neu an, dann
+// dorthin wechseln
+void attach_check(void) {
+    if (shm_writer_alive(&shm)) {
+        // Neu gestartet und hat das alte Segment übernommen
+        if (attach_gone) {
+            attach_gone = 0;
+            attach_seen = UINT64_MAX;
+        }
+        return;
+    }
+    
+    ShmStats next;
+    if (shm_attach(&next, attach_name) == 0 && shm_writer_alive(&next)) {
+        shm_close(&shm);
+        shm = next;
+        attach_seen = UINT64_MAX;
+        attach_gone = 0;
+        return;
+    }
+    shm_close(&next);
+    if (!attach_gone) {
+        attach_gone = 1;
+        timeout_state = 1;
+        snprintf(status_msg, sizeof(status_msg), "Publisher has exited, showing its last values");
+        dirty = 1;
+    }
+}
+
+// Abfragetakt der Ansicht: neue Veröffentlichung übernehmen
+void attach_poll(void) {
+    static ShmSnapshot snap;         // ~7 KB, nicht auf den Stack
+    uint64_t publishes;
+    attach_check();
+    if (attach_gone) return;
+    if (shm_read(&shm, &snap, &publishes) == -1) return;    // Schreiber mittendrin, nächster Takt
+    if (publishes == attach_seen) return;
+    attach_seen = publishes;
+    attach_apply(&snap);
+}
+
+void on_publish_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    ev_timer_read(h->fd);
+    if (attach_name) attach_poll();
+    else publish_armed = 0;
+}
+
+// ========== ZIELADRESSE ==========
+
+// Laufende Probes beenden (Adresswechsel, Programmende)
+void probe_close(void) {
+    probe_ready = 0;
+    if (probe_kind) {
+        conn_close(&conn);
+        return;
+    }
+    if (probe_handler.fd < 0) return;
+    ev_del(&loop, &probe_handler);
+    if (native) {
+        icmp_close(&icmp);
+    } else {
+        if (ping_pid > 0) {
+            kill(ping_pid, SIGTERM);
+            waitpid(ping_pid, NULL, 0);
+            ping_pid = -1;
+        }
+        close(probe_handler.fd);
+    }
+    probe_handler.fd = -1;
+}
+
+// Probes an addr: TCP/UDP, sonst bevorzugt native ICMP-Engine, sonst
+// System-ping als Kindprozess. 0 = OK, -1 = Fehler
+int probe_open(const char *addr) {
+    probe_close();
+    if (probe_kind) {
+        // Bis zum Timeout offene Probes; mehr als sein Fenster hält der Tracker nicht
+        int64_t slots = (probe_timeout_us + probe_interval_us - 1) / probe_interval_us + CONN_SLOTS_SLACK;
+        if (slots > SEQ_WINDOW) slots = SEQ_WINDOW;
+        if (conn_open(&conn, &loop, probe_kind, &resolver.addr, (uint16_t)probe_port, (uint32_t)slots) == -1) return -1;
+        probe_ready = 1;
+        return 0;
+    }
+    if ((native = (icmp_open(&icmp, addr) == 0))) {
+        probe_handler.fd = icmp.fd;
+        probe_handler.cb = on_icmp_readable;
+    } else {
+        int pipefd[2];
+        if (safe_start_ping(addr, pipefd) == -1) return -1;
         
-        // ========== SICHERES READ MIT FEHLERBEHANDLUNG ==========
-        while ((bytes_read = read(pipefd[0], &c, 1)) > 0) {
-            if (c == '\n') {
-                line[line_len] = '\0';
-                
-                regmatch_t m[2];
-                
-                if (regexec(&re_time, line, 2, m, 0) == 0) {
-                    packets_sent++;
-                    packets_recv++;
-                    
-                    char tmp[16];
-                    int len = m[1].rm_eo - m[1].rm_so;
-                    if (len < (int)sizeof(tmp)) {
-                        strncpy(tmp, line + m[1].rm_so, len);
-                        tmp[len] = '\0';
-
-                        last = atof(tmp);
-                        sum += last;
-                        last_ping_time = time(NULL);
-                        last_success_time = last_ping_time;
-                        timeout_state = 0;
-                        
-                        add_to_history(last);
-                    }
-                }
-                
-                line_len = 0;
-            } else if (line_len < BUF_SIZE - 2) {
-                line[line_len++] = c;
-            } else {
-                // Puffer voll, zurücksetzen
-                line_len = 0;
-            }
+        // Non-blocking setzen
+        fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+        ping_reader_init(&ping_reader);
+        probe_handler.fd = pipefd[0];
+        probe_handler.cb = on_ping_readable;
+    }
+    if (ev_add(&loop, &probe_handler, EPOLLIN) == -1) return -1;
+    probe_ready = 1;
+    return 0;
+}
+
+// Erste Adresse oder Adresswechsel: bisherige Zahlen als Meldung festhalten,
+// dann neu beginnen (im Log als Reset markiert)
+void on_target_address(const char *old_addr, const char *new_addr) {
+    if (old_addr) {
+        double loss = packets_sent > 0 ? (packets_sent - packets_recv) * 100.0 / packets_sent : 0.0;
+        time_t now = time(NULL);
+        struct tm tm;
+        localtime_r(&now, &tm);
+        snprintf(status_msg, sizeof(status_msg), "%02d:%02d:%02d %s -> %s, stats split (before: %d sent, %.1f%% loss, avg %.1f ms)",
+                 tm.tm_hour, tm.tm_min, tm.tm_sec, old_addr, new_addr, packets_sent, loss,
+                 packets_recv > 0 ? sum / packets_recv : 0.0);
+        reset_stats();
+        if (sample_log.map) slog_append_reset(&sample_log, wall_ms());
+        last_success_time = time(NULL);
+        timeout_state = 0;
+    }
+    if (headless) emit_address(&emitter, 0, wall_ms(), new_addr);
+    if (probe_open(new_addr) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Cannot probe %s: %s", new_addr, strerror(errno));
+    }
+    if (path_pending) {
+        path_pending = 0;
+        path_enter_target();
+    }
+}
+
+// Nach jeder Auflösung: Kopfzeile auffrischen
+void on_target_resolved(void) {
+    if (fleet_focus < 0 && !path_view) draw_target_line();
+    dirty = 1;
+}
+
+// Tastatureingabe
+void on_stdin(EvHandler *h, uint32_t events) {
+    (void)events;
+    char keys[32];
+    ssize_t n = read(h->fd, keys, sizeof(keys));
+    
+    if (n <= 0) {
+        if (n == 0 || (errno != EAGAIN && errno != EINTR)) ev_del(&loop, h);
+        return;
+    }
+    
+    for (ssize_t i = 0; i < n; i++) {
+        char ch = keys[i];
+        
+        // Pfeiltasten (ESC [ A/B) wie k/j, ESC allein wie b
+        if (ch == '\033' && i + 2 < n && keys[i + 1] == '[') {
+            ch = keys[i + 2] == 'A' ? 'k' : keys[i + 2] == 'B' ? 'j' : 0;
+            i += 2;
+        } else if (ch == '\033' || ch == 0x7f) {
+            ch = 'b';
         }
         
-        // Fehlerbehandlung für read
-        if (bytes_read == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            // Ping-Prozess ist wahrscheinlich beendet
-            timeout_state = 1;
+        if (ch == 'q') running = 0;
+        // Nur Ansicht: nichts zurückzusetzen, zu exportieren oder zu proben
+        if (attach_name && (ch == 'r' || ch == 'x' || ch == 'p')) continue;
+        if (path_view) {
+            path_key(ch);
+            continue;
         }
-
-        // Timeout-Erkennung
-        if (last_success_time > 0) {
-            time_t now = time(NULL);
-            if (now - last_success_time > 2) {
-                if (packets_sent == packets_recv) {
-                    packets_sent++;
-                }
-                timeout_state = 1;
+        if (fleet.count && fleet_focus < 0) {
+            fleet_list_key(ch);
+            continue;
+        }
+        if ((ch == 'g' || ch == 'b') && heat_view) {
+            heat_view = 0;
+            ui_switch();
+            continue;
+        }
+        if (ch == 'g') {
+            // Ansicht nur aus eigenen Samples; --attach bekommt keine
+            if (attach_name) {
+                snprintf(status_msg, sizeof(status_msg), "Heatmap needs local probes, not available with --attach");
             } else {
-                timeout_state = 0;
+                heat_view = 1;
+                ui_switch();
             }
+            continue;
         }
-
-        // Tastatureingabe
-        struct timeval tv = {0, 0};
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(STDIN_FILENO, &fds);
-        
-        if (select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0) {
-            char ch = getchar();
-            if (ch == 'q') running = 0;
-            if (ch == 'r') {
-                reset_stats();
-                last_success_time = time(NULL);
-                timeout_state = 0;
+        if (ch == 'b' && fleet_focus >= 0) {
+            fleet_leave();
+            continue;
+        }
+        if (ch == 'p') {
+            if (fleet_focus >= 0) {
+                path_enter(&fleet.targets[fleet_focus].addr.sin_addr, fleet.targets[fleet_focus].name);
+            } else {
+                path_enter_target();
             }
-            if (ch == 'm') {
-                if (!my_ip.fetched) {
-                    fetch_ip_info(&my_ip);
-                }
-                show_ip_info = !show_ip_info;
+            continue;
+        }
+        if (ch == 'r' && fleet_focus >= 0) fleet_reset(&fleet);
+        if (ch == 'r') {
+            reset_stats();
+            if (sample_log.map) slog_append_reset(&sample_log, wall_ms());
+            last_success_time = time(NULL);
+            timeout_state = 0;
+        }
+        if (ch == 'h') {
+            history_tier = (history_tier + 1) % ROLLUP_TIERS;
+        }
+        if (ch == 'x') {
+            // Exportiert wird, was die gewählte History-Stufe überblickt:
+            // roh alles, sonst deren Spanne (1 h, 8 h, 3 Tage)
+            const RollupTier *tier = &rollups.tiers[history_tier];
+            int64_t span_us = history_tier == TIER_RAW ? 0 : tier->width_us * tier->cap;
+            char range[24] = "all";
+            if (span_us) snprintf(range, sizeof(range), "last %lld h", (long long)(span_us / 3600000000LL));
+            char path[128];
+            int count = export_series(target, span_us ? wall_ms() - span_us / 1000 : INT64_MIN, path, sizeof(path));
+            if (count < 0) {
+                snprintf(status_msg, sizeof(status_msg), "Export failed: %s", strerror(errno));
+            } else {
+                // Pfad wie status_msg 128 Bytes: gekürzt, damit die Zahlen stehen bleiben
+                size_t bytes = series_bytes(&series);
+                snprintf(status_msg, sizeof(status_msg), "Exported %d samples (%s) to %.64s (%.2f B/sample in memory)",
+                         count, range, path, series.samples ? (double)bytes / (double)series.samples : 0.0);
             }
         }
+        if (ch == 'm') toggle_ip_info();
+        if (ch == 'd') debug_row = !debug_row;
+    }
+    dirty = 1;
+}
 
-        // Zeile 6: MyIP-Info
-        CURSOR_POS(6, 1);
-        if (show_ip_info && my_ip.fetched) {
-            printf("%sMyIP: ", ANSI_BOLD ANSI_WHITE);
-            printf("%s%s", ANSI_MAGENTA, my_ip.ip);
-            printf("%s | ISP: ", ANSI_BOLD ANSI_WHITE);
-            printf("%s%s", ANSI_MAGENTA, my_ip.isp);
-            printf("%s | Location: ", ANSI_BOLD ANSI_WHITE);
-            printf("%s%s%s%s", ANSI_MAGENTA, my_ip.location, ANSI_CLEAR_LINE, ANSI_RESET);
+// SIGINT/SIGTERM beenden die Schleife regulär, SIGCHLD meldet Ende von ping,
+// SIGUSR1 schreibt die Eigenmessung
+void on_signal(EvHandler *h, uint32_t events) {
+    (void)events;
+    struct signalfd_siginfo si;
+    
+    while (read(h->fd, &si, sizeof(si)) == sizeof(si)) {
+        if (si.ssi_signo == SIGCHLD) {
+            // SIGCHLD wird zusammengefasst: alle beendeten Kinder einsammeln
+            int status;
+            pid_t pid;
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                if (pid == ping_pid) {
+                    ping_pid = -1;
+                    // Ohne eine Zeile mit Fehler beendet: busybox- oder
+                    // inetutils-ping kennt -O nicht. Einmal ohne starten;
+                    // Verluste zeigen dann die Lücken in icmp_seq
+                    if (ping_opt_O && ping_reader.lines == 0 && WIFEXITED(status) &&
+                        WEXITSTATUS(status) != 0 && WEXITSTATUS(status) != 127) {
+                        ping_opt_O = 0;
+                        if (probe_open(resolver.addr_str) == 0) continue;
+                    }
+                    timeout_state = 1;
+                    dirty = 1;
+                } else {
+                    myip_reap(&myip, pid);
+                }
+            }
+        } else if (si.ssi_signo == SIGUSR1) {
+            self_dump();
         } else {
-            printf("%s", ANSI_CLEAR_LINE);
+            running = 0;
         }
+    }
+}
+
+void on_render_timer(EvHandler *h, uint32_t events) {
+    (void)events;
+    ev_timer_read(h->fd);
+    render_armed = 0;
+}
+
+// Mehrzielbetrieb: Summenzeile und die schlechtesten Ziele nach fleet.rank_key
+void draw_fleet(void) {
+    uint64_t dropped = fleet_dropped(&fleet);
+    
+    // Zeile 7: Summen über alle Ziele
+    scr_clear_row(7);
+    int col = scr_put(7, 1, ANSI_BOLD ANSI_WHITE, "Sent/Recv: ");
+    col = scr_printf(7, col, ANSI_WHITE, "%llu/%llu", (unsigned long long)fleet.sent, (unsigned long long)fleet.recv);
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Loss: ");
+    double loss = fleet.sent > 0 ? (double)(fleet.sent - fleet.recv) * 100.0 / (double)fleet.sent : 0.0;
+    col = scr_printf(7, col, loss > 0 ? ANSI_YELLOW : ANSI_GREEN, "%.2f %%", loss);
+    // Geplante Rate der Worker; im adaptiven Modus wechselt sie mit dem Zustand der Ziele
+    double rate = fleet_rate(&fleet);
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Rate: ");
+    col = scr_printf(7, col, fleet.max_rate > 0 && rate >= fleet.max_rate * 0.99 ? ANSI_YELLOW : ANSI_WHITE,
+                     "%.0f/s", rate);
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Dropped: ");
+    col = scr_printf(7, col, dropped ? ANSI_RED : ANSI_WHITE, "%llu", (unsigned long long)dropped);
+    if (fleet.max_rate > 0) {
+        uint64_t skipped = fleet_skipped(&fleet);
+        col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Skipped: ");
+        scr_printf(7, col, skipped ? ANSI_YELLOW : ANSI_WHITE, "%llu", (unsigned long long)skipped);
+    }
+    
+    // Zeile 8: Meldung
+    scr_clear_row(8);
+    if (status_msg[0]) scr_put(8, 1, ANSI_CYAN, status_msg);
+    
+    // Name und Verlauf teilen sich, was neben den festen Spalten bleibt;
+    // der Name zuerst bis FLEET_NAME_W_MIN
+    int avail = term_cols - FLEET_FIXED_W;
+    int name_w = avail - HIST_SIZE / 2;
+    if (name_w > FLEET_NAME_W_MAX) name_w = FLEET_NAME_W_MAX;
+    if (name_w < FLEET_NAME_W_MIN) name_w = FLEET_NAME_W_MIN;
+    int hist_w = avail - name_w;
+    if (hist_w > FLEET_HIST) hist_w = FLEET_HIST;
+    
+    // Zeile 9: Spaltenköpfe, Sortierspalte markiert
+    static const char *heads[FLEET_RANK_KEYS] = { "Last", "Avg", "P99", "Loss", "Stability" };
+    scr_clear_row(9);
+    col = scr_printf(9, 3, ANSI_BOLD ANSI_WHITE, "%-*s", name_w, "Target");
+    for (int k = 0; k < FLEET_RANK_KEYS; k++) {
+        const char *color = k == (int)fleet.rank_key ? ANSI_BOLD ANSI_CYAN : ANSI_BOLD ANSI_WHITE;
+        if (k == FLEET_RANK_STABILITY) col = scr_printf(9, col + 1, color, "%-*s", FLEET_BAR_LEN + 5, heads[k]);
+        else col = scr_printf(9, col, color, "%9s", heads[k]);
+    }
+    col = scr_printf(9, col, ANSI_BOLD ANSI_WHITE, "%7s", "Every");
+    scr_put(9, col + 1, ANSI_BOLD ANSI_WHITE, hist_w >= 7 ? "History" : hist_w >= 4 ? "Hist" : "");
+    
+    // Ab Zeile 10 bis vor die Fußzeile; die letzte Zeile nennt den Rest
+    int first = 10, last_row = term_rows - 1;
+    size_t fit = (size_t)(last_row - first + 1);
+    if (fleet.count > fit) fit--;
+    for (int row = first; row <= last_row; row++) scr_clear_row(row);
+    
+    fleet_nshown = (int)rank_top(&fleet.rank, fleet_shown, fit);
+    if (fleet_sel >= fleet_nshown) fleet_sel = fleet_nshown > 0 ? fleet_nshown - 1 : 0;
+    
+    for (int i = 0; i < fleet_nshown; i++) {
+        const FleetTarget *t = &fleet.targets[fleet_shown[i]];
+        int row = first + i;
+        double avg = fleet_rank_value(t, FLEET_RANK_AVG);
+        double p99 = fleet_rank_value(t, FLEET_RANK_P99);
+        double tloss = fleet_loss(t);
+        double stability = calculate_stability(tloss);
         
-        // Zeile 7: Quality & Stability Balken
-        CURSOR_POS(7, 1);
-        
-        double quality = calculate_quality(last);
-        double loss = (packets_sent > 0) ? (packets_sent - packets_recv) * 100.0 / packets_sent : 0.0;
-        double stability = calculate_stability(loss);
-        
-        printf("%sQuality: ", ANSI_BOLD ANSI_WHITE);
-        
-        // Quality-Balken
-        if (quality >= 80) printf("%s", ANSI_GREEN);
-        else if (quality >= 60) printf("%s", ANSI_YELLOW);
-        else if (quality >= 40) printf("%s", ANSI_ORANGE);
-        else printf("%s", ANSI_RED);
-        
-        draw_dynamic_bar(quality, bar_length, "");
-        printf("%s | %sStability: ", ANSI_RESET, ANSI_BOLD ANSI_WHITE);
-        
-        // Stability-Balken
-        if (stability >= 90) printf("%s", ANSI_GREEN);
-        else if (stability >= 70) printf("%s", ANSI_YELLOW);
-        else if (stability >= 50) printf("%s", ANSI_ORANGE);
-        else printf("%s", ANSI_RED);
-        
-        draw_dynamic_bar(stability, bar_length, "");
-        printf(" %.0f%%%s%s", stability, ANSI_CLEAR_LINE, ANSI_RESET);
-        
-        // Zeile 8: History
-        draw_history(8, footer_len, warn, crit);
-        
-        // Zeile 9: Leerzeile
-        CURSOR_POS(9, 1);
-        printf("%s", ANSI_CLEAR_LINE);
+        if (i == fleet_sel) scr_put(row, 1, ANSI_BOLD ANSI_CYAN, ">");
+        col = scr_printf(row, 3, i == fleet_sel ? ANSI_BOLD ANSI_WHITE : ANSI_WHITE, "%-*.*s", name_w, name_w, t->name);
+        if (fleet_hist_at(t, 0) == 0) col = scr_printf(row, col, ANSI_RED, "%9s", "lost");
+        else col = scr_printf(row, col, get_color(t->last, warn, crit), "%9.1f", t->last);
+        col = scr_printf(row, col, get_color(avg, warn, crit), "%9.1f", avg);
+        col = scr_printf(row, col, get_color(p99, warn, crit), "%9.1f", p99);
+        col = scr_printf(row, col, tloss > 0 ? ANSI_YELLOW : ANSI_GREEN, "%8.1f%%", tloss);
         
-        // Metriken
-        char last_buf[32];
-        snprintf(last_buf, sizeof(last_buf), "%.1f ms", last);
-        draw_line_right(10, "Last:", last_buf, get_color(last, warn, crit), VALUE_WIDTH);
+        // Stabilität wie in der Einzelansicht als Balken
+        const char* stability_color = get_stability_color(stability);
+        col = draw_dynamic_bar(row, col + 1, stability, FLEET_BAR_LEN, stability_color);
+        col = scr_printf(row, col, stability_color, " %3.0f%%", stability);
         
-        double avg = packets_recv > 0 ? sum / packets_recv : 0.0;
-        char avg_buf[32];
-        snprintf(avg_buf, sizeof(avg_buf), "%.1f ms", avg);
-        draw_line_right(11, "Avg :", avg_buf, get_color(avg, warn, crit), VALUE_WIDTH);
+        // Aktueller Sendeabstand: schneller als eingestellt gelb, langsamer grün
+        int64_t configured = t->interval_us > 0 ? t->interval_us : fleet.interval_us;
+        char every[16];
+        format_interval(every, sizeof(every), t->every_us);
+        const char* every_color = t->every_us == 0 || t->every_us == configured ? ANSI_WHITE :
+                                  t->every_us < configured ? ANSI_YELLOW : ANSI_GREEN;
+        col = scr_printf(row, col, every_color, "%7s", t->every_us ? every : "-");
         
-        char loss_buf[32];
-        snprintf(loss_buf, sizeof(loss_buf), "%.2f %%", loss);
-        const char* loss_color = (loss > 0) ? ANSI_YELLOW : ANSI_GREEN;
-        draw_line_right(12, "Loss:", loss_buf, loss_color, VALUE_WIDTH);
+        // Verlauf wie in der Einzelansicht: älteste links
+        col++;
+        for (int age = hist_w - 1; age >= 0; age--) {
+            double v = fleet_hist_at(t, (uint32_t)age);
+            if (v < 0) col = scr_put(row, col, ANSI_WHITE, "·");
+            else if (v == 0) col = scr_put(row, col, ANSI_RED, "×");
+            else col = scr_put(row, col, get_history_color(v, warn, crit), "█");
+        }
+    }
+    if (fleet.count > fit) {
+        scr_printf(last_row, 3, ANSI_WHITE, "+%zu more, worst %s first", fleet.count - fit,
+                   fleet_rank_name(fleet.rank_key));
+    }
+    
+    // Copyright-Fußzeile (OHNE Version)
+    scr_clear_row(term_rows);
+    scr_put(term_rows, 1, ANSI_WHITE, footer);
+}
+
+// Pfadansicht: ein Hop pro Zeile mit Verlust, RTTs und Verlauf in den
+// Farben von draw_history()
+void draw_path(void) {
+    int nhops = path_hops(&path);
+    
+    // Zeile 7: Übersicht
+    scr_clear_row(7);
+    int col = scr_put(7, 1, ANSI_BOLD ANSI_WHITE, "Hops: ");
+    if (path.dest_ttl) col = scr_printf(7, col, ANSI_WHITE, "%d", nhops);
+    else col = scr_put(7, col, ANSI_YELLOW, "destination not reached");
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Rounds: ");
+    col = scr_printf(7, col, ANSI_WHITE, "%u", path.round);
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Probes: ");
+    col = scr_printf(7, col, ANSI_WHITE, "%llu", (unsigned long long)path.probes);
+    if (path.send_errors) {
+        col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, " | Send errors: ");
+        scr_printf(7, col, ANSI_RED, "%llu", (unsigned long long)path.send_errors);
+    }
+    
+    // Zeile 8: Meldung
+    scr_clear_row(8);
+    if (status_msg[0]) scr_put(8, 1, ANSI_CYAN, status_msg);
+    
+    // Verlauf so breit, wie das Terminal neben den festen Spalten Platz hat
+    int hist_w = term_cols - PATH_FIXED_W;
+    if (hist_w > PATH_HIST) hist_w = PATH_HIST;
+    
+    // Zeile 9: Spaltenköpfe
+    scr_clear_row(9);
+    col = scr_printf(9, 1, ANSI_BOLD ANSI_WHITE, "%3s  %-16s %8s %6s %9s %9s %9s %9s ",
+                     "#", "Host", "Loss", "Sent", "Last", "Avg", "Best", "Worst");
+    scr_put(9, col, ANSI_BOLD ANSI_WHITE, hist_w >= 7 ? "History" : hist_w >= 4 ? "Hist" : "");
+    
+    // Ab Zeile 10 bis vor die Fußzeile; passt der Pfad nicht, nennt die letzte Zeile den Rest
+    int first = 10, last_row = term_rows - 1;
+    int fit = last_row - first + 1;
+    if (nhops > fit) fit--;
+    for (int row = first; row <= last_row; row++) scr_clear_row(row);
+    
+    for (int i = 0; i < nhops && i < fit; i++) {
+        const PathHop *h = &path.hops[i];
+        int row = first + i;
+        double loss = path_loss(h);
         
-        char status_buf[32];
-        const char* status_color;
-        if (timeout_state) {
-            snprintf(status_buf, sizeof(status_buf), "TIMEOUT");
-            status_color = ANSI_RED;
+        col = scr_printf(row, 1, ANSI_WHITE, "%3d. ", i + 1);
+        if (h->addr.s_addr) {
+            char addr[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &h->addr, addr, sizeof(addr));
+            col = scr_printf(row, col, ANSI_WHITE, "%-15s%s", addr, h->changed ? "*" : " ");
         } else {
-            snprintf(status_buf, sizeof(status_buf), "OK");
-            status_color = ANSI_GREEN;
+            col = scr_printf(row, col, ANSI_WHITE, "%-16s", "???");
+        }
+        col = scr_printf(row, col, loss > 0 ? ANSI_YELLOW : ANSI_GREEN, "%7.1f%%", loss);
+        col = scr_printf(row, col, ANSI_WHITE, "%7llu", (unsigned long long)h->sent);
+        if (h->recv == 0) {
+            col = scr_printf(row, col, ANSI_WHITE, "%10s%10s%10s%10s", "-", "-", "-", "-");
+        } else {
+            if (path_hist_at(h, 0) == 0) col = scr_printf(row, col, ANSI_RED, "%10s", "lost");
+            else col = scr_printf(row, col, get_color(h->last, warn, crit), "%10.1f", h->last);
+            double avg = h->sum / (double)h->recv;
+            col = scr_printf(row, col, get_color(avg, warn, crit), "%10.1f", avg);
+            col = scr_printf(row, col, get_color(h->lat.min, warn, crit), "%10.1f", h->lat.min);
+            col = scr_printf(row, col, get_color(h->lat.max, warn, crit), "%10.1f", h->lat.max);
         }
-        draw_line_right(13, "Status:", status_buf, status_color, VALUE_WIDTH);
-        
-        char sr_buf[32];
-        snprintf(sr_buf, sizeof(sr_buf), "%d/%d", packets_sent, packets_recv);
-        draw_line_right(14, "Sent/Recv:", sr_buf, ANSI_WHITE, VALUE_WIDTH);
         
-        // Copyright-Fußzeile (OHNE Version)
-        CURSOR_POS(16, 1);
-        printf("%s%s%s%s", ANSI_WHITE, footer, ANSI_CLEAR_LINE, ANSI_RESET);
+        // Verlauf wie in der Einzelansicht: älteste links
+        col += 2;
+        for (int age = hist_w - 1; age >= 0; age--) {
+            double v = path_hist_at(h, (uint32_t)age);
+            if (v < 0) col = scr_put(row, col, ANSI_WHITE, "·");
+            else if (v == 0) col = scr_put(row, col, ANSI_RED, "×");
+            else col = scr_put(row, col, get_history_color(v, warn, crit), "█");
+        }
+    }
+    if (nhops > fit) scr_printf(last_row, 1, ANSI_WHITE, "+%d more hops", nhops - fit);
+    
+    // Copyright-Fußzeile (OHNE Version)
+    scr_clear_row(term_rows);
+    scr_put(term_rows, 1, ANSI_WHITE, footer);
+}
+
+// Glyphe und Farbe einer Heatmap-Zelle nach Anteil an den Antworten der Spalte
+const char* heat_shade(double share, const char** color) {
+    if (share < 0.02) { *color = ANSI_HEAT_1; return "░"; }
+    if (share < 0.10) { *color = ANSI_HEAT_2; return "▒"; }
+    if (share < 0.25) { *color = ANSI_HEAT_3; return "▓"; }
+    *color = share < 0.5 ? ANSI_HEAT_4 : ANSI_HEAT_5;
+    return "█";
+}
+
+// Alter einer Spalte für die Zeitachse, z. B. "-90s", "-15m", "-2h"
+void format_age(char* buf, size_t size, int64_t us) {
+    int64_t s = us / 1000000;
+    if (s < 120) snprintf(buf, size, "-%llds", (long long)s);
+    else if (s < 7200) snprintf(buf, size, "-%lldm", (long long)(s / 60));
+    else snprintf(buf, size, "-%lldh", (long long)(s / 3600));
+}
+
+// Heatmap (Taste g): eine Spalte pro Zeitscheibe, so viele wie das Terminal
+// breit ist, neueste rechts; eine Zeile pro Latenzstufe. Gezeichnet werden
+// nur die Stufen, die in den sichtbaren Spalten vorkommen, bei Platzmangel
+// mehrere pro Zeile
+void draw_heatmap(void) {
+    int width = term_cols - HEAT_LABEL_W;
+    if (width > HEAT_COLS) width = HEAT_COLS;
+    int lost_row = 8, top = 9, axis = term_rows - 2, legend = term_rows - 1;
+    int avail = axis - top;
+    
+    // Zeile 7: Maßstab
+    scr_clear_row(7);
+    char slice_buf[16];
+    format_interval(slice_buf, sizeof(slice_buf), heat.slice_us);
+    int shown = heat.filled < width ? heat.filled : width;
+    char span_buf[16];
+    format_age(span_buf, sizeof(span_buf), (int64_t)shown * heat.slice_us);
+    int col = scr_put(7, 1, ANSI_BOLD ANSI_WHITE, "Heatmap: ");
+    scr_printf(7, col, ANSI_WHITE, "%s per column, %s shown | share of each column's replies per latency band",
+               slice_buf, span_buf + 1);
+    
+    // Belegte Stufen der sichtbaren Spalten
+    int lo = HEAT_BUCKETS, hi = -1;
+    for (int age = 0; age < shown; age++) {
+        const HeatColumn *c = heat_at(&heat, age);
+        if (!c->recv) continue;
+        if (c->lo < lo) lo = c->lo;
+        if (c->hi > hi) hi = c->hi;
+    }
+    for (int row = lost_row; row < axis; row++) scr_clear_row(row);
+    
+    // Verluste über den Latenzzeilen
+    scr_put(lost_row, 1, ANSI_WHITE, "   lost");
+    for (int x = 0; x < shown; x++) {
+        const HeatColumn *c = heat_at(&heat, shown - 1 - x);
+        if (!c->lost) continue;
+        double share = (double)c->lost / (double)(c->lost + c->recv);
+        scr_put(lost_row, HEAT_LABEL_W + 1 + (width - shown) + x, share < 0.1 ? ANSI_YELLOW : ANSI_RED, "×");
+    }
+    
+    if (hi < 0) {
+        scr_put(top, HEAT_LABEL_W + 1, ANSI_YELLOW, "waiting for replies...");
+    } else {
+        // Wenige Stufen: Bereich nach oben und unten auffüllen;
+        // zu viele: per Stufen pro Zeile zusammenfassen
+        while (hi - lo + 1 < avail && (hi < HEAT_BUCKETS - 1 || lo > 0)) {
+            if (hi < HEAT_BUCKETS - 1) hi++;
+            if (hi - lo + 1 < avail && lo > 0) lo--;
+        }
+        int per = (hi - lo + avail) / avail;
+        int rows = (hi - lo + per) / per;
         
+        for (int r = 0; r < rows; r++) {
+            int line = axis - 1 - r;         // niedrigste Latenz unten
+            int first = lo + r * per;
+            int end = first + per;
+            if (end > hi + 1) end = hi + 1;
+            
+            double lower = heat_bucket_lower(first);
+            char label[16];
+            if (lower < 0.1) snprintf(label, sizeof(label), "%.0fus", lower * 1000.0);
+            else if (lower < 1) snprintf(label, sizeof(label), "%.2fms", lower);
+            else if (lower < 10) snprintf(label, sizeof(label), "%.1fms", lower);
+            else if (lower < 1000) snprintf(label, sizeof(label), "%.0fms", lower);
+            else snprintf(label, sizeof(label), "%.1fs", lower / 1000.0);
+            scr_printf(line, 1, get_history_color(lower, warn, crit), "%*s", HEAT_LABEL_W - 1, label);
+            
+            for (int x = 0; x < shown; x++) {
+                const HeatColumn *c = heat_at(&heat, shown - 1 - x);
+                if (!c->recv || end <= c->lo || first > c->hi) continue;
+                unsigned n = 0;
+                for (int b = first; b < end; b++) n += c->count[b];
+                if (!n) continue;
+                const char* color;
+                const char* glyph = heat_shade((double)n / (double)c->recv, &color);
+                scr_put(line, HEAT_LABEL_W + 1 + (width - shown) + x, color, glyph);
+            }
+        }
+    }
+    
+    // Zeitachse: alle 20 Spalten das Alter, rechts "now"
+    scr_clear_row(axis);
+    int right = HEAT_LABEL_W + width;
+    for (int age = 20; age < shown; age += 20) {
+        char age_buf[16];
+        format_age(age_buf, sizeof(age_buf), (int64_t)age * heat.slice_us);
+        int x = right - age;
+        scr_put(axis, x, ANSI_WHITE, "|");
+        scr_put(axis, x + 1, ANSI_WHITE, age_buf);
+    }
+    if (shown) scr_put(axis, right - 2, ANSI_WHITE, "now");
+    
+    // Legende
+    scr_clear_row(legend);
+    col = scr_put(legend, 1, ANSI_WHITE, "Share: ");
+    static const double shares[] = { 0.01, 0.05, 0.2, 0.4, 0.6 };
+    static const char* const shade_labels[] = { "<2% ", "<10% ", "<25% ", "<50% ", ">=50%" };
+    for (int i = 0; i < 5; i++) {
+        const char* color;
+        const char* glyph = heat_shade(shares[i], &color);
+        col = scr_put(legend, col, color, glyph);
+        col = scr_printf(legend, col + 1, ANSI_WHITE, "%s ", shade_labels[i]);
+    }
+    col = scr_put(legend, col + 1, ANSI_YELLOW, "×");
+    scr_put(legend, col + 1, ANSI_WHITE, "loss | labels colored by WARN/CRIT");
+    
+    scr_clear_row(term_rows);
+    scr_put(term_rows, 1, ANSI_WHITE, footer);
+}
+
+// Dynamischen Bereich (Zeilen 6-16) in den Framebuffer zeichnen
+void draw_frame(void) {
+    // Zeile 6: MyIP-Info
+    scr_clear_row(6);
+    if (show_ip_info && myip.info.fetched) {
+        int col = scr_put(6, 1, ANSI_BOLD ANSI_WHITE, "MyIP: ");
+        col = scr_put(6, col, ANSI_MAGENTA, myip.info.ip);
+        col = scr_put(6, col, ANSI_BOLD ANSI_WHITE, " | ISP: ");
+        col = scr_put(6, col, ANSI_MAGENTA, myip.info.isp);
+        col = scr_put(6, col, ANSI_BOLD ANSI_WHITE, " | Location: ");
+        scr_put(6, col, ANSI_MAGENTA, myip.info.location);
+    } else if (show_ip_info) {
+        int col = scr_put(6, 1, ANSI_BOLD ANSI_WHITE, "MyIP: ");
+        scr_put(6, col, ANSI_MAGENTA, "looking up...");
+    }
+    
+    if (path_view) {
+        draw_path();
+        return;
+    }
+    if (fleet.count && fleet_focus < 0) {
+        draw_fleet();
+        return;
+    }
+    if (heat_view) {
+        draw_heatmap();
+        return;
+    }
+    
+    // Zeile 7: Quality & Stability Balken
+    scr_clear_row(7);
+    
+    double quality = calculate_quality(last);
+    double loss = (packets_sent > 0) ? (packets_sent - packets_recv) * 100.0 / packets_sent : 0.0;
+    double stability = calculate_stability(loss);
+    
+    int col = scr_put(7, 1, ANSI_BOLD ANSI_WHITE, "Quality: ");
+    
+    // Quality-Balken
+    col = draw_dynamic_bar(7, col, quality, bar_length, get_quality_color(quality));
+    col = scr_put(7, col, "", " | ");
+    col = scr_put(7, col, ANSI_BOLD ANSI_WHITE, "Stability: ");
+    
+    // Stability-Balken
+    col = draw_dynamic_bar(7, col, stability, bar_length, get_stability_color(stability));
+    scr_printf(7, col, "", " %.0f%%", stability);
+    
+    // Zeile 8: History
+    draw_history(8, footer_len, warn, crit);
+    
+    // Zeile 9: Leerzeile bzw. Meldung (z. B. nach Export)
+    scr_clear_row(9);
+    if (status_msg[0]) scr_put(9, 1, ANSI_CYAN, status_msg);
+    
+    // Metriken
+    char last_buf[32];
+    snprintf(last_buf, sizeof(last_buf), "%.1f ms", last);
+    draw_line_right(10, "Last:", last_buf, get_color(last, warn, crit), VALUE_WIDTH);
+    
+    double avg = packets_recv > 0 ? sum / packets_recv : 0.0;
+    char avg_buf[32];
+    snprintf(avg_buf, sizeof(avg_buf), "%.1f ms", avg);
+    draw_line_right(11, "Avg :", avg_buf, get_color(avg, warn, crit), VALUE_WIDTH);
+    
+    // Verteilung neben Last/Avg: Min/Max, Perzentile, Streuung
+    draw_latency_at(10, STAT_COL_1, "Min:", lat_stats.min, warn, crit);
+    draw_latency_at(10, STAT_COL_2, "Max:", lat_stats.max, warn, crit);
+    draw_latency_at(11, STAT_COL_1, "P50:", lat_percentile(&lat_stats, 50), warn, crit);
+    draw_latency_at(11, STAT_COL_2, "P95:", lat_percentile(&lat_stats, 95), warn, crit);
+    
+    char loss_buf[32];
+    snprintf(loss_buf, sizeof(loss_buf), "%.2f %%", loss);
+    const char* loss_color = (loss > 0) ? ANSI_YELLOW : ANSI_GREEN;
+    draw_line_right(12, "Loss:", loss_buf, loss_color, VALUE_WIDTH);
+    draw_latency_at(12, STAT_COL_1, "P99:", lat_percentile(&lat_stats, 99), warn, crit);
+    
+    char dev_buf[32];
+    snprintf(dev_buf, sizeof(dev_buf), "%.1f ms", lat_stddev(&lat_stats));
+    draw_value_at(12, STAT_COL_2, "StdDev:", dev_buf, ANSI_WHITE, VALUE_WIDTH);
+    
+    char status_buf[32];
+    const char* status_color;
+    if (fleet_focus < 0 && !resolver.has_addr) {
+        snprintf(status_buf, sizeof(status_buf), resolver.error ? "UNRESOLVED" : "RESOLVING");
+        status_color = resolver.error ? ANSI_RED : ANSI_YELLOW;
+    } else if (timeout_state) {
+        snprintf(status_buf, sizeof(status_buf), "TIMEOUT");
+        status_color = ANSI_RED;
+    } else {
+        snprintf(status_buf, sizeof(status_buf), "OK");
+        status_color = ANSI_GREEN;
+    }
+    draw_line_right(13, "Status:", status_buf, status_color, VALUE_WIDTH);
+    
+    char jitter_buf[32];
+    snprintf(jitter_buf, sizeof(jitter_buf), "%.1f ms", lat_stats.jitter);
+    draw_value_at(13, STAT_COL_1, "Jitter:", jitter_buf, get_color(lat_stats.jitter, warn, crit), VALUE_WIDTH);
+    
+    // Einzelansicht eines Mehrfachziels: aktueller Sendeabstand seines Workers
+    if (fleet_focus >= 0) {
+        char every_buf[16];
+        format_interval(every_buf, sizeof(every_buf), fleet.targets[fleet_focus].every_us);
+        draw_value_at(13, STAT_COL_2, "Every:", every_buf, ANSI_WHITE, VALUE_WIDTH);
+    }
+    
+    char sr_buf[32];
+    snprintf(sr_buf, sizeof(sr_buf), "%d/%d", packets_sent, packets_recv);
+    draw_line_right(14, "Sent/Recv:", sr_buf, ANSI_WHITE, VALUE_WIDTH);
+    
+    // Duplikate/vertauschte und verspätete Antworten (nicht in Sent/Recv);
+    // in der Einzelansicht eines Mehrfachziels zählt dessen Worker
+    uint64_t dup = tracker.dup, reordered = tracker.reordered, late_count = tracker.late;
+    if (fleet_focus >= 0) {
+        const FleetTarget *t = &fleet.targets[fleet_focus];
+        dup = t->dup;
+        reordered = t->reordered;
+        late_count = t->late;
+    }
+    char dr_buf[32];
+    snprintf(dr_buf, sizeof(dr_buf), "%llu/%llu", (unsigned long long)dup, (unsigned long long)reordered);
+    draw_value_at(14, STAT_COL_1, "Dup/Ord:", dr_buf, dup + reordered > 0 ? ANSI_YELLOW : ANSI_WHITE, VALUE_WIDTH);
+    
+    char late_buf[32];
+    snprintf(late_buf, sizeof(late_buf), "%llu", (unsigned long long)late_count);
+    draw_value_at(14, STAT_COL_2, "Late:", late_buf, late_count > 0 ? ANSI_YELLOW : ANSI_WHITE, VALUE_WIDTH);
+    
+    // Zeile 15: Eigenmessung (Taste d)
+    scr_clear_row(15);
+    if (debug_row) draw_debug_row();
+    
+    // Copyright-Fußzeile (OHNE Version)
+    scr_clear_row(16);
+    scr_put(16, 1, ANSI_WHITE, footer);
+}
+
+// Neu zeichnen, wenn sich etwas geändert hat - aber höchstens alle RENDER_MIN_US
+void maybe_render(void) {
+    if (!dirty || render_armed) return;
+    
+    int64_t now_us = mono_us();
+    int64_t wait_us = last_render_us + RENDER_MIN_US - now_us;
+    if (wait_us > 0) {
+        ev_timer_arm(render_handler.fd, wait_us, 0);
+        render_armed = 1;
+        return;
+    }
+    
+    int64_t start_ns = self_ns();
+    draw_frame();
+    scr_flush(STDOUT_FILENO);   // Nur geänderte Zellen, ein write()
+    self_frame(start_ns);
+    dirty = 0;
+    last_render_us = now_us;
+}
+
+// Nur lange Optionen
+enum {
+    OPT_IP_URL = 256,
+    OPT_ORG_URL,
+    OPT_COUNTRY_URL,
+    OPT_IP_CACHE,
+    OPT_IP_CACHE_TTL,
+    OPT_MAX_RATE,
+    OPT_RESOLVE_TTL,
+    OPT_TCP,
+    OPT_UDP,
+    OPT_HEADLESS,
+    OPT_FORMAT,
+    OPT_AGGREGATE,
+    OPT_OUTPUT,
+    OPT_FLUSH_MS,
+    OPT_FLUSH_BYTES,
+    OPT_DUMP,
+    OPT_PUBLISH,
+    OPT_ATTACH
+};
+
+void usage(FILE* out) {
+    fprintf(out,
+            "Usage: pingmon [options] [warn] [crit] [target]\n"
+            "\n"
+            "  warn, crit      Thresholds in ms (default 30, 60)\n"
+            "  target          IPv4/IPv6 address or hostname (default 8.8.8.8)\n"
+            "\n"
+            "Options:\n"
+            "  -4, -6                Resolve target to IPv4 or IPv6 only\n"
+            "      --resolve-ttl S   Re-resolve a hostname target every S seconds; a new\n"
+            "                        address splits the statistics (default 60)\n"
+            "      --tcp PORT        Probe by TCP handshake time to PORT instead of ICMP\n"
+            "      --udp PORT        Probe by round trip through a UDP echo service on PORT\n"
+            "  -l, --log FILE        Append every probe to FILE and resume from it on restart\n"
+            "  -t, --timeout MS      Count a probe as lost after MS milliseconds (default 2000)\n"
+            "  -i, --interval MS     Probe interval in milliseconds, down to 1 (default 1000)\n"
+            "  -M, --metrics ADDR    Serve OpenMetrics on ADDR: [host:]port or unix:/path\n"
+            "  -f, --targets FILE    Probe every IPv4 address listed in FILE (one per line,\n"
+            "                        optional name after it) instead of a single target\n"
+            "  -j, --workers N       Prober threads for --targets (default: one per CPU)\n"
+            "  -a, --adaptive        With --targets: probe healthy targets at 1/4 of the\n"
+            "                        interval, targets over warn or with loss at the interval\n"
+            "                        and targets over crit or with heavy loss at 4x\n"
+            "      --max-rate N      With --targets: at most N probes/s in total\n"
+            "                        (default 10000 with --adaptive, otherwise unlimited)\n"
+            "  -p, --path            Start in the path view: every hop to target probed\n"
+            "                        in parallel, like mtr (also key p)\n"
+            "      --headless        No terminal UI: write one record per probe to stdout\n"
+            "      --format F        Headless record format: json (one object per line,\n"
+            "                        default) or binary (fixed-size records)\n"
+            "      --aggregate S     Headless: one record per target every S seconds\n"
+            "                        (sent, received, loss, min/avg/max/p99) instead\n"
+            "      --output FILE     Headless: write records to FILE instead of stdout\n"
+            "      --flush-ms MS     Headless: write buffered records after MS milliseconds\n"
+            "                        at the latest (default 1000)\n"
+            "      --flush-bytes N   Headless: write once N bytes are buffered (default 65536)\n"
+            "      --dump FILE       On SIGUSR1, append internal counters to FILE instead\n"
+            "                        of stderr (key d shows them on screen)\n"
+            "      --publish NAME    Keep counters, latency statistics and history in shared\n"
+            "                        memory /dev/shm/NAME for other processes to read\n"
+            "      --attach NAME     Show what another pingmon publishes as NAME; no probes\n"
+            "      --ip-url URL      MyIP source returning the address as text (repeatable,\n"
+            "                        replaces the built-in list)\n"
+            "      --org-url URL     ISP source (default http://ipinfo.io/org)\n"
+            "      --country-url URL Country code source (default http://ipinfo.io/country)\n"
+            "      --ip-cache FILE   MyIP cache file, empty to disable\n"
+            "                        (default ~/.cache/pingmon/myip)\n"
+            "      --ip-cache-ttl S  Seconds a cached MyIP result stays valid (default 3600)\n"
+            "  -h, --help            Show this help\n");
+}
+
+#ifndef PINGMON_NO_MAIN     // pingmon-bench bindet pingmon.c ohne main() ein
+int main(int argc, char *argv[]) {
+    // Terminal-Einstellungen für Cleanup speichern
+    tcgetattr(STDIN_FILENO, &saved_termios);
+    
+    // ========== ERWEITERTE SIGNAL-HANDLER ==========
+    // Synchrone Fehler-Signale weiterhin per Handler, Rest über signalfd
+    struct sigaction sa;
+    sa.sa_handler = cleanup_and_exit;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    
+    sigaction(SIGINT, &sa, NULL);   // Ctrl+C (bis signalfd aktiv ist)
+    sigaction(SIGTERM, &sa, NULL);  // kill
+    sigaction(SIGSEGV, &sa, NULL);  // Segmentation Fault
+    sigaction(SIGPIPE, &sa, NULL);  // Broken Pipe
+    sigaction(SIGABRT, &sa, NULL);  // Abort
+    
+    if (seq_init(&tracker, SEQ_WINDOW) == -1) {
+        fprintf(stderr, "Fehler: kein Speicher\n");
+        return 1;
+    }
+    
+    // Optionen (--log ...) vor den Positionsargumenten auswerten
+    myip_init(&myip, &loop);
+    myip.on_update = request_redraw;
+    static const struct option long_opts[] = {
+        {"log",     required_argument, NULL, 'l'},
+        {"timeout", required_argument, NULL, 't'},
+        {"interval", required_argument, NULL, 'i'},
+        {"metrics", required_argument, NULL, 'M'},
+        {"targets", required_argument, NULL, 'f'},
+        {"workers", required_argument, NULL, 'j'},
+        {"adaptive", no_argument,      NULL, 'a'},
+        {"path",    no_argument,       NULL, 'p'},
+        {"max-rate", required_argument, NULL, OPT_MAX_RATE},
+        {"resolve-ttl", required_argument, NULL, OPT_RESOLVE_TTL},
+        {"tcp",     required_argument, NULL, OPT_TCP},
+        {"udp",     required_argument, NULL, OPT_UDP},
+        {"headless", no_argument,      NULL, OPT_HEADLESS},
+        {"format",  required_argument, NULL, OPT_FORMAT},
+        {"aggregate", required_argument, NULL, OPT_AGGREGATE},
+        {"output",  required_argument, NULL, OPT_OUTPUT},
+        {"flush-ms", required_argument, NULL, OPT_FLUSH_MS},
+        {"flush-bytes", required_argument, NULL, OPT_FLUSH_BYTES},
+        {"dump",    required_argument, NULL, OPT_DUMP},
+        {"publish", required_argument, NULL, OPT_PUBLISH},
+        {"attach",  required_argument, NULL, OPT_ATTACH},
+        {"ip-url",       required_argument, NULL, OPT_IP_URL},
+        {"org-url",      required_argument, NULL, OPT_ORG_URL},
+        {"country-url",  required_argument, NULL, OPT_COUNTRY_URL},
+        {"ip-cache",     required_argument, NULL, OPT_IP_CACHE},
+        {"ip-cache-ttl", required_argument, NULL, OPT_IP_CACHE_TTL},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char* log_path = NULL;
+    const char* metrics_addr = NULL;
+    int nworkers = 0;
+    int adaptive = 0;
+    int start_path = 0;
+    double max_rate = -1;   // -1 = Standard
+    EmitFormat out_format = EMIT_JSON;
+    int64_t aggregate_ms = 0;
+    const char* out_path = NULL;
+    int headless_opts = 0;  // --format, --aggregate, ... ohne --headless
+    const char* publish_name = NULL;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "46l:t:i:M:f:j:aph", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case '4':
+            target_family = AF_INET;
+            break;
+        case '6':
+            target_family = AF_INET6;
+            break;
+        case 'l':
+            log_path = optarg;
+            break;
+        case 't': {
+            char* endptr;
+            double ms = strtod(optarg, &endptr);
+            if (*endptr != '\0' || ms <= 0) {
+                fprintf(stderr, "Fehler: ungültiger Timeout '%s'\n", optarg);
+                return 1;
+            }
+            probe_timeout_us = (int64_t)(ms * 1000.0);
+            break;
+        }
+        case 'i': {
+            char* endptr;
+            double ms = strtod(optarg, &endptr);
+            if (*endptr != '\0' || ms * 1000.0 < MIN_INTERVAL_US) {
+                fprintf(stderr, "Fehler: ungültiges Intervall '%s' (mindestens 1 ms)\n", optarg);
+                return 1;
+            }
+            probe_interval_us = (int64_t)(ms * 1000.0);
+            break;
+        }
+        case 'M':
+            metrics_addr = optarg;
+            break;
+        case 'f':
+            fleet_path = optarg;
+            break;
+        case 'j': {
+            char* endptr;
+            long n = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || n < 1 || n > 1024) {
+                fprintf(stderr, "Fehler: ungültige Worker-Anzahl '%s'\n", optarg);
+                return 1;
+            }
+            nworkers = (int)n;
+            break;
+        }
+        case 'a':
+            adaptive = 1;
+            break;
+        case 'p':
+            start_path = 1;
+            break;
+        case OPT_MAX_RATE: {
+            char* endptr;
+            max_rate = strtod(optarg, &endptr);
+            if (*endptr != '\0' || max_rate < 1) {
+                fprintf(stderr, "Fehler: ungültige Obergrenze '%s' (Probes/s, mindestens 1)\n", optarg);
+                return 1;
+            }
+            break;
+        }
+        case OPT_RESOLVE_TTL: {
+            char* endptr;
+            long ttl = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || ttl < 1) {
+                fprintf(stderr, "Fehler: ungültige Auflösungs-TTL '%s' (Sekunden, mindestens 1)\n", optarg);
+                return 1;
+            }
+            resolve_ttl = (int)ttl;
+            break;
+        }
+        case OPT_TCP:
+        case OPT_UDP: {
+            char* endptr;
+            long port = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || port < 1 || port > 65535) {
+                fprintf(stderr, "Fehler: ungültiger Port '%s'\n", optarg);
+                return 1;
+            }
+            probe_kind = opt == OPT_TCP ? CONN_TCP : CONN_UDP;
+            probe_port = (int)port;
+            break;
+        }
+        case OPT_HEADLESS:
+            headless = 1;
+            break;
+        case OPT_FORMAT:
+            if (strcmp(optarg, "json") == 0) {
+                out_format = EMIT_JSON;
+            } else if (strcmp(optarg, "binary") == 0) {
+                out_format = EMIT_BINARY;
+            } else {
+                fprintf(stderr, "Fehler: unbekanntes Format '%s' (json oder binary)\n", optarg);
+                return 1;
+            }
+            headless_opts = 1;
+            break;
+        case OPT_AGGREGATE: {
+            char* endptr;
+            double secs = strtod(optarg, &endptr);
+            if (*endptr != '\0' || secs < 0.001 || secs > 86400) {
+                fprintf(stderr, "Fehler: ungültiges Aggregationsintervall '%s' (Sekunden)\n", optarg);
+                return 1;
+            }
+            aggregate_ms = (int64_t)(secs * 1000.0 + 0.5);
+            headless_opts = 1;
+            break;
+        }
+        case OPT_OUTPUT:
+            out_path = optarg;
+            headless_opts = 1;
+            break;
+        case OPT_FLUSH_MS:
+        case OPT_FLUSH_BYTES: {
+            char* endptr;
+            long long n = strtoll(optarg, &endptr, 10);
+            if (*endptr != '\0' || n < 1 || n > 1000000000) {
+                fprintf(stderr, "Fehler: ungültiger Wert '%s' für --%s\n", optarg,
+                        opt == OPT_FLUSH_MS ? "flush-ms" : "flush-bytes");
+                return 1;
+            }
+            if (opt == OPT_FLUSH_MS) emitter.flush_ms = n;
+            else emitter.flush_bytes = (size_t)n;
+            headless_opts = 1;
+            break;
+        }
+        case OPT_DUMP:
+            dump_path = optarg;
+            break;
+        case OPT_PUBLISH:
+            publish_name = optarg;
+            break;
+        case OPT_ATTACH:
+            attach_name = optarg;
+            break;
+        case OPT_IP_URL:
+            if (myip_add_ip_url(&myip, optarg) == -1) {
+                fprintf(stderr, "Fehler: höchstens %d --ip-url\n", MYIP_MAX_URLS);
+                return 1;
+            }
+            break;
+        case OPT_ORG_URL:
+            myip.org_url = optarg;
+            break;
+        case OPT_COUNTRY_URL:
+            myip.country_url = optarg;
+            break;
+        case OPT_IP_CACHE:
+            snprintf(myip.cache_path, sizeof(myip.cache_path), "%s", optarg);
+            break;
+        case OPT_IP_CACHE_TTL:
+            myip.cache_ttl = atoi(optarg);
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 1;
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+    
+    // Argument-Parsing mit Fehlerprüfung
+    if (argc > 1) {
+        char* endptr;
+        warn = strtod(argv[1], &endptr);
+        if (*endptr != '\0' || warn <= 0) {
+            warn = 30; // Default bei Fehler
+        }
+    }
+    
+    if (argc > 2) {
+        char* endptr;
+        crit = strtod(argv[2], &endptr);
+        if (*endptr != '\0' || crit <= warn) {
+            crit = warn + 30; // Mindestens 30 über WARN
+        }
+    }
+    
+    if (argc > 3) {
+        if (strlen(argv[3]) >= sizeof(target)) {
+            fprintf(stderr, "Fehler: Zielname zu lang\n");
+            return 1;
+        }
+        strcpy(target, argv[3]);
+    }
+    
+    // Adressliteral passend zu -4/-6? Namen werden erst im Eventloop aufgelöst
+    ResolveAddr literal;
+    int family_mismatch = target_family != AF_UNSPEC &&
+                          resolve_numeric(target, AF_UNSPEC, &literal) == 0 &&
+                          literal.sa.sa_family != target_family;
+    if (family_mismatch) {
+        fprintf(stderr, "Fehler: %s ist keine %s-Adresse\n", target, target_family == AF_INET ? "IPv4" : "IPv6");
+        return 1;
+    }
+    
+    // Zielliste laden; Log und Metriken gibt es nur für ein einzelnes Ziel
+    if (!fleet_path && (adaptive || max_rate > 0)) {
+        fprintf(stderr, "Fehler: --adaptive und --max-rate gibt es nur mit --targets\n");
+        return 1;
+    }
+    if (headless_opts && !headless) {
+        fprintf(stderr, "Fehler: --format, --aggregate, --output und --flush-* gibt es nur mit --headless\n");
+        return 1;
+    }
+    if (headless && start_path) {
+        fprintf(stderr, "Fehler: --headless verträgt sich nicht mit --path\n");
+        return 1;
+    }
+    if (publish_name && fleet_path) {
+        fprintf(stderr, "Fehler: --publish gibt es nur für ein einzelnes Ziel\n");
+        return 1;
+    }
+    if (attach_name && (argc > 1 || fleet_path || log_path || metrics_addr || headless || headless_opts ||
+                        start_path || probe_kind || publish_name || target_family != AF_UNSPEC)) {
+        fprintf(stderr, "Fehler: --attach zeigt nur an und verträgt sich nicht mit warn/crit/target, --targets, --log, --metrics, --headless, --publish, --tcp/--udp, -4/-6 und --path\n");
+        return 1;
+    }
+    if (fleet_path) {
+        if (argc > 3 || log_path || metrics_addr || start_path || target_family != AF_UNSPEC || probe_kind) {
+            fprintf(stderr, "Fehler: --targets verträgt sich nicht mit target, --log, --metrics, -4/-6, --tcp/--udp und --path (dort Taste p)\n");
+            return 1;
+        }
+        int bad_line = 0;
+        int rc = fleet_load(&fleet, fleet_path, &bad_line);
+        if (rc == -2) {
+            fprintf(stderr, "Fehler: %s Zeile %d: ungültige oder doppelte IPv4-Adresse bzw. ungültiges Intervall\n", fleet_path, bad_line);
+            return 1;
+        }
+        if (rc == -1) {
+            fprintf(stderr, "Fehler: Zielliste %s: %s\n", fleet_path, strerror(errno));
+            return 1;
+        }
+        if (fleet.count == 0) {
+            fprintf(stderr, "Fehler: Zielliste %s enthält keine Ziele\n", fleet_path);
+            return 1;
+        }
+        fleet.interval_us = probe_interval_us;
+        fleet.timeout_us = probe_timeout_us;
+        fleet.adaptive = adaptive;
+        fleet.warn_ms = warn;
+        fleet.crit_ms = crit;
+        fleet.max_rate = max_rate > 0 ? max_rate : adaptive ? FLEET_ADAPT_MAX_RATE : 0;
+        fleet.on_update = request_redraw;
+        fleet.on_sample = on_fleet_sample;
+        fleet_set_rank(&fleet, FLEET_RANK_LOSS);
+        size_t bad;
+        if (fleet_check_window(&fleet, &bad) == -1) {
+            fprintf(stderr, "Fehler: %s: bei diesem Intervall wären bis zum Timeout mehr als %d Probes offen, -t verkürzen oder -i erhöhen\n",
+                    fleet.targets[bad].name, SEQ_WINDOW_MAX);
+            return 1;
+        }
+    }
+    
+    // Rangliste, Pfadansicht und Heatmap nutzen die ganze Terminalhöhe und
+    // werden auf die Terminalbreite begrenzt
+    struct winsize ws;
+    term_rows = SCREEN_ROWS;
+    term_cols = 80;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0) {
+        if (ws.ws_row > 0) term_rows = ws.ws_row;
+        if (ws.ws_col > 0) term_cols = ws.ws_col;
+    }
+    if (term_rows > SCREEN_ROWS) term_rows = SCREEN_ROWS;
+    if (term_rows < UI_ROWS) term_rows = UI_ROWS;
+    if (term_cols > SCREEN_COLS) term_cols = SCREEN_COLS;
+    if (term_cols < 40) term_cols = 40;
+
+    // MyIP aus dem Cache sofort verfügbar machen
+    myip_load_cache(&myip);
+
+    // Sample-Log öffnen und bisherige Sitzung fortsetzen
+    reset_stats();
+    if (log_path) {
+        int rc = slog_open(&sample_log, log_path, target, warn, crit);
+        if (rc == -2) {
+            fprintf(stderr, "Fehler: %s ist kein pingmon-Log für Ziel %s\n", log_path, target);
+            return 1;
+        }
+        if (rc == -1) {
+            fprintf(stderr, "Fehler: Log %s: %s\n", log_path, strerror(errno));
+            return 1;
+        }
+        resume_from_log();
+    }
+
+    // Segment in /dev/shm anlegen bzw. einblenden
+    if (publish_name && shm_publish_open(&shm, publish_name) == -1) {
+        fprintf(stderr, "Fehler: --publish %s: %s\n", publish_name,
+                errno == EADDRINUSE ? "wird schon von einem laufenden pingmon veröffentlicht" : strerror(errno));
+        return 1;
+    }
+    if (attach_name) {
+        int rc = shm_attach(&shm, attach_name);
+        if (rc == -2) {
+            fprintf(stderr, "Fehler: %s ist kein Segment dieser pingmon-Version\n", attach_name);
+            return 1;
+        }
+        if (rc == -1) {
+            fprintf(stderr, "Fehler: --attach %s: %s\n", attach_name,
+                    errno == ENOENT ? "kein laufendes pingmon --publish unter diesem Namen" : strerror(errno));
+            return 1;
+        }
+    }
+
+    // Ausgabe ohne Oberfläche: JSON-Zeilen anhängen, Binärdatei neu anlegen
+    int out_fd = STDOUT_FILENO;
+    if (headless && out_path) {
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (out_format == EMIT_BINARY ? O_TRUNC : O_APPEND);
+        if ((out_fd = open(out_path, flags, 0644)) == -1) {
+            fprintf(stderr, "Fehler: Ausgabe %s: %s\n", out_path, strerror(errno));
+            return 1;
+        }
+    }
+    if (headless) {
+        // Leser weg: Schreibfehler EPIPE statt Abbruch, die Schleife endet regulär
+        signal(SIGPIPE, SIG_IGN);
+    } else {
+        // Terminal auf raw mode setzen
+        struct termios newt = saved_termios;
+        newt.c_lflag &= ~(ICANON | ECHO);
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &newt) == -1) {
+            fprintf(stderr, "Fehler: Terminal konnte nicht konfiguriert werden\n");
+            return 1;
+        }
+    }
+
+    // ========== EVENTLOOP AUFSETZEN ==========
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGUSR1);
+    
+    if (ev_init(&loop) == -1 ||
+        (signal_handler.fd = ev_signal_new(&mask)) == -1 ||
+        (tick_handler.fd = ev_timer_new()) == -1 ||
+        (render_handler.fd = ev_timer_new()) == -1 ||
+        (expire_handler.fd = ev_timer_new()) == -1 ||
+        (publish_handler.fd = ev_timer_new()) == -1) {
+        fprintf(stderr, "Fehler: Eventloop konnte nicht initialisiert werden\n");
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        return 1;
+    }
+    signal_handler.cb = on_signal;
+    tick_handler.cb = on_tick;
+    render_handler.cb = on_render_timer;
+    expire_handler.cb = on_expire_timer;
+    publish_handler.cb = on_publish_timer;
+    tracker.on_lost = on_probe_lost;
+    stdin_handler.fd = STDIN_FILENO;
+    stdin_handler.cb = on_stdin;
+    
+    ev_add(&loop, &signal_handler, EPOLLIN);
+    ev_add(&loop, &tick_handler, EPOLLIN);
+    ev_add(&loop, &render_handler, EPOLLIN);
+    ev_add(&loop, &expire_handler, EPOLLIN);
+    ev_add(&loop, &publish_handler, EPOLLIN);
+    if (!headless) ev_add(&loop, &stdin_handler, EPOLLIN);   // schlägt bei /dev/null fehl, egal
+    
+    if (metrics_addr && metrics_open(&metrics, metrics_addr, &loop, fill_metrics) == -1) {
+        fprintf(stderr, "Fehler: Metrics-Endpunkt %s: %s\n", metrics_addr, strerror(errno));
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        return 1;
+    }
+    
+    // Namen für die Datensätze: Einzelziel bzw. Bezeichnungen der Zielliste
+    if (headless) {
+        size_t count = fleet.count ? fleet.count : 1;
+        const char **names = malloc(count * sizeof(*names));
+        if (!names) {
+            fprintf(stderr, "Fehler: kein Speicher\n");
+            return 1;
+        }
+        for (size_t i = 0; i < count; i++) names[i] = fleet.count ? fleet.targets[i].name : target;
+        int rc = emit_open(&emitter, &loop, out_fd, out_format, names, count, aggregate_ms);
+        free(names);
+        if (rc == -1) {
+            fprintf(stderr, "Fehler: Ausgabe: %s\n", strerror(errno));
+            return 1;
+        }
+        int64_t now_ms = wall_ms();
+        for (size_t i = 0; i < fleet.count; i++) {
+            char addr[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &fleet.targets[i].addr.sin_addr, addr, sizeof(addr));
+            emit_address(&emitter, (uint32_t)i, now_ms, addr);
+        }
+    }
+
+    // ========== SICHERES PING-STARTEN ==========
+    // Einzelziel: Probes starten, sobald die Adresse bekannt ist (Literale
+    // sofort, Namen asynchron; siehe on_target_address)
+    probe_handler.fd = -1;
+    if (attach_name) {
+        // Keine Probes: nur die Veröffentlichung des anderen abfragen
+        attach_poll();
+        ev_timer_arm(publish_handler.fd, ATTACH_POLL_US, ATTACH_POLL_US);
+    } else if (fleet.count) {
+        // Worker erben die für signalfd blockierte Signalmaske
+        if (fleet_start(&fleet, nworkers, &loop) == -1) {
+            fprintf(stderr, "Fehler: Worker konnten nicht gestartet werden: %s\n", strerror(errno));
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+            return 1;
+        }
+    } else {
+        conn.on_reply = on_conn_reply;
+        conn.on_refused = on_conn_refused;
+        resolver.on_change = on_target_address;
+        resolver.on_update = on_target_resolved;
+        path_pending = start_path;
+        if (resolve_start(&resolver, &loop, target, target_family, resolve_ttl) == -1) {
+            fprintf(stderr, "Fehler: Namensauflösung konnte nicht gestartet werden: %s\n", strerror(errno));
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+            return 1;
+        }
+        if (resolver.has_addr && !probe_ready) {
+            fprintf(stderr, "Fehler: Ping konnte nicht gestartet werden\n");
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+            return 1;
+        }
+    }
+    
+    // Erste Probe sofort, danach im Sekundentakt (Mehrzielbetrieb: nur MyIP)
+    ev_timer_arm(tick_handler.fd, 0, fleet.count || attach_name ? PROBE_INTERVAL_US : probe_interval_us);
+    start_us = mono_us();
+    
+    last_success_time = time(NULL);
+
+    // Terminal vorbereiten und Cursor unsichtbar machen
+    if (!headless) {
+        printf("%s%s%s", ANSI_HOME, ANSI_CLEAR, ANSI_CURSOR_HIDE);
         fflush(stdout);
-        
-        usleep(100000);
+        ui_init();
+    }
+
+    // Schläft, bis Daten, Tasten, Timer oder Signale anliegen
+    while (running) {
+        if (dirty) publish_dirty = 1;
+        if (!headless) {
+            maybe_render();
+        } else {
+            if (status_msg[0]) {
+                // Meldungen der Statuszeile gehen nach stderr (Journal)
+                fprintf(stderr, "pingmon: %s\n", status_msg);
+                status_msg[0] = '\0';
+            }
+            dirty = 0;
+        }
+        maybe_publish();
+        if (emitter.error) break;
+        if (ev_run_once(&loop, -1) == -1) break;
     }
 
     // ========== SAUBERES BEENDEN ==========
-    printf("%s%s%s", ANSI_CURSOR_SHOW, ANSI_CLEAR, ANSI_HOME);
-    
-    // Ping-Prozess beenden
-    if (ping_pid > 0) {
-        kill(ping_pid, SIGTERM);
-        int status;
-        waitpid(ping_pid, &status, 0);  // Warten auf Beendigung
+    if (!headless) {
+        printf("%s%s%s", ANSI_CURSOR_SHOW, ANSI_CLEAR, ANSI_HOME);
+        fflush(stdout);
     }
     
-    close(pipefd[0]);
-    regfree(&re_time);
+    // ICMP-Socket schließen bzw. Ping-Prozess beenden
+    probe_close();
+    resolve_stop(&resolver);
+    path_stop(&path);
+    fleet_stop(&fleet);
+    metrics_close(&metrics);
+    myip_cancel(&myip);
+    emit_close(&emitter);
+    if (shm.writer) publish();      // Endstand für noch eingeblendete Leser
+    shm_close(&shm);
+    if (out_fd != STDOUT_FILENO) close(out_fd);
+    ev_close(&loop);
+    slog_close(&sample_log);
     tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
     
+    // Ausgabe ohne Oberfläche: Volumen und CPU-Kosten pro 1000 Probes
+    // (ganzer Prozess inkl. Worker bzw. nur der Thread mit der Ausgabe).
+    // Sonst bleibt ein normales Ende still, die Zähler liefert SIGUSR1
+    if (headless) {
+        if (emitter.error) {
+            fprintf(stderr, "pingmon: output: %s, %llu bytes dropped\n", strerror(emitter.error),
+                    (unsigned long long)emitter.dropped);
+        }
+        fprintf(stderr, "pingmon: %llu probes, %llu %s records, %llu bytes in %llu writes (%.0f bytes/write)\n",
+                (unsigned long long)emitter.probes, (unsigned long long)emitter.records,
+                emit_format_name(out_format), (unsigned long long)emitter.bytes,
+                (unsigned long long)emitter.writes,
+                emitter.writes ? (double)emitter.bytes / (double)emitter.writes : 0.0);
+        struct rusage ru_all, ru_main;
+        if (emitter.probes && getrusage(RUSAGE_SELF, &ru_all) == 0 && getrusage(RUSAGE_THREAD, &ru_main) == 0) {
+            double all_ms = (ru_all.ru_utime.tv_sec + ru_all.ru_stime.tv_sec) * 1e3 +
+                            (ru_all.ru_utime.tv_usec + ru_all.ru_stime.tv_usec) / 1e3;
+            double main_ms = (ru_main.ru_utime.tv_sec + ru_main.ru_stime.tv_sec) * 1e3 +
+                             (ru_main.ru_utime.tv_usec + ru_main.ru_stime.tv_usec) / 1e3;
+            fprintf(stderr, "pingmon: CPU %.3f ms per 1k probes (main thread %.3f ms), %.2f s CPU over %.1f s\n",
+                    all_ms * 1000.0 / (double)emitter.probes, main_ms * 1000.0 / (double)emitter.probes,
+                    all_ms / 1e3, (mono_us() - start_us) / 1e6);
+        }
+    }
+    
+    if (fleet.count) fleet_free(&fleet);
+    
     return 0;
 }
+#endif
@@ -0,0 +1,207 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Parser für die Textausgabe von ping(8) (siehe pingparse.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+#include "pingparse.h"
+
+#define RING_MASK (PING_RING_SIZE - 1)
+
+static const double pow10_neg[] = {
+    1.0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9
+};
+
+static inline int is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Ganzzahl ab p lesen, -1 wenn keine Ziffer folgt
+static int scan_uint(const char *p, const char *end) {
+    if (p >= end || !is_digit(*p)) return -1;
+    int v = 0;
+    while (p < end && is_digit(*p)) {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    return v;
+}
+
+// Dezimalzahl ohne Exponent ("12.345"), -1.0 wenn keine Ziffer folgt
+static double scan_decimal(const char *p, const char *end) {
+    if (p >= end || !is_digit(*p)) return -1.0;
+    uint64_t mant = 0;
+    int frac = 0;
+    while (p < end && is_digit(*p)) {
+        mant = mant * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && is_digit(*p)) {
+            if (frac < 9) {
+                mant = mant * 10 + (uint64_t)(*p - '0');
+                frac++;
+            }
+            p++;
+        }
+    }
+    return (double)mant * pow10_neg[frac];
+}
+
+// Endet der Text vor pos mit key (und steht davor kein Buchstabe)?
+static inline int key_before(const char *s, size_t pos, const char *key, size_t klen) {
+    if (pos < klen || memcmp(s + pos - klen, key, klen) != 0) return 0;
+    if (pos == klen) return 1;
+    char b = s[pos - klen - 1];
+    return !((b >= 'a' && b <= 'z') || b == '_');
+}
+
+PingLineKind ping_parse_line(const char *s, size_t len, PingLine *out) {
+    const char *end = s + len;
+    int have_time = 0;
+    int timeout = 0;
+
+    out->kind = PING_LINE_OTHER;
+    out->seq = -1;
+    out->ttl = -1;
+    out->rtt_ms = 0;
+    out->dup = 0;
+
+    // Ausfallmeldungen (macOS/BSD bzw. iputils mit -O)
+    if (len >= 15 && memcmp(s, "Request timeout", 15) == 0) timeout = 1;
+    else if (len >= 13 && memcmp(s, "no answer yet", 13) == 0) timeout = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+
+        if (c == '=' || c == '<') {
+            const char *v = s + i + 1;
+            if (key_before(s, i, "time", 4)) {
+                double t = scan_decimal(v, end);
+                if (t >= 0) {
+                    out->rtt_ms = t;
+                    have_time = 1;
+                }
+            } else if (c == '=' && key_before(s, i, "ttl", 3)) {
+                out->ttl = scan_uint(v, end);
+            } else if (c == '=' && (key_before(s, i, "icmp_seq", 8) ||
+                                    key_before(s, i, "icmp_req", 8) ||
+                                    key_before(s, i, "seq", 3))) {
+                out->seq = scan_uint(v, end);
+            }
+        } else if (c == ' ' && timeout && out->seq < 0 && key_before(s, i, "icmp_seq", 8)) {
+            // "Request timeout for icmp_seq 5"
+            out->seq = scan_uint(s + i + 1, end);
+        } else if (c == '(' && i + 6 <= len && memcmp(s + i, "(DUP!)", 6) == 0) {
+            out->dup = 1;
+        }
+    }
+
+    if (have_time) {
+        out->kind = PING_LINE_REPLY;
+    } else if (timeout) {
+        out->kind = PING_LINE_TIMEOUT;
+    } else if (out->seq >= 0 && len >= 5 && memcmp(s, "From ", 5) == 0) {
+        // "From 10.0.0.1 icmp_seq=3 Destination Host Unreachable"
+        out->kind = PING_LINE_TIMEOUT;
+    }
+
+    return out->kind;
+}
+
+void ping_reader_init(PingReader *r) {
+    memset(r, 0, sizeof(*r));
+}
+
+long ping_reader_fill(PingReader *r, int fd) {
+    size_t used = r->head - r->tail;
+    size_t space = PING_RING_SIZE - used;
+    if (space == 0) {
+        // Kann nur bei Zeilen ohne '\n' passieren: alles verwerfen
+        r->tail = r->scan = r->head;
+        space = PING_RING_SIZE;
+    }
+
+    // Nur bis zum Ringende lesen, der Rest folgt beim nächsten Aufruf
+    size_t pos = r->head & RING_MASK;
+    size_t chunk = PING_RING_SIZE - pos;
+    if (chunk > space) chunk = space;
+
+    ssize_t n = read(fd, r->ring + pos, chunk);
+    if (n > 0) {
+        r->head += (size_t)n;
+        r->reads++;
+        r->bytes += (uint64_t)n;
+    }
+    return (long)n;
+}
+
+int ping_reader_parse(PingReader *r, PingLine *out, int max) {
+    struct timespec t0, t1;
+    int count = 0;
+    uint64_t lines = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    while (count < max && r->scan < r->head) {
+        // Nach '\n' im zusammenhängenden Teil suchen
+        size_t pos = r->scan & RING_MASK;
+        size_t avail = r->head - r->scan;
+        if (avail > PING_RING_SIZE - pos) avail = PING_RING_SIZE - pos;
+
+        const char *nl = memchr(r->ring + pos, '\n', avail);
+        if (!nl) {
+            r->scan += avail;
+            // Überlange Zeile: Anfang verwerfen, Rest bis '\n' ebenfalls
+            if (r->scan - r->tail > PING_LINE_MAX) {
+                r->tail = r->scan;
+                r->discard = 1;
+            }
+            continue;
+        }
+
+        size_t line_end = r->scan + (size_t)(nl - (r->ring + pos));
+        size_t len = line_end - r->tail;
+        size_t start = r->tail & RING_MASK;
+
+        r->tail = r->scan = line_end + 1;
+        lines++;
+
+        if (r->discard) {
+            r->discard = 0;
+            continue;
+        }
+        if (len > PING_LINE_MAX) continue;
+
+        const char *line;
+        if (start + len <= PING_RING_SIZE) {
+            line = r->ring + start;   // Normalfall: direkt im Ring auswerten
+        } else {
+            size_t first = PING_RING_SIZE - start;
+            memcpy(r->scratch, r->ring + start, first);
+            memcpy(r->scratch + first, r->ring, len - first);
+            line = r->scratch;
+        }
+
+        if (len > 0 && line[len - 1] == '\r') len--;
+
+        if (ping_parse_line(line, len, &out[count]) != PING_LINE_OTHER) {
+            count++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    r->lines += lines;
+    r->parse_ns += (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL
+                 + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+
+    return count;
+}
@@ -0,0 +1,61 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Parser für die Textausgabe von ping(8): chunkweises Lesen in einen
+ * Ringpuffer und handgeschriebener Scanner ohne regex/atof.
+ */
+
+#ifndef PINGMON_PINGPARSE_H
+#define PINGMON_PINGPARSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Ringpuffergröße (Zweierpotenz)
+#define PING_RING_SIZE 65536
+// Längere Zeilen werden verworfen
+#define PING_LINE_MAX  512
+
+typedef enum {
+    PING_LINE_OTHER = 0,   // Kopfzeile, Statistik, Fehlermeldung ...
+    PING_LINE_REPLY,       // "64 bytes from ...: icmp_seq=1 ttl=57 time=12.3 ms"
+    PING_LINE_TIMEOUT      // "Request timeout for icmp_seq 5" / "no answer yet for icmp_seq=5"
+} PingLineKind;
+
+typedef struct {
+    PingLineKind kind;
+    int seq;               // -1 wenn unbekannt
+    int ttl;               // -1 wenn unbekannt
+    double rtt_ms;         // bei "time<1" die Obergrenze
+    int dup;               // "(DUP!)"
+} PingLine;
+
+typedef struct {
+    char ring[PING_RING_SIZE];
+    size_t head;           // Schreibposition (monoton wachsend)
+    size_t tail;           // Anfang der nächsten Zeile (monoton wachsend)
+    size_t scan;           // Bis hierhin wurde bereits nach '\n' gesucht
+    int discard;           // Rest einer überlangen Zeile überspringen
+    char scratch[PING_LINE_MAX];  // nur für Zeilen über die Ringgrenze
+
+    // Zähler für die Messung der Parse-Kosten
+    uint64_t reads;
+    uint64_t bytes;
+    uint64_t lines;
+    uint64_t parse_ns;
+} PingReader;
+
+// Eine einzelne Zeile (ohne '\n') auswerten. Rückgabe: kind
+PingLineKind ping_parse_line(const char *s, size_t len, PingLine *out);
+
+void ping_reader_init(PingReader *r);
+
+// Ein read() in den freien Teil des Rings. >0 Bytes, 0 EOF, -1 Fehler (errno)
+long ping_reader_fill(PingReader *r, int fd);
+
+// Bis zu max vollständige Zeilen auswerten, nur REPLY/TIMEOUT landen in out.
+// Rückgabe: Anzahl Einträge in out
+int ping_reader_parse(PingReader *r, PingLine *out, int max);
+
+#endif
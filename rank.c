@@ -0,0 +1,122 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Indizierter Max-Heap (siehe rank.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+
+#include "rank.h"
+
+// a steht vor b: größerer Schlüssel, bei Gleichstand kleinere Id
+static inline int before(const RankHeap *r, uint32_t a, uint32_t b) {
+    if (r->key[a] != r->key[b]) return r->key[a] > r->key[b];
+    return a < b;
+}
+
+static inline void place(RankHeap *r, uint32_t i, uint32_t id) {
+    r->heap[i] = id;
+    r->pos[id] = i;
+}
+
+static void sift_up(RankHeap *r, uint32_t i) {
+    uint32_t id = r->heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!before(r, id, r->heap[parent])) break;
+        place(r, i, r->heap[parent]);
+        i = parent;
+    }
+    place(r, i, id);
+}
+
+static void sift_down(RankHeap *r, uint32_t i) {
+    uint32_t id = r->heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= r->n) break;
+        if (child + 1 < r->n && before(r, r->heap[child + 1], r->heap[child])) child++;
+        if (!before(r, r->heap[child], id)) break;
+        place(r, i, r->heap[child]);
+        i = child;
+    }
+    place(r, i, id);
+}
+
+int rank_init(RankHeap *r, uint32_t n) {
+    r->n = n;
+    r->heap = malloc((n ? n : 1) * sizeof(*r->heap));
+    r->pos = malloc((n ? n : 1) * sizeof(*r->pos));
+    r->key = calloc(n ? n : 1, sizeof(*r->key));
+    if (!r->heap || !r->pos || !r->key) {
+        rank_free(r);
+        return -1;
+    }
+    // Alle Schlüssel gleich: aufsteigende Ids sind bereits ein gültiger Heap
+    for (uint32_t i = 0; i < n; i++) place(r, i, i);
+    return 0;
+}
+
+void rank_free(RankHeap *r) {
+    free(r->heap);
+    free(r->pos);
+    free(r->key);
+    r->heap = r->pos = NULL;
+    r->key = NULL;
+    r->n = 0;
+}
+
+void rank_set(RankHeap *r, uint32_t id, double key) {
+    if (id >= r->n) return;
+    double old = r->key[id];
+    r->key[id] = key;
+    if (key > old) sift_up(r, r->pos[id]);
+    else if (key < old) sift_down(r, r->pos[id]);
+}
+
+// Die größten k lesen: Kandidaten sind die Kinder bereits ausgegebener
+// Knoten, verwaltet in einem kleinen Hilfs-Heap über Heap-Indizes
+size_t rank_top(const RankHeap *r, uint32_t *out, size_t k) {
+    uint32_t cand[RANK_TOP_MAX + 1];
+    size_t ncand = 0, nout = 0;
+
+    if (k > RANK_TOP_MAX) k = RANK_TOP_MAX;
+    if (r->n == 0 || k == 0) return 0;
+    cand[ncand++] = 0;
+
+    while (nout < k && ncand > 0) {
+        // Besten Kandidaten entnehmen
+        uint32_t top = cand[0];
+        out[nout++] = r->heap[top];
+        cand[0] = cand[--ncand];
+        for (size_t i = 0;;) {
+            size_t c = 2 * i + 1;
+            if (c >= ncand) break;
+            if (c + 1 < ncand && before(r, r->heap[cand[c + 1]], r->heap[cand[c]])) c++;
+            if (!before(r, r->heap[cand[c]], r->heap[cand[i]])) break;
+            uint32_t t = cand[i];
+            cand[i] = cand[c];
+            cand[c] = t;
+            i = c;
+        }
+
+        // Seine Kinder aufnehmen (höchstens eins mehr als entnommen)
+        for (uint32_t c = 2 * top + 1; c <= 2 * top + 2 && c < r->n; c++) {
+            if (ncand > RANK_TOP_MAX) break;
+            size_t i = ncand++;
+            cand[i] = c;
+            while (i > 0) {
+                size_t parent = (i - 1) / 2;
+                if (!before(r, r->heap[cand[i]], r->heap[cand[parent]])) break;
+                uint32_t t = cand[i];
+                cand[i] = cand[parent];
+                cand[parent] = t;
+                i = parent;
+            }
+        }
+    }
+    return nout;
+}
@@ -0,0 +1,37 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Indizierter Max-Heap über n Einträge mit je einem Schlüssel: ein
+ * geänderter Schlüssel wird in O(log n) neu einsortiert, die k größten
+ * Einträge lassen sich in O(k log k) lesen, ohne den Heap zu verändern.
+ * Gleiche Schlüssel werden nach der kleineren Id geordnet, damit die
+ * Reihenfolge in der Anzeige nicht springt.
+ */
+
+#ifndef PINGMON_RANK_H
+#define PINGMON_RANK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RANK_TOP_MAX 256            // höchstens so viele Einträge pro rank_top
+
+typedef struct {
+    uint32_t *heap;          // heap[i] = Id
+    uint32_t *pos;           // pos[Id] = Index in heap
+    double *key;             // key[Id]
+    uint32_t n;
+} RankHeap;
+
+// n Einträge (Ids 0..n-1) mit Schlüssel 0 anlegen. 0 = OK, -1 = kein Speicher
+int rank_init(RankHeap *r, uint32_t n);
+void rank_free(RankHeap *r);
+
+// Schlüssel von id setzen, O(log n)
+void rank_set(RankHeap *r, uint32_t id, double key);
+
+// Die bis zu k Ids mit den größten Schlüsseln, absteigend. Rückgabe: Anzahl
+size_t rank_top(const RankHeap *r, uint32_t *out, size_t k);
+
+#endif
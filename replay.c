@@ -0,0 +1,249 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * pingmon-replay: wertet ein mit --log geschriebenes Sample-Log oder
+ * mitgeschnittene ping-Ausgabe offline aus
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "samplelog.h"
+#include "stats.h"
+#include "textlog.h"
+
+static void usage(FILE *out) {
+    fprintf(out,
+            "Usage: pingmon-replay [-a] LOGFILE\n"
+            "       pingmon-replay [-j N] [-w SEC] [-i SEC] PING_OUTPUT...\n"
+            "\n"
+            "  -a       Count all records, ignoring resets made with 'r'\n"
+            "  -j N     Worker threads for ping output (default: all CPUs)\n"
+            "  -w SEC   History interval for ping output, 0 = none\n"
+            "           (default: 60 s, widened to at most 60 lines)\n"
+            "  -i SEC   Probe interval of ping output without 'ping -D' timestamps\n"
+            "           (default 1)\n");
+}
+
+static double elapsed_s(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) + (double)(t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void format_time(int64_t ms, char *buf, size_t len) {
+    time_t t = (time_t)(ms / 1000);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+// Gemeinsamer Teil der Zusammenfassung (wie im Live-Fenster)
+static void print_stats(const LatencyStats *lat, uint64_t sent, uint64_t recv, double last) {
+    double loss = sent > 0 ? (double)(sent - recv) * 100.0 / (double)sent : 0.0;
+
+    printf("Sent:        %llu\n", (unsigned long long)sent);
+    printf("Recv:        %llu\n", (unsigned long long)recv);
+    printf("Loss:        %.1f%%\n", loss);
+    printf("Last:        %.1f ms\n", last);
+    printf("Avg:         %.1f ms\n", lat->mean);
+    printf("Min/Max:     %.1f / %.1f ms\n", lat->min, lat->max);
+    printf("P50/P95/P99: %.1f / %.1f / %.1f ms\n",
+           lat_percentile(lat, 50), lat_percentile(lat, 95), lat_percentile(lat, 99));
+    printf("StdDev:      %.1f ms\n", lat_stddev(lat));
+    printf("Jitter:      %.1f ms\n", lat->jitter);
+    printf("Quality:     %.0f%%\n", recv > 0 ? calculate_quality(last) : 0.0);
+    printf("Stability:   %.0f%%\n", calculate_stability(loss));
+}
+
+static void print_history(const TextLogSummary *s) {
+    printf("\nHistory (%g s per line%s):\n", (double)s->bin_us / 1e6,
+           s->timed ? "" : ", from probe position");
+    for (size_t i = 0; i < s->nbins; i++) {
+        const RollupBucket *b = &s->bins[i];
+        uint64_t sent = (uint64_t)b->recv + b->lost;
+        if (sent == 0) continue;
+
+        int64_t start_us = (s->first_bin + (int64_t)i) * s->bin_us;
+        char when[32];
+        if (s->timed) {
+            format_time(start_us / 1000, when, sizeof(when));
+        } else {
+            int64_t sec = start_us / 1000000;
+            snprintf(when, sizeof(when), "+%02lld:%02lld:%02lld",
+                     (long long)(sec / 3600), (long long)(sec / 60 % 60), (long long)(sec % 60));
+        }
+        printf("  %-19s  sent %6llu  loss %5.1f%%", when, (unsigned long long)sent,
+               (double)b->lost * 100.0 / (double)sent);
+        if (b->recv > 0) {
+            printf("  avg %7.1f  min %7.1f  max %7.1f ms", rollup_avg(b), b->min, b->max);
+        }
+        printf("\n");
+    }
+}
+
+// Mitgeschnittene ping-Ausgabe, parallel über alle Dateien
+static int replay_text(char *const paths[], int n, int threads, double bin_s, int max_bins,
+                       double interval_s) {
+    static TextLogSummary s;
+    s.threads = threads;
+    s.bin_us = (int64_t)(bin_s * 1e6);
+    s.max_bins = max_bins;
+    s.interval_us = (int64_t)(interval_s * 1e6);
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (tlog_analyze(&s, paths, n) == -1) {
+        fprintf(stderr, "Fehler: %s: %s\n", s.failed ? s.failed : "analyze", strerror(errno));
+        return 1;
+    }
+    double scan_s = elapsed_s(&t0);
+
+    printf("Files:       %llu (%.1f MB, %llu lines, %llu chunks)\n", (unsigned long long)s.files,
+           (double)s.bytes / 1e6, (unsigned long long)s.lines, (unsigned long long)s.chunks);
+    if (s.timed) {
+        char from[32], to[32];
+        format_time(s.first_us / 1000, from, sizeof(from));
+        format_time(s.last_us / 1000, to, sizeof(to));
+        printf("Span:        %s .. %s (%.0f s)\n", from, to, (double)(s.last_us - s.first_us) / 1e6);
+    } else {
+        printf("Span:        ~%.0f s (no timestamps, %g s probe interval assumed)\n",
+               (double)s.sent * interval_s, interval_s);
+    }
+    printf("\n");
+    print_stats(&s.lat, s.sent, s.recv, s.last);
+    printf("Timeouts:    %llu reported, %llu missing icmp_seq\n",
+           (unsigned long long)s.timeouts, (unsigned long long)s.gaps);
+    printf("Dup/Late:    %llu / %llu\n", (unsigned long long)s.dups, (unsigned long long)s.late);
+    if (s.nbins > 0) print_history(&s);
+    printf("\n");
+    printf("Scanned %.1f MB in %.3f s (%.0f MB/s, %d threads, %d pass%s)\n",
+           (double)s.bytes / 1e6, scan_s, scan_s > 0 ? (double)s.bytes / scan_s / 1e6 : 0.0,
+           s.threads, s.passes, s.passes > 1 ? "es" : "");
+
+    tlog_free(&s);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int all = 0;
+    int threads = 0;
+    double bin_s = 60, interval_s = 1;
+    int max_bins = 60;
+    char *end;
+    int opt;
+    while ((opt = getopt(argc, argv, "aj:w:i:h")) != -1) {
+        switch (opt) {
+        case 'a':
+            all = 1;
+            break;
+        case 'j':
+            threads = (int)strtol(optarg, &end, 10);
+            if (*end || threads < 1) {
+                fprintf(stderr, "Fehler: ungültige Thread-Anzahl: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'w':
+            bin_s = strtod(optarg, &end);
+            if (*end || bin_s < 0) {
+                fprintf(stderr, "Fehler: ungültiges Intervall: %s\n", optarg);
+                return 1;
+            }
+            max_bins = 0;
+            break;
+        case 'i':
+            interval_s = strtod(optarg, &end);
+            if (*end || interval_s <= 0) {
+                fprintf(stderr, "Fehler: ungültiges Intervall: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(stderr);
+        return 1;
+    }
+
+    // Kein (einzelnes) pingmon-Log: als ping-Ausgabe auswerten
+    if (optind != argc - 1) return replay_text(argv + optind, argc - optind, threads, bin_s, max_bins, interval_s);
+
+    const char *path = argv[optind];
+    SampleLog log;
+    int rc = slog_open_read(&log, path);
+    if (rc == -2) return replay_text(argv + optind, 1, threads, bin_s, max_bins, interval_s);
+    if (rc == -1) {
+        fprintf(stderr, "Fehler: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    static LatencyStats lat;
+    lat_reset(&lat);
+    uint64_t sent = 0, recv = 0, resets = 0;
+    double last = 0;
+    int64_t first_ms = 0, last_ms = 0;
+
+    for (uint64_t i = 0; i < log.count; i++) {
+        const SampleRecord *r = slog_record(&log, i);
+        if (r->flags & SLOG_RESET) {
+            resets++;
+            if (!all) {
+                lat_reset(&lat);
+                sent = recv = 0;
+                last = 0;
+                first_ms = 0;
+            }
+            continue;
+        }
+        if (first_ms == 0) first_ms = r->ts_ms;
+        last_ms = r->ts_ms;
+        sent++;
+        if (r->flags & SLOG_LOST) continue;
+        recv++;
+        last = r->rtt_us / 1000.0;
+        lat_add(&lat, last);
+    }
+
+    double scan_s = elapsed_s(&t0);
+
+    char from[32] = "-", to[32] = "-";
+    double span_s = 0;
+    if (sent > 0) {
+        span_s = (double)(last_ms - first_ms) / 1000.0;
+        format_time(first_ms, from, sizeof(from));
+        format_time(last_ms, to, sizeof(to));
+    }
+
+    printf("Log:         %s\n", path);
+    printf("Target:      %.*s\n", (int)sizeof(log.hdr->target), log.hdr->target);
+    printf("Thresholds:  warn %.0f ms, crit %.0f ms\n", log.hdr->warn, log.hdr->crit);
+    printf("Records:     %llu (%llu resets%s)\n", (unsigned long long)log.count,
+           (unsigned long long)resets, all ? ", ignored" : "");
+    printf("Span:        %s .. %s (%.0f s)\n", from, to, span_s);
+    printf("\n");
+    print_stats(&lat, sent, recv, last);
+    printf("\n");
+    printf("Scanned %llu records in %.3f ms (%.1f M records/s)\n",
+           (unsigned long long)log.count, scan_s * 1000.0,
+           scan_s > 0 ? (double)log.count / scan_s / 1e6 : 0.0);
+
+    slog_close(&log);
+    return 0;
+}
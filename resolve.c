@@ -0,0 +1,178 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Asynchrone Namensauflösung mit TTL (siehe resolve.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "resolve.h"
+#include "icmp.h"
+
+static int same_addr(const ResolveAddr *a, const ResolveAddr *b) {
+    if (a->sa.sa_family != b->sa.sa_family) return 0;
+    if (a->sa.sa_family == AF_INET) return a->in.sin_addr.s_addr == b->in.sin_addr.s_addr;
+    return memcmp(&a->in6.sin6_addr, &b->in6.sin6_addr, sizeof(a->in6.sin6_addr)) == 0;
+}
+
+static void addr_to_str(const ResolveAddr *a, char *buf, size_t size) {
+    if (a->sa.sa_family == AF_INET6) inet_ntop(AF_INET6, &a->in6.sin6_addr, buf, (socklen_t)size);
+    else inet_ntop(AF_INET, &a->in.sin_addr, buf, (socklen_t)size);
+}
+
+int resolve_numeric(const char *name, int family, ResolveAddr *out) {
+    memset(out, 0, sizeof(*out));
+    if (family != AF_INET6 && inet_pton(AF_INET, name, &out->in.sin_addr) == 1) {
+        out->in.sin_family = AF_INET;
+        return 0;
+    }
+    if (family != AF_INET && inet_pton(AF_INET6, name, &out->in6.sin6_addr) == 1) {
+        out->in6.sin6_family = AF_INET6;
+        return 0;
+    }
+    return -1;
+}
+
+// Läuft im eigenen Thread; schreibt nur found/nfound/gai_error
+static void *lookup_thread(void *arg) {
+    Resolver *r = arg;
+    struct addrinfo hints = {0}, *res = NULL;
+    hints.ai_family = r->family;
+    hints.ai_socktype = SOCK_DGRAM;          // ein Eintrag pro Adresse
+
+    r->nfound = 0;
+    r->gai_error = getaddrinfo(r->name, NULL, &hints, &res);
+    if (r->gai_error == 0) {
+        for (struct addrinfo *ai = res; ai && r->nfound < RESOLVE_ADDRS; ai = ai->ai_next) {
+            if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6) continue;
+            ResolveAddr *a = &r->found[r->nfound++];
+            memset(a, 0, sizeof(*a));
+            memcpy(a, ai->ai_addr, ai->ai_addrlen < sizeof(*a) ? ai->ai_addrlen : sizeof(*a));
+        }
+        freeaddrinfo(res);
+        if (r->nfound == 0) r->gai_error = EAI_NONAME;
+    }
+
+    uint64_t one = 1;
+    while (write(r->h.fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+    return NULL;
+}
+
+static void start_lookup(Resolver *r, int64_t now_us) {
+    if (r->busy) return;
+    r->started_us = now_us;
+    if (pthread_create(&r->thread, NULL, lookup_thread, r) != 0) {
+        // Später erneut versuchen
+        r->error = EAI_SYSTEM;
+        r->expires_us = now_us + (int64_t)r->neg_ttl_s * 1000000;
+        return;
+    }
+    r->busy = 1;
+}
+
+// Neue Ergebnisse übernehmen: aktuelle Adresse behalten, solange sie dabei ist
+static void apply(Resolver *r, int64_t now_us) {
+    r->lookups++;
+    r->last_lookup_us = now_us - r->started_us;
+    if (r->gai_error) {
+        r->error = r->gai_error;
+        r->expires_us = now_us + (int64_t)r->neg_ttl_s * 1000000;
+        return;
+    }
+    r->error = 0;
+    r->expires_us = now_us + (int64_t)r->ttl_s * 1000000;
+
+    if (r->has_addr) {
+        for (int i = 0; i < r->nfound; i++) {
+            if (same_addr(&r->addr, &r->found[i])) return;
+        }
+    }
+
+    char old[INET6_ADDRSTRLEN];
+    int had = r->has_addr;
+    memcpy(old, r->addr_str, sizeof(old));
+    r->addr = r->found[0];
+    r->has_addr = 1;
+    addr_to_str(&r->addr, r->addr_str, sizeof(r->addr_str));
+    if (had) r->changes++;
+    if (r->on_change) r->on_change(had ? old : NULL, r->addr_str);
+}
+
+static void on_resolved(EvHandler *h, uint32_t events) {
+    (void)events;
+    Resolver *r = h->ctx;
+    uint64_t n;
+    if (read(h->fd, &n, sizeof(n)) != sizeof(n) || !r->busy) return;
+
+    pthread_join(r->thread, NULL);
+    r->busy = 0;
+    apply(r, mono_us());
+    if (r->on_update) r->on_update();
+}
+
+int resolve_start(Resolver *r, EvLoop *loop, const char *name, int family, int ttl_s) {
+    void (*on_change)(const char *, const char *) = r->on_change;
+    void (*on_update)(void) = r->on_update;
+    memset(r, 0, sizeof(*r));
+    r->on_change = on_change;
+    r->on_update = on_update;
+    r->loop = loop;
+    r->h.fd = -1;
+    r->family = family;
+    r->ttl_s = ttl_s > 0 ? ttl_s : RESOLVE_DEFAULT_TTL;
+    r->neg_ttl_s = RESOLVE_NEG_TTL;
+    snprintf(r->name, sizeof(r->name), "%s", name);
+
+    // Adressliteral: kein DNS, gilt für immer
+    if (resolve_numeric(name, family, &r->addr) == 0) {
+        r->has_addr = 1;
+        r->expires_us = INT64_MAX;
+        addr_to_str(&r->addr, r->addr_str, sizeof(r->addr_str));
+        if (r->on_change) r->on_change(NULL, r->addr_str);
+        return 0;
+    }
+
+    r->h.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r->h.fd == -1) return -1;
+    r->h.cb = on_resolved;
+    r->h.ctx = r;
+    if (ev_add(loop, &r->h, EPOLLIN) == -1) {
+        int err = errno;
+        close(r->h.fd);
+        r->h.fd = -1;
+        errno = err;
+        return -1;
+    }
+    start_lookup(r, mono_us());
+    return 0;
+}
+
+void resolve_tick(Resolver *r, int64_t now_us) {
+    if (r->loop && r->h.fd >= 0 && !r->busy && now_us >= r->expires_us) start_lookup(r, now_us);
+}
+
+void resolve_stop(Resolver *r) {
+    if (!r->loop) return;
+    if (r->h.fd >= 0) {
+        ev_del(r->loop, &r->h);
+        if (r->busy) {
+            // Der Thread schreibt noch ins eventfd: offen lassen
+            pthread_detach(r->thread);
+            r->busy = 0;
+        } else {
+            close(r->h.fd);
+            r->h.fd = -1;
+        }
+    }
+    r->loop = NULL;
+}
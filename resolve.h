@@ -0,0 +1,84 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Asynchrone Namensauflösung für das Ziel: getaddrinfo (also auch
+ * /etc/hosts und nsswitch) läuft in einem eigenen Thread, das Ergebnis
+ * kommt über ein eventfd in den Eventloop. Probe- und Render-Takt warten
+ * nie auf DNS.
+ *
+ * getaddrinfo liefert keine DNS-TTL; die Adresse gilt daher ttl_s Sekunden
+ * und wird danach im Hintergrund erneut aufgelöst (Fehlschläge nach
+ * neg_ttl_s). Bis dahin und bei Fehlern bleibt die letzte Adresse gültig.
+ * Solange die aktuelle Adresse unter den Ergebnissen ist, wird sie
+ * beibehalten, damit Round-Robin-DNS nicht als Adresswechsel zählt.
+ */
+
+#ifndef PINGMON_RESOLVE_H
+#define PINGMON_RESOLVE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "evloop.h"
+
+#define RESOLVE_NAME_MAX   256
+#define RESOLVE_ADDRS      8        // betrachtete Ergebnisse pro Abfrage
+#define RESOLVE_DEFAULT_TTL 60      // Sekunden
+#define RESOLVE_NEG_TTL    5        // Sekunden bis zum nächsten Versuch nach einem Fehler
+
+typedef union {
+    struct sockaddr sa;
+    struct sockaddr_in in;
+    struct sockaddr_in6 in6;
+} ResolveAddr;
+
+typedef struct {
+    EvLoop *loop;
+    EvHandler h;             // eventfd, meldet das Ende des Threads
+    char name[RESOLVE_NAME_MAX];
+    int family;              // AF_UNSPEC, AF_INET oder AF_INET6 (-4/-6)
+    int ttl_s;
+    int neg_ttl_s;
+
+    pthread_t thread;
+    int busy;                // Thread läuft
+    int64_t started_us;
+
+    // Vom Thread geschrieben, nach dem eventfd gelesen
+    ResolveAddr found[RESOLVE_ADDRS];
+    int nfound;
+    int gai_error;
+
+    ResolveAddr addr;        // aktuelle Adresse, nur gültig mit has_addr
+    int has_addr;
+    char addr_str[INET6_ADDRSTRLEN];
+    int error;               // letzter getaddrinfo-Fehler (EAI_*), 0 = OK
+    int64_t expires_us;      // nächste Auflösung fällig
+
+    uint64_t lookups;
+    uint64_t changes;        // Adresswechsel nach der ersten Auflösung
+    int64_t last_lookup_us;  // Dauer der letzten Abfrage
+
+    // Neue Adresse (erste oder geänderte); old = NULL bei der ersten
+    void (*on_change)(const char *old_addr, const char *new_addr);
+    void (*on_update)(void); // nach jeder Abfrage, auch bei Fehlern
+} Resolver;
+
+// Numerische Adresse (IPv4/IPv6) ohne DNS parsen. 0 = OK, -1 = kein Literal
+int resolve_numeric(const char *name, int family, ResolveAddr *out);
+
+// Auflösung von name starten; danach selbständig nach TTL erneuern.
+// 0 = OK, -1 = Fehler (errno)
+int resolve_start(Resolver *r, EvLoop *loop, const char *name, int family, int ttl_s);
+
+// Aus dem Sekundentakt: abgelaufene Adresse erneut auflösen
+void resolve_tick(Resolver *r, int64_t now_us);
+
+// Handler abmelden. Ein hängendes getaddrinfo lässt sich nicht abbrechen,
+// der Thread wird dann beim Beenden zurückgelassen
+void resolve_stop(Resolver *r);
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Mehrstufige History (siehe rollup.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+
+#include "rollup.h"
+
+static void tier_setup(RollupTier *t, const char *label, int64_t width_us,
+                       int cap, RollupBucket *buckets) {
+    t->label = label;
+    t->width_us = width_us;
+    t->cap = cap;
+    t->head = cap - 1;
+    t->slot = -1;
+    t->filled = 0;
+    t->buckets = buckets;
+}
+
+void rollup_init(Rollups *r, int64_t raw_width_us) {
+    memset(r->pool, 0, sizeof(r->pool));
+
+    RollupBucket *p = r->pool;
+    tier_setup(&r->tiers[TIER_RAW], raw_width_us ? "Frame" : "Raw", raw_width_us, ROLLUP_CAP_RAW, p);
+    p += ROLLUP_CAP_RAW;
+    tier_setup(&r->tiers[TIER_10S], "10s", 10000000LL, ROLLUP_CAP_10S, p);
+    p += ROLLUP_CAP_10S;
+    tier_setup(&r->tiers[TIER_1M], "1m", 60000000LL, ROLLUP_CAP_1M, p);
+    p += ROLLUP_CAP_1M;
+    tier_setup(&r->tiers[TIER_10M], "10m", 600000000LL, ROLLUP_CAP_10M, p);
+}
+
+// Um n Einträge weiterschalten; übersprungene Zeitfenster bleiben leer
+static void tier_advance(RollupTier *t, int64_t n) {
+    if (n > t->cap) n = t->cap;
+    for (int64_t i = 0; i < n; i++) {
+        t->head = (t->head + 1) % t->cap;
+        memset(&t->buckets[t->head], 0, sizeof(RollupBucket));
+    }
+    t->filled += (uint64_t)n;
+    if (t->filled > (uint64_t)t->cap) t->filled = (uint64_t)t->cap;
+}
+
+static inline void bucket_add(RollupBucket *b, double rtt_ms) {
+    if (rtt_ms <= 0) {
+        b->lost++;
+        return;
+    }
+    float v = (float)rtt_ms;
+    if (b->recv == 0 || v < b->min) b->min = v;
+    if (b->recv == 0 || v > b->max) b->max = v;
+    b->sum += v;
+    b->recv++;
+}
+
+void rollup_add(Rollups *r, int64_t now_us, double rtt_ms) {
+    for (int i = 0; i < ROLLUP_TIERS; i++) {
+        RollupTier *t = &r->tiers[i];
+
+        if (t->width_us == 0) {
+            tier_advance(t, 1);
+        } else {
+            int64_t slot = now_us / t->width_us;
+            if (t->slot < 0) {
+                tier_advance(t, 1);
+            } else if (slot > t->slot) {
+                tier_advance(t, slot - t->slot);
+            }
+            if (slot > t->slot) t->slot = slot;
+        }
+
+        bucket_add(&t->buckets[t->head], rtt_ms);
+    }
+}
+
+const RollupBucket *rollup_at(const Rollups *r, int tier, int age) {
+    const RollupTier *t = &r->tiers[tier];
+    if (age < 0 || (uint64_t)age >= t->filled) return NULL;
+    return &t->buckets[(t->head - age + t->cap) % t->cap];
+}
+
+void rollup_restore(Rollups *r, int tier, const RollupBucket *newest, int n) {
+    RollupTier *t = &r->tiers[tier];
+    if (n < 0) n = 0;
+    if (n > t->cap) n = t->cap;
+    t->head = t->cap - 1;
+    t->filled = (uint64_t)n;
+    for (int age = 0; age < n; age++) t->buckets[t->head - age] = newest[age];
+}
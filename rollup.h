@@ -0,0 +1,70 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Mehrstufige History: Rohwerte pro Probe sowie 10s-, 1min- und 10min-
+ * Verdichtungen (min/avg/max/Verlust), inkrementell pro Sample aktualisiert.
+ */
+
+#ifndef PINGMON_ROLLUP_H
+#define PINGMON_ROLLUP_H
+
+#include <stdint.h>
+
+typedef enum {
+    TIER_RAW = 0,
+    TIER_10S,
+    TIER_1M,
+    TIER_10M,
+    ROLLUP_TIERS
+} RollupTierId;
+
+// Kapazitäten: 240 Probes, 1 h, 8 h, 3 Tage
+#define ROLLUP_CAP_RAW 240
+#define ROLLUP_CAP_10S 360
+#define ROLLUP_CAP_1M  480
+#define ROLLUP_CAP_10M 432
+#define ROLLUP_POOL (ROLLUP_CAP_RAW + ROLLUP_CAP_10S + ROLLUP_CAP_1M + ROLLUP_CAP_10M)
+
+typedef struct {
+    float min;               // ms, nur gültig wenn recv > 0
+    float max;
+    double sum;
+    uint32_t recv;           // 32 bit: 10 min bei 1 ms Takt sind 600000 Probes
+    uint32_t lost;
+} RollupBucket;
+
+typedef struct {
+    const char *label;       // für die Anzeige, z. B. "10s"
+    int64_t width_us;        // 0 = jede Probe ein Eintrag
+    int cap;
+    int head;                // Index des aktuellen (neuesten) Eintrags
+    int64_t slot;            // Zeitfenster des aktuellen Eintrags
+    uint64_t filled;         // Anzahl je belegter Einträge
+    RollupBucket *buckets;
+} RollupTier;
+
+typedef struct {
+    RollupTier tiers[ROLLUP_TIERS];
+    RollupBucket pool[ROLLUP_POOL];
+} Rollups;
+
+// raw_width_us = 0: ein Roheintrag pro Probe, sonst pro Zeitfenster
+// (Schnellmodus: ein Eintrag pro Render-Frame)
+void rollup_init(Rollups *r, int64_t raw_width_us);
+
+// Ein Sample in alle Stufen eintragen, O(1). rtt_ms <= 0 = verloren
+void rollup_add(Rollups *r, int64_t now_us, double rtt_ms);
+
+// Eintrag der Stufe; age 0 = neuester. NULL wenn nicht (mehr) vorhanden
+const RollupBucket *rollup_at(const Rollups *r, int tier, int age);
+
+// Stufe aus einer Kopie neu belegen (--attach): newest[0] ist der neueste
+// Eintrag, n wird auf die Kapazität begrenzt
+void rollup_restore(Rollups *r, int tier, const RollupBucket *newest, int n);
+
+static inline double rollup_avg(const RollupBucket *b) {
+    return b->recv > 0 ? b->sum / b->recv : 0.0;
+}
+
+#endif
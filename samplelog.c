@@ -0,0 +1,198 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Append-only Sample-Log (siehe samplelog.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "samplelog.h"
+
+#define CHECKED_BYTES offsetof(SampleRecord, check)
+
+// FNV-1a; 0 ist für "leer" reserviert
+static uint32_t record_check(const SampleRecord *r) {
+    const uint8_t *p = (const uint8_t *)r;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < CHECKED_BYTES; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static inline int record_valid(const SampleRecord *r) {
+    return r->check != 0 && r->check == record_check(r);
+}
+
+static int map_file(SampleLog *log, size_t size) {
+    int prot = log->readonly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void *map = mmap(NULL, size, prot, MAP_SHARED, log->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    log->map = map;
+    log->map_size = size;
+    log->cap = (size - SLOG_HEADER_SIZE) / sizeof(SampleRecord);
+    log->hdr = (const SampleLogHeader *)map;
+    return 0;
+}
+
+static int check_header(const SampleLog *log) {
+    const SampleLogHeader *h = log->hdr;
+    if (memcmp(h->magic, SLOG_MAGIC, sizeof(h->magic)) != 0) return -1;
+    if (h->version != SLOG_VERSION) return -1;
+    if (h->header_size != SLOG_HEADER_SIZE) return -1;
+    if (h->record_size != sizeof(SampleRecord)) return -1;
+    return 0;
+}
+
+// Gültige Datensätze zählen; ein abgerissener Rest am Ende wird ignoriert
+static void scan_tail(SampleLog *log) {
+    uint64_t i = 0;
+    while (i < log->cap && record_valid(slog_record(log, i))) i++;
+    log->count = i;
+}
+
+static int open_common(SampleLog *log, const char *path, int readonly) {
+    memset(log, 0, sizeof(*log));
+    log->readonly = readonly;
+    log->fd = open(path, (readonly ? O_RDONLY : O_RDWR | O_CREAT) | O_CLOEXEC, 0644);
+    return log->fd < 0 ? -1 : 0;
+}
+
+int slog_open(SampleLog *log, const char *path, const char *target, double warn, double crit) {
+    if (open_common(log, path, 0) == -1) return -1;
+
+    struct stat st;
+    if (fstat(log->fd, &st) == -1) goto fail;
+
+    if (st.st_size == 0) {
+        // Neue Datei: Header schreiben, erster Wachstumsschritt
+        if (ftruncate(log->fd, SLOG_HEADER_SIZE + SLOG_GROW_BYTES) == -1) goto fail;
+        if (map_file(log, SLOG_HEADER_SIZE + SLOG_GROW_BYTES) == -1) goto fail;
+
+        SampleLogHeader *h = (SampleLogHeader *)log->map;
+        memcpy(h->magic, SLOG_MAGIC, sizeof(h->magic));
+        h->version = SLOG_VERSION;
+        h->header_size = SLOG_HEADER_SIZE;
+        h->record_size = sizeof(SampleRecord);
+        h->created_ms = 0;
+        h->warn = warn;
+        h->crit = crit;
+        strncpy(h->target, target, sizeof(h->target) - 1);
+        return 0;
+    }
+
+    if ((size_t)st.st_size < SLOG_HEADER_SIZE + sizeof(SampleRecord)) {
+        slog_close(log);
+        return -2;
+    }
+    if (map_file(log, (size_t)st.st_size) == -1) goto fail;
+
+    // Gespeichert ist der Name auf sizeof - 1 gekürzt, verglichen wird ebenso
+    if (check_header(log) == -1 || strncmp(log->hdr->target, target, sizeof(log->hdr->target) - 1) != 0) {
+        slog_close(log);
+        return -2;
+    }
+
+    // Schwellwerte der aktuellen Sitzung übernehmen
+    SampleLogHeader *h = (SampleLogHeader *)log->map;
+    h->warn = warn;
+    h->crit = crit;
+
+    scan_tail(log);
+    return 0;
+
+fail:
+    slog_close(log);
+    return -1;
+}
+
+int slog_open_read(SampleLog *log, const char *path) {
+    if (open_common(log, path, 1) == -1) return -1;
+
+    struct stat st;
+    if (fstat(log->fd, &st) == -1) {
+        slog_close(log);
+        return -1;
+    }
+    if ((size_t)st.st_size < SLOG_HEADER_SIZE + sizeof(SampleRecord)) {
+        slog_close(log);
+        return -2;
+    }
+    if (map_file(log, (size_t)st.st_size) == -1) {
+        slog_close(log);
+        return -1;
+    }
+    if (check_header(log) == -1) {
+        slog_close(log);
+        return -2;
+    }
+
+    madvise(log->map, log->map_size, MADV_SEQUENTIAL);
+    scan_tail(log);
+    return 0;
+}
+
+void slog_close(SampleLog *log) {
+    if (log->map) munmap(log->map, log->map_size);
+    if (log->fd >= 0) close(log->fd);
+    log->map = NULL;
+    log->hdr = NULL;
+    log->fd = -1;
+}
+
+static int grow(SampleLog *log) {
+    size_t size = log->map_size + SLOG_GROW_BYTES;
+    if (ftruncate(log->fd, (off_t)size) == -1) return -1;
+
+    void *map = mremap(log->map, log->map_size, size, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED) return -1;
+    log->map = map;
+    log->map_size = size;
+    log->cap = (size - SLOG_HEADER_SIZE) / sizeof(SampleRecord);
+    log->hdr = (const SampleLogHeader *)map;
+    return 0;
+}
+
+static int append_record(SampleLog *log, SampleRecord *r) {
+    if (!log->map || log->readonly) return -1;
+    if (log->count == log->cap && grow(log) == -1) return -1;
+
+    r->check = record_check(r);
+
+    SampleLogHeader *h = (SampleLogHeader *)log->map;
+    if (h->created_ms == 0) h->created_ms = r->ts_ms;
+
+    memcpy((SampleRecord *)(log->map + SLOG_HEADER_SIZE) + log->count, r, sizeof(*r));
+    log->count++;
+    return 0;
+}
+
+int slog_append(SampleLog *log, int64_t ts_ms, double rtt_ms, int seq, int ttl) {
+    SampleRecord r = {0};
+    r.ts_ms = ts_ms;
+    if (rtt_ms > 0) {
+        double us = rtt_ms * 1000.0 + 0.5;
+        r.rtt_us = us >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    } else {
+        r.flags |= SLOG_LOST;
+    }
+    r.seq = (uint16_t)(seq < 0 ? 0 : seq);
+    r.ttl = (uint8_t)(ttl < 0 ? 0 : ttl);
+    return append_record(log, &r);
+}
+
+int slog_append_reset(SampleLog *log, int64_t ts_ms) {
+    SampleRecord r = {0};
+    r.ts_ms = ts_ms;
+    r.flags = SLOG_RESET;
+    return append_record(log, &r);
+}
@@ -0,0 +1,77 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Append-only Sample-Log: Header mit Ziel und Schwellwerten, danach
+ * Datensätze fester Größe. Die Datei wird per mmap beschrieben und in
+ * Schritten von SLOG_GROW_BYTES vergrößert. Jeder Datensatz trägt eine
+ * Prüfsumme; beim Öffnen endet das Log am ersten ungültigen Datensatz
+ * (abgeschnittener Schreibvorgang nach Absturz).
+ */
+
+#ifndef PINGMON_SAMPLELOG_H
+#define PINGMON_SAMPLELOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLOG_MAGIC       "PMONLOG1"
+#define SLOG_VERSION     1
+#define SLOG_HEADER_SIZE 256
+#define SLOG_GROW_BYTES  (1 << 20)
+
+#define SLOG_LOST  0x01
+#define SLOG_RESET 0x02      // Statistik wurde mit 'r' zurückgesetzt (kein Sample)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t reserved;
+    int64_t created_ms;
+    double warn;
+    double crit;
+    char target[64];
+} SampleLogHeader;
+
+typedef struct {
+    int64_t ts_ms;           // Wanduhr, Millisekunden seit Epoch
+    uint32_t rtt_us;         // 0 bei SLOG_LOST
+    uint16_t seq;
+    uint8_t ttl;             // 0 = unbekannt
+    uint8_t flags;
+    uint32_t reserved;
+    uint32_t check;          // Prüfsumme über die Felder davor, nie 0
+} SampleRecord;
+
+typedef struct {
+    int fd;
+    int readonly;
+    uint8_t *map;
+    size_t map_size;
+    uint64_t count;          // gültige Datensätze
+    uint64_t cap;            // Platz in der aktuellen Dateigröße
+    const SampleLogHeader *hdr;
+} SampleLog;
+
+// Zum Anhängen öffnen bzw. anlegen. 0 = OK, -1 = Fehler (errno),
+// -2 = Datei gehört zu einem anderen Ziel oder hat ein fremdes Format
+int slog_open(SampleLog *log, const char *path, const char *target, double warn, double crit);
+
+// Nur lesend öffnen (pingmon-replay). 0 = OK, -1 = Fehler, -2 = fremdes Format
+int slog_open_read(SampleLog *log, const char *path);
+
+void slog_close(SampleLog *log);
+
+// Datensatz anhängen, Prüfsumme wird gesetzt. 0 = OK, -1 = Fehler
+int slog_append(SampleLog *log, int64_t ts_ms, double rtt_ms, int seq, int ttl);
+
+// Reset-Marke anhängen, damit ein Neustart ab hier weiterzählt
+int slog_append_reset(SampleLog *log, int64_t ts_ms);
+
+static inline const SampleRecord *slog_record(const SampleLog *log, uint64_t i) {
+    return (const SampleRecord *)(log->map + SLOG_HEADER_SIZE) + i;
+}
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Off-Screen-Framebuffer mit Differenz-Ausgabe (siehe screen.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+
+#include "screen.h"
+
+#define MAX_COLORS 64
+// Unveränderte Zellen bis zu dieser Länge neu ausgeben statt Cursor setzen
+#define MAX_REPRINT_GAP 4
+#define OUT_SIZE (SCREEN_ROWS * SCREEN_COLS * 32)
+
+typedef struct {
+    char g[4];               // UTF-8-Glyphe, mit 0 aufgefüllt
+    uint8_t attr;            // Index in colors[]
+    uint8_t pad[3];
+} Cell;
+
+static Cell cur[SCREEN_ROWS][SCREEN_COLS];
+static Cell prev[SCREEN_ROWS][SCREEN_COLS];
+static int nrows = SCREEN_ROWS, ncols = SCREEN_COLS;
+static int invalid = 1;
+
+// Attribut 0 = Standardfarbe
+static const char *colors[MAX_COLORS] = { "" };
+static int ncolors = 1;
+
+static char out[OUT_SIZE];
+static size_t out_len;
+
+static ScreenStats stats;
+
+static const Cell blank = { {' ', 0, 0, 0}, 0, {0, 0, 0} };
+
+static inline int cell_eq(const Cell *a, const Cell *b) {
+    return memcmp(a, b, sizeof(Cell)) == 0;
+}
+
+// ANSI-Sequenz auf einen kleinen Index abbilden
+static uint8_t intern_color(const char *color) {
+    if (!color || !*color) return 0;
+    for (int i = 1; i < ncolors; i++) {
+        if (colors[i] == color || strcmp(colors[i], color) == 0) return (uint8_t)i;
+    }
+    if (ncolors == MAX_COLORS) return 0;
+    colors[ncolors] = color;
+    return (uint8_t)ncolors++;
+}
+
+static inline int utf8_len(unsigned char c) {
+    if (c < 0x80) return 1;
+    if ((c & 0xe0) == 0xc0) return 2;
+    if ((c & 0xf0) == 0xe0) return 3;
+    if ((c & 0xf8) == 0xf0) return 4;
+    return 1;
+}
+
+void scr_init(int rows, int cols) {
+    nrows = (rows > 0 && rows < SCREEN_ROWS) ? rows : SCREEN_ROWS;
+    ncols = (cols > 0 && cols < SCREEN_COLS) ? cols : SCREEN_COLS;
+    for (int r = 0; r < SCREEN_ROWS; r++) {
+        for (int c = 0; c < SCREEN_COLS; c++) {
+            cur[r][c] = blank;
+            prev[r][c] = blank;
+        }
+    }
+    invalid = 1;
+}
+
+void scr_clear_row(int row) {
+    if (row < 1 || row > nrows) return;
+    for (int c = 0; c < ncols; c++) cur[row - 1][c] = blank;
+}
+
+int scr_put(int row, int col, const char *color, const char *text) {
+    if (row < 1 || row > nrows) return col;
+    uint8_t attr = intern_color(color);
+    Cell *line = cur[row - 1];
+
+    const unsigned char *p = (const unsigned char *)text;
+    while (*p && col <= ncols) {
+        int len = utf8_len(*p);
+        Cell c = blank;
+        c.attr = attr;
+        for (int i = 0; i < len; i++) {
+            if (!p[i]) { len = i; break; }
+            c.g[i] = (char)p[i];
+        }
+        if (len == 0) break;
+        if (col >= 1) line[col - 1] = c;
+        p += len;
+        col++;
+    }
+    return col;
+}
+
+int scr_printf(int row, int col, const char *color, const char *fmt, ...) {
+    char buf[SCREEN_COLS * 4 + 1];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return scr_put(row, col, color, buf);
+}
+
+int scr_fill(int row, int col, int n, const char *color, const char *glyph) {
+    if (row < 1 || row > nrows) return col + n;
+    Cell c = blank;
+    c.attr = intern_color(color);
+    int len = utf8_len((unsigned char)glyph[0]);
+    memcpy(c.g, glyph, (size_t)len);
+
+    for (int i = 0; i < n; i++, col++) {
+        if (col >= 1 && col <= ncols) cur[row - 1][col - 1] = c;
+    }
+    return col;
+}
+
+void scr_invalidate(void) {
+    invalid = 1;
+}
+
+const ScreenStats *scr_stats(void) {
+    return &stats;
+}
+
+static inline void emit(const char *s, size_t len) {
+    if (out_len + len > sizeof(out)) return;
+    memcpy(out + out_len, s, len);
+    out_len += len;
+}
+
+static inline void emit_str(const char *s) {
+    emit(s, strlen(s));
+}
+
+static void emit_move(int row, int col) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "\033[%d;%dH", row, col);
+    emit(buf, (size_t)n);
+}
+
+static void emit_attr(uint8_t attr) {
+    emit_str("\033[0m");
+    emit_str(colors[attr]);
+}
+
+static void emit_glyph(const Cell *c) {
+    size_t len = 1;
+    while (len < 4 && c->g[len]) len++;
+    emit(c->g, len);
+}
+
+size_t scr_flush(int fd) {
+    int cur_row = -1, cur_col = -1;   // Cursorposition (0-basiert), -1 = unbekannt
+    int cur_attr = -1;
+
+    out_len = 0;
+
+    for (int r = 0; r < nrows; r++) {
+        // Letzte nicht-leere Zelle: dahinter reicht "Zeile löschen"
+        int last_used = ncols - 1;
+        while (last_used >= 0 && cell_eq(&cur[r][last_used], &blank)) last_used--;
+
+        for (int c = 0; c < ncols; c++) {
+            if (!invalid && cell_eq(&cur[r][c], &prev[r][c])) continue;
+
+            if (c > last_used) {
+                if (cur_row != r || cur_col != c) emit_move(r + 1, c + 1);
+                if (cur_attr != 0) {
+                    emit_str("\033[0m");
+                    cur_attr = 0;
+                }
+                emit_str("\033[K");
+                cur_row = r;
+                cur_col = c;
+                break;
+            }
+
+            if (cur_row == r && cur_col < c && c - cur_col <= MAX_REPRINT_GAP) {
+                // Kurze Lücke gleichfarbiger Zellen: neu ausgeben ist billiger
+                int same = 1;
+                for (int k = cur_col; k < c; k++) {
+                    if (cur[r][k].attr != cur_attr) { same = 0; break; }
+                }
+                if (same) {
+                    for (int k = cur_col; k < c; k++) emit_glyph(&cur[r][k]);
+                    cur_col = c;
+                }
+            }
+            if (cur_row != r || cur_col != c) emit_move(r + 1, c + 1);
+
+            if (cur[r][c].attr != cur_attr) {
+                emit_attr(cur[r][c].attr);
+                cur_attr = cur[r][c].attr;
+            }
+            emit_glyph(&cur[r][c]);
+            cur_row = r;
+            cur_col = c + 1;
+        }
+        memcpy(prev[r], cur[r], sizeof(prev[r]));
+    }
+    if (cur_attr > 0) emit_str("\033[0m");
+
+    // Ein write() pro Frame (Rest nur bei Teil-Schreibvorgängen)
+    size_t done = 0;
+    while (fd >= 0 && done < out_len) {
+        ssize_t n = write(fd, out + done, out_len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        done += (size_t)n;
+    }
+
+    if (stats.frames == 0) stats.bytes_first = out_len;
+    stats.frames++;
+    stats.bytes_total += out_len;
+    stats.bytes_last = out_len;
+    invalid = 0;
+
+    return out_len;
+}
@@ -0,0 +1,49 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Off-Screen-Framebuffer: Zellen (Glyph + Farbe) werden gegen den zuletzt
+ * ausgegebenen Frame verglichen, nur Änderungen gehen mit einem write() raus.
+ */
+
+#ifndef PINGMON_SCREEN_H
+#define PINGMON_SCREEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCREEN_ROWS 48
+#define SCREEN_COLS 200
+
+typedef struct {
+    uint64_t frames;
+    uint64_t bytes_total;
+    size_t bytes_last;       // Bytes des letzten Frames
+    size_t bytes_first;      // Bytes des ersten (vollständigen) Frames
+} ScreenStats;
+
+// Framebuffer leeren; rows/cols werden auf SCREEN_ROWS/SCREEN_COLS begrenzt
+void scr_init(int rows, int cols);
+
+// Ganze Zeile (1-basiert) auf Leerzeichen setzen
+void scr_clear_row(int row);
+
+// UTF-8-Text ab (row, col) schreiben (1-basiert). color ist eine ANSI-Sequenz
+// (z. B. ANSI_RED) oder "" für Standard. Rückgabe: Spalte nach dem Text
+int scr_put(int row, int col, const char *color, const char *text);
+int scr_printf(int row, int col, const char *color, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+// Eine Glyphe n-mal wiederholen. Rückgabe: Spalte danach
+int scr_fill(int row, int col, int n, const char *color, const char *glyph);
+
+// Frame mit dem vorigen vergleichen und Änderungen mit einem write() an fd
+// ausgeben (fd < 0: nur zählen). Rückgabe: Anzahl geschriebener Bytes
+size_t scr_flush(int fd);
+
+// Nächsten Frame vollständig ausgeben (z. B. nach Bildschirm löschen)
+void scr_invalidate(void);
+
+const ScreenStats *scr_stats(void);
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Sequenz-genaue Verlustzählung (siehe seqtrack.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "seqtrack.h"
+
+#define SLOT(t, x) ((x) & ((t)->window - 1))
+
+static inline int bit_get(const SeqTracker *t, const uint64_t *bits, uint32_t x) {
+    return (bits[SLOT(t, x) >> 6] >> (SLOT(t, x) & 63)) & 1;
+}
+
+static inline void bit_set(const SeqTracker *t, uint64_t *bits, uint32_t x) {
+    bits[SLOT(t, x) >> 6] |= 1ULL << (SLOT(t, x) & 63);
+}
+
+static inline void bit_clear(const SeqTracker *t, uint64_t *bits, uint32_t x) {
+    bits[SLOT(t, x) >> 6] &= ~(1ULL << (SLOT(t, x) & 63));
+}
+
+int seq_init(SeqTracker *t, uint32_t window) {
+    uint32_t w = SEQ_WINDOW_MIN;
+    while (w < window && w < SEQ_WINDOW_MAX) w *= 2;
+
+    // Ein Block: beide Bitmaps, dann die Sendezeiten
+    size_t words = w / 64;
+    uint64_t *mem = malloc((2 * words + w) * sizeof(uint64_t));
+    if (!mem) return -1;
+
+    memset(t, 0, sizeof(*t));
+    t->window = w;
+    t->pending = mem;
+    t->answered = mem + words;
+    t->sent_us = (int64_t *)(mem + 2 * words);
+    seq_reset(t);
+    return 0;
+}
+
+void seq_free(SeqTracker *t) {
+    free(t->pending);
+    t->pending = t->answered = NULL;
+    t->sent_us = NULL;
+}
+
+void seq_reset(SeqTracker *t) {
+    if (t->pending) {
+        memset(t->pending, 0, t->window / 8);
+        memset(t->answered, 0, t->window / 8);
+    }
+    t->started = 0;
+    t->next = t->tail = t->highest = 0;
+    t->outstanding = 0;
+    t->sent = t->received = t->lost = 0;
+    t->dup = t->reordered = t->late = 0;
+}
+
+static void mark_lost(SeqTracker *t, uint32_t x) {
+    bit_clear(t, t->pending, x);
+    t->outstanding--;
+    t->lost++;
+    if (t->on_lost) t->on_lost(t, (uint16_t)x);
+}
+
+// tail hinter alle nicht mehr offenen Sequenzen schieben
+static void advance_tail(SeqTracker *t) {
+    while (t->tail != t->next && !bit_get(t, t->pending, t->tail)) t->tail++;
+}
+
+void seq_sent(SeqTracker *t, uint16_t seq, int64_t sent_us) {
+    if (!t->started) {
+        t->started = 1;
+        t->next = t->tail = seq;
+        t->highest = seq - 1;
+    }
+
+    // 16-bit-Sequenz auf den erweiterten Zähler abbilden (nur vorwärts)
+    uint16_t ahead = (uint16_t)(seq - (uint16_t)t->next);
+    if (ahead >= 0x8000) return;     // schon bekannt
+
+    // Als Anzahl gezählt: der erweiterte Zähler darf bei 2^32 überlaufen
+    for (uint32_t n = (uint32_t)ahead + 1; n > 0; n--) {
+        uint32_t x = t->next;
+
+        // Fenster voll: älteste offene Probe aufgeben
+        while (x - t->tail >= t->window) {
+            if (bit_get(t, t->pending, t->tail)) mark_lost(t, t->tail);
+            t->tail++;
+            advance_tail(t);
+        }
+
+        bit_set(t, t->pending, x);
+        bit_clear(t, t->answered, x);
+        t->sent_us[SLOT(t, x)] = sent_us;
+        t->outstanding++;
+        t->sent++;
+        t->next++;
+    }
+}
+
+// 16-bit-Sequenz einer Antwort rückwärts vom nächsten Sendewert auflösen
+static int resolve(const SeqTracker *t, uint16_t seq, uint32_t *ext) {
+    if (!t->started) return -1;
+    uint16_t back = (uint16_t)((uint16_t)t->next - seq);
+    if (back == 0 || back > t->window) return -1;
+    // Vor der ersten erfassten Sequenz? Als Abstand zu next geprüft, das
+    // hält auch nach 2^31 bzw. 2^32 Probes
+    if (back > t->sent) return -1;
+    *ext = t->next - back;
+    return 0;
+}
+
+SeqReplyKind seq_reply(SeqTracker *t, uint16_t seq) {
+    uint32_t x;
+    if (resolve(t, seq, &x) == -1) return SEQ_REPLY_UNKNOWN;
+
+    if (bit_get(t, t->pending, x)) {
+        bit_clear(t, t->pending, x);
+        bit_set(t, t->answered, x);
+        t->outstanding--;
+        t->received++;
+        advance_tail(t);
+
+        if ((int32_t)(x - t->highest) < 0) {
+            t->reordered++;
+            return SEQ_REPLY_REORDERED;
+        }
+        t->highest = x;
+        return SEQ_REPLY_OK;
+    }
+    if (bit_get(t, t->answered, x)) {
+        t->dup++;
+        return SEQ_REPLY_DUP;
+    }
+    t->late++;
+    return SEQ_REPLY_LATE;
+}
+
+void seq_lost(SeqTracker *t, uint16_t seq) {
+    uint32_t x;
+    if (resolve(t, seq, &x) == -1 || !bit_get(t, t->pending, x)) return;
+    mark_lost(t, x);
+    advance_tail(t);
+}
+
+void seq_expire(SeqTracker *t, int64_t now_us, int64_t timeout_us) {
+    // Sendezeiten steigen mit der Sequenz, also reicht der Blick auf tail
+    while (t->tail != t->next) {
+        if (bit_get(t, t->pending, t->tail)) {
+            if (now_us - t->sent_us[SLOT(t, t->tail)] < timeout_us) break;
+            mark_lost(t, t->tail);
+        }
+        t->tail++;
+    }
+}
+
+int64_t seq_next_deadline(const SeqTracker *t, int64_t timeout_us) {
+    if (t->outstanding == 0) return -1;
+    return t->sent_us[SLOT(t, t->tail)] + timeout_us;
+}
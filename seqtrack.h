@@ -0,0 +1,79 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Verlustzählung exakt nach Sequenznummer: gleitendes Fenster über die
+ * zuletzt gesendeten Probes mit Bitmaps für "offen" und "beantwortet".
+ * Jede Probe wird nach einem Timeout auf der monotonen Uhr einzeln als
+ * verloren gezählt; Duplikate, vertauschte und verspätete Antworten werden
+ * getrennt erkannt.
+ */
+
+#ifndef PINGMON_SEQTRACK_H
+#define PINGMON_SEQTRACK_H
+
+#include <stdint.h>
+
+#define SEQ_WINDOW 4096              // Standardfenster, Zweierpotenz, < 65536
+#define SEQ_WINDOW_MIN 64
+#define SEQ_WINDOW_MAX 32768         // halber Sequenzraum
+
+typedef enum {
+    SEQ_REPLY_OK = 0,
+    SEQ_REPLY_REORDERED,     // gültig, aber nach einer neueren Antwort
+    SEQ_REPLY_DUP,           // bereits beantwortet
+    SEQ_REPLY_LATE,          // kam nach dem Timeout, zählt als verloren
+    SEQ_REPLY_UNKNOWN        // nicht (mehr) im Fenster
+} SeqReplyKind;
+
+typedef struct SeqTracker SeqTracker;
+typedef void (*SeqLostFn)(SeqTracker *t, uint16_t seq);
+
+struct SeqTracker {
+    uint32_t window;         // Zweierpotenz; viele Ziele brauchen nur ein kleines Fenster
+    uint64_t *pending;       // gesendet, noch offen (Bitmap)
+    uint64_t *answered;      // beantwortet, für Duplikate (Bitmap)
+    int64_t *sent_us;
+    int started;
+    uint32_t next;           // nächste zu sendende Sequenz (erweitert, läuft über)
+    uint32_t tail;           // älteste möglicherweise noch offene Sequenz
+    uint32_t highest;        // höchste beantwortete Sequenz
+    uint32_t outstanding;
+
+    uint64_t sent;
+    uint64_t received;
+    uint64_t lost;
+    uint64_t dup;
+    uint64_t reordered;
+    uint64_t late;
+
+    SeqLostFn on_lost;       // für jede als verloren gezählte Probe
+    void *ctx;               // frei für den Aufrufer (z. B. Ziel im Mehrzielbetrieb)
+};
+
+// Fenster anlegen (window wird auf eine Zweierpotenz >= SEQ_WINDOW_MIN
+// aufgerundet). 0 = OK, -1 = kein Speicher
+int seq_init(SeqTracker *t, uint32_t window);
+void seq_free(SeqTracker *t);
+
+// Alles zurücksetzen, Fenster, on_lost und ctx bleiben erhalten
+void seq_reset(SeqTracker *t);
+
+// Probe als gesendet eintragen. Lücken zur vorigen Sequenz (z. B. beim
+// Mitlesen von ping) werden mit derselben Sendezeit aufgefüllt. Läuft das
+// Fenster über, wird die älteste offene Probe als verloren gezählt.
+void seq_sent(SeqTracker *t, uint16_t seq, int64_t sent_us);
+
+// Antwort einordnen
+SeqReplyKind seq_reply(SeqTracker *t, uint16_t seq);
+
+// Offene Probe sofort als verloren zählen ("no answer yet" von ping)
+void seq_lost(SeqTracker *t, uint16_t seq);
+
+// Alle Probes älter als timeout_us als verloren zählen
+void seq_expire(SeqTracker *t, int64_t now_us, int64_t timeout_us);
+
+// Zeitpunkt, an dem die nächste offene Probe abläuft, -1 wenn keine offen
+int64_t seq_next_deadline(const SeqTracker *t, int64_t timeout_us);
+
+#endif
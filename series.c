@@ -0,0 +1,214 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Komprimierte RTT-Zeitreihe (siehe series.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "series.h"
+
+// Schlechtester Fall pro Sample: 4+64 Bits Zeit, 2+5+32 Bits Wert
+#define MAX_SAMPLE_BITS 107
+// Fenster neu setzen, wenn es um mehr als so viele Bits zu breit wäre
+#define WINDOW_SLACK 6
+#define BLOCK_BITS (SERIES_BLOCK_BYTES * 8)
+
+static void put_bits(SeriesBlock *b, uint64_t v, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if ((v >> i) & 1) {
+            b->data[b->nbits >> 3] |= (uint8_t)(0x80 >> (b->nbits & 7));
+        }
+        b->nbits++;
+    }
+}
+
+static uint64_t get_bits(const SeriesBlock *b, uint32_t *pos, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) {
+        v = (v << 1) | ((b->data[*pos >> 3] >> (7 - (*pos & 7))) & 1);
+        (*pos)++;
+    }
+    return v;
+}
+
+// RTT in Mikrosekunden + 1, 0 = verloren
+static inline uint32_t encode_rtt(double rtt_ms) {
+    if (rtt_ms <= 0) return 0;
+    double us = rtt_ms * 1000.0 + 0.5;
+    if (us >= (double)(UINT32_MAX - 1)) return UINT32_MAX;
+    return (uint32_t)us + 1;
+}
+
+void series_init(Series *s) {
+    memset(s, 0, sizeof(*s));
+    s->prev_lead = -1;
+}
+
+void series_free(Series *s) {
+    for (size_t i = 0; i < s->nblocks; i++) free(s->blocks[i]);
+    free(s->blocks);
+    series_init(s);
+}
+
+static SeriesBlock *new_block(Series *s) {
+    if (s->nblocks == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 16;
+        SeriesBlock **blocks = realloc(s->blocks, cap * sizeof(*blocks));
+        if (!blocks) return NULL;
+        s->blocks = blocks;
+        s->cap = cap;
+    }
+    SeriesBlock *b = calloc(1, sizeof(SeriesBlock));
+    if (!b) return NULL;
+    s->blocks[s->nblocks++] = b;
+    return b;
+}
+
+// Wie Gorilla, aber mit kleinerem zweiten Bereich: bei ms-Zeitstempeln
+// schwankt das Intervall fast immer nur um wenige Millisekunden
+static void put_dod(SeriesBlock *b, int64_t dod) {
+    if (dod == 0) {
+        put_bits(b, 0, 1);
+    } else if (dod >= -7 && dod <= 8) {
+        put_bits(b, 0x2, 2);
+        put_bits(b, (uint64_t)(dod + 7), 4);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(b, 0x6, 3);
+        put_bits(b, (uint64_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(b, 0xe, 4);
+        put_bits(b, (uint64_t)(dod + 2047), 12);
+    } else {
+        put_bits(b, 0xf, 4);
+        put_bits(b, (uint64_t)dod, 64);
+    }
+}
+
+static int64_t get_dod(const SeriesBlock *b, uint32_t *pos) {
+    if (get_bits(b, pos, 1) == 0) return 0;
+    if (get_bits(b, pos, 1) == 0) return (int64_t)get_bits(b, pos, 4) - 7;
+    if (get_bits(b, pos, 1) == 0) return (int64_t)get_bits(b, pos, 9) - 255;
+    if (get_bits(b, pos, 1) == 0) return (int64_t)get_bits(b, pos, 12) - 2047;
+    return (int64_t)get_bits(b, pos, 64);
+}
+
+int series_append(Series *s, int64_t ts_ms, double rtt_ms) {
+    uint32_t v = encode_rtt(rtt_ms);
+    SeriesBlock *b = s->nblocks ? s->blocks[s->nblocks - 1] : NULL;
+
+    if (!b || BLOCK_BITS - b->nbits < MAX_SAMPLE_BITS) {
+        b = new_block(s);
+        if (!b) return -1;
+    }
+
+    if (b->count == 0) {
+        // Blockanfang: Rohwerte, damit jeder Block für sich dekodierbar ist
+        put_bits(b, (uint64_t)ts_ms, 64);
+        put_bits(b, v, 32);
+        b->first_ts = ts_ms;
+        s->prev_delta = 0;
+        s->prev_lead = -1;
+    } else {
+        int64_t delta = ts_ms - s->prev_ts;
+        put_dod(b, delta - s->prev_delta);
+        s->prev_delta = delta;
+
+        // XOR mit dem Vorwert. Ganzzahlige Mikrosekunden haben anders als
+        // double-Mantissen kaum Nullen am Ende, daher nur führende Nullen
+        uint32_t x = v ^ s->prev_val;
+        if (x == 0) {
+            put_bits(b, 0, 1);
+        } else {
+            int lead = __builtin_clz(x);
+            if (s->prev_lead >= 0 && lead >= s->prev_lead && lead <= s->prev_lead + WINDOW_SLACK) {
+                // Passt ins vorige Fenster: nur die signifikanten Bits
+                put_bits(b, 0x2, 2);
+                put_bits(b, x, 32 - s->prev_lead);
+            } else {
+                put_bits(b, 0x3, 2);
+                put_bits(b, (uint64_t)lead, 5);
+                put_bits(b, x, 32 - lead);
+                s->prev_lead = lead;
+            }
+        }
+    }
+
+    s->prev_ts = ts_ms;
+    s->prev_val = v;
+    b->last_ts = ts_ms;
+    b->count++;
+    s->samples++;
+    return 0;
+}
+
+size_t series_bytes(const Series *s) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < s->nblocks; i++) {
+        bytes += (s->blocks[i]->nbits + 7) / 8 + offsetof(SeriesBlock, data);
+    }
+    return bytes;
+}
+
+void series_iter_init(SeriesIter *it, const Series *s, int64_t from, int64_t to) {
+    memset(it, 0, sizeof(*it));
+    it->s = s;
+    it->from = from;
+    it->to = to;
+
+    // Binärsuche nach dem ersten Block, der from enthalten kann
+    size_t lo = 0, hi = s->nblocks;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (s->blocks[mid]->last_ts < from) lo = mid + 1;
+        else hi = mid;
+    }
+    it->block = lo;
+}
+
+int series_iter_next(SeriesIter *it, SeriesSample *out) {
+    const Series *s = it->s;
+
+    while (it->block < s->nblocks) {
+        const SeriesBlock *b = s->blocks[it->block];
+
+        if (it->idx == 0 && b->first_ts > it->to) return 0;
+        if (it->idx >= b->count) {
+            it->block++;
+            it->idx = 0;
+            it->bitpos = 0;
+            continue;
+        }
+
+        if (it->idx == 0) {
+            it->ts = (int64_t)get_bits(b, &it->bitpos, 64);
+            it->val = (uint32_t)get_bits(b, &it->bitpos, 32);
+            it->delta = 0;
+            it->lead = -1;
+        } else {
+            it->delta += get_dod(b, &it->bitpos);
+            it->ts += it->delta;
+
+            if (get_bits(b, &it->bitpos, 1) == 1) {
+                if (get_bits(b, &it->bitpos, 1) == 1) {
+                    it->lead = (int)get_bits(b, &it->bitpos, 5);
+                }
+                it->val ^= (uint32_t)get_bits(b, &it->bitpos, 32 - it->lead);
+            }
+        }
+        it->idx++;
+
+        if (it->ts < it->from) continue;
+        if (it->ts > it->to) return 0;
+
+        out->ts_ms = it->ts;
+        out->lost = (it->val == 0);
+        out->rtt_ms = out->lost ? 0.0 : (it->val - 1) / 1000.0;
+        return 1;
+    }
+    return 0;
+}
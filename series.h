@@ -0,0 +1,69 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Komprimierte RTT-Zeitreihe (Gorilla-Verfahren): Zeitstempel als
+ * Delta-of-Delta, RTT in ganzen Mikrosekunden XOR-kodiert. Nur Anhängen; jeder
+ * Block ist unabhängig dekodierbar, Bereichsabfragen überspringen Blöcke.
+ */
+
+#ifndef PINGMON_SERIES_H
+#define PINGMON_SERIES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SERIES_BLOCK_BYTES 4096
+
+typedef struct {
+    int64_t ts_ms;           // Wanduhr, Millisekunden seit Epoch
+    double rtt_ms;           // 0 bei verlorener Probe
+    int lost;
+} SeriesSample;
+
+typedef struct {
+    int64_t first_ts;
+    int64_t last_ts;
+    uint32_t count;
+    uint32_t nbits;
+    uint8_t data[SERIES_BLOCK_BYTES];
+} SeriesBlock;
+
+typedef struct {
+    SeriesBlock **blocks;
+    size_t nblocks;
+    size_t cap;
+    uint64_t samples;
+
+    // Kodierzustand des offenen (letzten) Blocks
+    int64_t prev_ts;
+    int64_t prev_delta;
+    uint32_t prev_val;
+    int prev_lead;           // -1 = kein Fenster
+} Series;
+
+typedef struct {
+    const Series *s;
+    int64_t from, to;
+    size_t block;
+    uint32_t idx;            // Index im aktuellen Block
+    uint32_t bitpos;
+    int64_t ts, delta;
+    uint32_t val;
+    int lead;
+} SeriesIter;
+
+void series_init(Series *s);
+void series_free(Series *s);
+
+// Sample anhängen (rtt_ms <= 0 = verloren). 0 = OK, -1 = kein Speicher
+int series_append(Series *s, int64_t ts_ms, double rtt_ms);
+
+// Belegter Speicher in Bytes (komprimierte Daten)
+size_t series_bytes(const Series *s);
+
+// Alle Samples mit from <= ts <= to in Zeitreihenfolge lesen
+void series_iter_init(SeriesIter *it, const Series *s, int64_t from, int64_t to);
+int series_iter_next(SeriesIter *it, SeriesSample *out);
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Seqlock-geschützte Live-Werte in /dev/shm (siehe shmstats.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shmstats.h"
+
+// Name für shm_open: genau ein führender '/', sonst keiner
+static int set_name(ShmStats *s, const char *name) {
+    if (name[0] == '/') name++;
+    if (!name[0] || strchr(name, '/')) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((size_t)snprintf(s->name, sizeof(s->name), "/%s", name) >= sizeof(s->name)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+static int pid_alive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+int shm_writer_alive(const ShmStats *s) {
+    return s->seg && pid_alive(__atomic_load_n(&s->seg->pid, __ATOMIC_RELAXED));
+}
+
+static int valid_header(const ShmSegment *g) {
+    return memcmp(g->magic, SHM_MAGIC, sizeof(g->magic)) == 0 &&
+           g->version == SHM_VERSION && g->size == sizeof(ShmSegment);
+}
+
+int shm_publish_open(ShmStats *s, const char *name) {
+    memset(s, 0, sizeof(*s));
+    if (set_name(s, name) == -1) return -1;
+
+    int fd = shm_open(s->name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) return -1;
+    if (ftruncate(fd, sizeof(ShmSegment)) == -1) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    ShmSegment *g = map;
+
+    // Segment eines anderen laufenden pingmon nicht übernehmen
+    if (valid_header(g) && g->pid != (int32_t)getpid() && pid_alive(g->pid)) {
+        munmap(map, sizeof(ShmSegment));
+        errno = EADDRINUSE;
+        return -1;
+    }
+
+    // Noch eingeblendete Leser eines früheren Schreibers sehen den Umbau
+    // als laufendes Schreiben
+    uint32_t seq = (g->seq | 1u);
+    __atomic_store_n(&g->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memset(&g->snap, 0, sizeof(g->snap));
+    memcpy(g->magic, SHM_MAGIC, sizeof(g->magic));
+    g->version = SHM_VERSION;
+    g->size = sizeof(ShmSegment);
+    g->publishes = 0;
+    __atomic_store_n(&g->pid, (int32_t)getpid(), __ATOMIC_RELAXED);
+    __atomic_store_n(&g->seq, seq + 1, __ATOMIC_RELEASE);
+
+    s->seg = g;
+    s->writer = 1;
+    return 0;
+}
+
+ShmSnapshot *shm_publish_begin(ShmStats *s) {
+    ShmSegment *g = s->seg;
+    __atomic_store_n(&g->seq, g->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return &g->snap;
+}
+
+void shm_publish_end(ShmStats *s) {
+    ShmSegment *g = s->seg;
+    g->publishes++;
+    __atomic_store_n(&g->seq, g->seq + 1, __ATOMIC_RELEASE);
+}
+
+int shm_attach(ShmStats *s, const char *name) {
+    memset(s, 0, sizeof(*s));
+    if (set_name(s, name) == -1) return -1;
+
+    int fd = shm_open(s->name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(ShmSegment)) {
+        close(fd);
+        return -2;
+    }
+    void *map = mmap(NULL, sizeof(ShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    s->seg = map;
+    if (!valid_header(s->seg)) {
+        shm_close(s);
+        return -2;
+    }
+    return 0;
+}
+
+int shm_read(ShmStats *s, ShmSnapshot *out, uint64_t *publishes) {
+    const ShmSegment *g = s->seg;
+    for (int i = 0; i < SHM_RETRIES; i++) {
+        uint32_t seq = __atomic_load_n(&g->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1u) {
+            s->retries++;
+            sched_yield();
+            continue;
+        }
+        memcpy(out, &g->snap, sizeof(*out));
+        uint64_t n = g->publishes;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&g->seq, __ATOMIC_RELAXED) == seq) {
+            if (publishes) *publishes = n;
+            return 0;
+        }
+        s->retries++;
+    }
+    return -1;
+}
+
+void shm_close(ShmStats *s) {
+    if (!s->seg) return;
+    if (s->writer) {
+        // Leser erkennen am fehlenden Schreiber, dass nichts mehr kommt
+        __atomic_store_n(&s->seg->pid, 0, __ATOMIC_RELEASE);
+        shm_unlink(s->name);
+    }
+    munmap(s->seg, sizeof(ShmSegment));
+    s->seg = NULL;
+}
@@ -0,0 +1,98 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Veröffentlichung der Live-Werte in einem Shared-Memory-Segment unter
+ * /dev/shm (--publish NAME), damit Dashboards, Alarm-Agenten oder ein
+ * zweites Terminal (--attach NAME) mitlesen, ohne selbst zu proben.
+ *
+ * Ein Schreiber, beliebig viele Leser, Seqlock: der Schreiber macht die
+ * Sequenz vor dem Schreiben ungerade und danach wieder gerade, ohne Lock
+ * und ohne auf Leser zu warten. Leser kopieren die Momentaufnahme und
+ * wiederholen, wenn sich die Sequenz dabei geändert hat.
+ *
+ * Layout (Byte-Reihenfolge der Maschine): ShmSegment; Leser prüfen magic,
+ * version und size, bevor sie etwas anderes lesen.
+ */
+
+#ifndef PINGMON_SHMSTATS_H
+#define PINGMON_SHMSTATS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+
+#include "stats.h"
+#include "rollup.h"
+
+#define SHM_MAGIC    "PMONSHM1"
+#define SHM_VERSION  1
+#define SHM_NAME_MAX 128
+#define SHM_HIST     40             // Einträge pro History-Stufe, neueste zuerst
+#define SHM_RETRIES  1000           // Leseversuche, bevor ein Schreiber als hängend gilt
+
+typedef struct {
+    int64_t updated_ms;      // Wanduhr der Veröffentlichung
+    char target[256];
+    char addr[INET6_ADDRSTRLEN]; // aufgelöste Adresse, leer = noch keine
+    char status_msg[128];
+    int32_t resolve_error;   // EAI_*, 0 = OK
+    int32_t timeout_state;
+    int32_t probe_kind;      // ConnKind
+    int32_t probe_port;
+    int64_t interval_us;
+    double warn;
+    double crit;
+
+    uint64_t sent;
+    uint64_t recv;
+    uint64_t dup;
+    uint64_t reordered;
+    uint64_t late;
+    double last_ms;
+    double sum_ms;
+    double quality;
+    double stability;
+    LatencyStats lat;
+
+    int32_t hist_len[ROLLUP_TIERS];
+    RollupBucket hist[ROLLUP_TIERS][SHM_HIST];
+} ShmSnapshot;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;           // sizeof(ShmSegment)
+    int32_t pid;             // Schreiber
+    uint32_t seq;            // Seqlock, ungerade = Schreiben läuft
+    uint64_t publishes;
+    ShmSnapshot snap;
+} ShmSegment;
+
+typedef struct {
+    char name[SHM_NAME_MAX]; // mit führendem '/'
+    ShmSegment *seg;         // NULL = nicht geöffnet
+    int writer;
+    uint64_t retries;        // Leser: wiederholte Kopien
+} ShmStats;
+
+// Segment anlegen bzw. übernehmen (Schreiber). 0 = OK, -1 = Fehler (errno)
+int shm_publish_open(ShmStats *s, const char *name);
+
+// Momentaufnahme direkt im Segment füllen, zwischen begin und end
+ShmSnapshot *shm_publish_begin(ShmStats *s);
+void shm_publish_end(ShmStats *s);
+
+// Nur lesend einblenden. 0 = OK, -1 = Fehler (errno), -2 = fremdes Format
+int shm_attach(ShmStats *s, const char *name);
+
+// Konsistente Kopie holen. 0 = OK, -1 = Schreiber hängt mitten im Schreiben
+int shm_read(ShmStats *s, ShmSnapshot *out, uint64_t *publishes);
+
+// Prozess des Schreibers lebt noch
+int shm_writer_alive(const ShmStats *s);
+
+// Ausblenden; der Schreiber entfernt das Segment
+void shm_close(ShmStats *s);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Lock-freie SPSC-Queue (siehe spsc.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "spsc.h"
+
+int spsc_init(SpscQueue *q, size_t capacity, size_t elem_size) {
+    size_t cap = 2;
+    while (cap < capacity) cap *= 2;
+
+    memset(q, 0, sizeof(*q));
+    q->ring.buf = malloc(cap * elem_size);
+    if (!q->ring.buf) return -1;
+    q->ring.elem_size = elem_size;
+    q->ring.mask = cap - 1;
+    return 0;
+}
+
+void spsc_free(SpscQueue *q) {
+    free(q->ring.buf);
+    q->ring.buf = NULL;
+}
+
+// n Datensätze ab Position pos kopieren, ggf. über das Ringende hinweg
+static void copy_in(SpscQueue *q, uint64_t pos, const unsigned char *src, size_t n) {
+    size_t es = q->ring.elem_size;
+    size_t start = (size_t)(pos & q->ring.mask);
+    size_t first = q->ring.mask + 1 - start;
+    if (first > n) first = n;
+    memcpy(q->ring.buf + start * es, src, first * es);
+    memcpy(q->ring.buf, src + first * es, (n - first) * es);
+}
+
+static void copy_out(SpscQueue *q, uint64_t pos, unsigned char *dst, size_t n) {
+    size_t es = q->ring.elem_size;
+    size_t start = (size_t)(pos & q->ring.mask);
+    size_t first = q->ring.mask + 1 - start;
+    if (first > n) first = n;
+    memcpy(dst, q->ring.buf + start * es, first * es);
+    memcpy(dst + first * es, q->ring.buf, (n - first) * es);
+}
+
+size_t spsc_push(SpscQueue *q, const void *items, size_t n) {
+    uint64_t tail = q->prod.tail;
+    uint64_t cap = q->ring.mask + 1;
+
+    if (tail + n - q->prod.head_cache > cap) {
+        q->prod.head_cache = __atomic_load_n(&q->cons.head, __ATOMIC_ACQUIRE);
+        uint64_t room = cap - (tail - q->prod.head_cache);
+        if (n > room) n = (size_t)room;
+    }
+    if (n == 0) return 0;
+
+    copy_in(q, tail, items, n);
+    __atomic_store_n(&q->prod.tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+size_t spsc_pop(SpscQueue *q, void *out, size_t max) {
+    uint64_t head = q->cons.head;
+
+    if (q->cons.tail_cache - head < max) {
+        q->cons.tail_cache = __atomic_load_n(&q->prod.tail, __ATOMIC_ACQUIRE);
+    }
+    uint64_t avail = q->cons.tail_cache - head;
+    size_t n = avail < max ? (size_t)avail : max;
+    if (n == 0) return 0;
+
+    copy_out(q, head, out, n);
+    __atomic_store_n(&q->cons.head, head + n, __ATOMIC_RELEASE);
+    return n;
+}
@@ -0,0 +1,53 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Lock-freie Single-Producer/Single-Consumer-Queue für Datensätze fester
+ * Größe. Erzeuger und Verbraucher arbeiten nur mit ihrem eigenen Index und
+ * lesen den fremden mit acquire; Kopf und Ende liegen auf getrennten
+ * Cache-Zeilen. Jede Seite hält eine lokale Kopie des fremden Index, damit
+ * die fremde Cache-Zeile nur bei (scheinbar) voller bzw. leerer Queue
+ * gelesen wird.
+ */
+
+#ifndef PINGMON_SPSC_H
+#define PINGMON_SPSC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPSC_CACHELINE 64
+
+typedef struct {
+    // Nur vom Erzeuger geschrieben
+    struct {
+        uint64_t tail;       // nächster Schreibplatz
+        uint64_t head_cache; // zuletzt gelesener head
+    } __attribute__((aligned(SPSC_CACHELINE))) prod;
+
+    // Nur vom Verbraucher geschrieben
+    struct {
+        uint64_t head;       // nächster Leseplatz
+        uint64_t tail_cache; // zuletzt gelesener tail
+    } __attribute__((aligned(SPSC_CACHELINE))) cons;
+
+    // Unveränderlich nach spsc_init
+    struct {
+        unsigned char *buf;
+        size_t elem_size;
+        uint64_t mask;       // Kapazität - 1 (Zweierpotenz)
+    } __attribute__((aligned(SPSC_CACHELINE))) ring;
+} SpscQueue;
+
+// capacity wird auf eine Zweierpotenz aufgerundet. 0 = OK, -1 = kein Speicher
+int spsc_init(SpscQueue *q, size_t capacity, size_t elem_size);
+void spsc_free(SpscQueue *q);
+
+// Nur Erzeuger: bis zu n Datensätze anhängen und mit einem Store
+// veröffentlichen. Rückgabe: Anzahl übernommener Datensätze (Rest: voll)
+size_t spsc_push(SpscQueue *q, const void *items, size_t n);
+
+// Nur Verbraucher: bis zu max Datensätze entnehmen. Rückgabe: Anzahl
+size_t spsc_pop(SpscQueue *q, void *out, size_t max);
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Streaming-Statistik (siehe stats.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <math.h>
+
+#include "stats.h"
+
+void lat_reset(LatencyStats *s) {
+    memset(s, 0, sizeof(*s));
+    s->prev_rtt = -1;
+}
+
+int lat_bucket_index(uint64_t us) {
+    if (us >= (1ULL << LAT_MAX_BITS)) us = (1ULL << LAT_MAX_BITS) - 1;
+    if (us < LAT_SUB) return (int)us;
+
+    int msb = 63 - __builtin_clzll(us);
+    int shift = msb - LAT_SUB_BITS;
+    return shift * LAT_SUB + (int)(us >> shift);
+}
+
+uint64_t lat_bucket_lower(int idx) {
+    if (idx < LAT_SUB) return (uint64_t)idx;
+    int group = idx / LAT_SUB;
+    int sub = idx % LAT_SUB;
+    return (uint64_t)(LAT_SUB + sub) << (group - 1);
+}
+
+uint64_t lat_bucket_upper(int idx) {
+    if (idx < LAT_SUB) return (uint64_t)idx + 1;
+    return lat_bucket_lower(idx) + (1ULL << (idx / LAT_SUB - 1));
+}
+
+void lat_add(LatencyStats *s, double rtt_ms) {
+    if (rtt_ms < 0) return;
+
+    uint64_t us = (uint64_t)(rtt_ms * 1000.0 + 0.5);
+    s->counts[lat_bucket_index(us)]++;
+    s->count++;
+
+    if (s->count == 1 || rtt_ms < s->min) s->min = rtt_ms;
+    if (s->count == 1 || rtt_ms > s->max) s->max = rtt_ms;
+
+    // Welford: numerisch stabil, ohne Samples zu speichern
+    double delta = rtt_ms - s->mean;
+    s->mean += delta / (double)s->count;
+    s->m2 += delta * (rtt_ms - s->mean);
+
+    // RFC 3550: J += (|D| - J) / 16, D = Differenz aufeinanderfolgender Laufzeiten
+    if (s->prev_rtt >= 0) {
+        double d = fabs(rtt_ms - s->prev_rtt);
+        s->jitter += (d - s->jitter) / 16.0;
+    }
+    s->prev_rtt = rtt_ms;
+}
+
+double lat_percentile(const LatencyStats *s, double p) {
+    if (s->count == 0) return 0.0;
+
+    uint64_t rank = (uint64_t)ceil(p / 100.0 * (double)s->count);
+    if (rank < 1) rank = 1;
+    if (rank > s->count) rank = s->count;
+
+    // Obere Perzentile (P95/P99, Rangliste im Mehrzielbetrieb) vom Maximum
+    // abwärts suchen: nur wenige Buckets statt des ganzen Histogramms
+    int found = -1;
+    uint64_t seen = 0;
+    if (p >= 50.0) {
+        uint64_t above = s->count - rank;
+        for (int i = lat_bucket_index((uint64_t)(s->max * 1000.0 + 0.5)); i >= 0; i--) {
+            seen += s->counts[i];
+            if (seen > above) {
+                found = i;
+                break;
+            }
+        }
+    } else {
+        for (int i = 0; i < LAT_BUCKETS; i++) {
+            seen += s->counts[i];
+            if (seen >= rank) {
+                found = i;
+                break;
+            }
+        }
+    }
+    if (found < 0) return s->max;
+
+    // Bucket-Mitte, auf den tatsächlichen Wertebereich begrenzt
+    double mid = (double)(lat_bucket_lower(found) + lat_bucket_upper(found)) / 2000.0;
+    if (mid < s->min) mid = s->min;
+    if (mid > s->max) mid = s->max;
+    return mid;
+}
+
+double lat_stddev(const LatencyStats *s) {
+    return s->count > 1 ? sqrt(s->m2 / (double)(s->count - 1)) : 0.0;
+}
+
+void lat_merge(LatencyStats *dst, const LatencyStats *src) {
+    if (src->count == 0) return;
+    if (dst->count == 0) {
+        *dst = *src;
+        return;
+    }
+
+    for (int i = 0; i < LAT_BUCKETS; i++) dst->counts[i] += src->counts[i];
+
+    // Chan et al.: Mittel und M2 zweier Teilmengen kombinieren
+    double na = (double)dst->count, nb = (double)src->count, n = na + nb;
+    double delta = src->mean - dst->mean;
+    dst->mean += delta * nb / n;
+    dst->m2 += src->m2 + delta * delta * na * nb / n;
+
+    // Jitter: src ist von 0 gestartet, der Startwert dst->jitter wäre über
+    // die count - 1 Schritte von src mit (15/16)^k abgeklungen. Es fehlt nur
+    // die eine Differenz an der Nahtstelle
+    dst->jitter = dst->jitter * pow(15.0 / 16.0, nb - 1.0) + src->jitter;
+
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    dst->count += src->count;
+    dst->prev_rtt = src->prev_rtt;
+}
+
+// Ping-Qualität berechnen
+double calculate_quality(double last_ms) {
+    if (last_ms <= 5) return 100.0;
+    else if (last_ms <= 20) return 80.0 + (20.0 - last_ms) * 1.3333;
+    else if (last_ms <= 30) return 60.0 + (30.0 - last_ms) * 2.0;
+    else if (last_ms <= 60) return 30.0 + (60.0 - last_ms) * 1.0;
+    else if (last_ms <= 100) return 10.0 + (100.0 - last_ms) * 0.5;
+    else return 0.0;
+}
+
+// Stabilität berechnen
+double calculate_stability(double loss_percent) {
+    if (loss_percent <= 0.1) return 100.0;
+    else if (loss_percent <= 1.0) return 100.0 - loss_percent * 10.0;
+    else if (loss_percent <= 5.0) return 90.0 - (loss_percent - 1.0) * 15.0;
+    else if (loss_percent <= 10.0) return 30.0 - (loss_percent - 5.0) * 6.0;
+    else return 0.0;
+}
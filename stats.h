@@ -0,0 +1,55 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Streaming-Statistik in konstantem Speicher: log-lineares Histogramm
+ * (HDR-artig, ~3 % Auflösung) für Perzentile, Welford für Mittel/StdDev und
+ * Interarrival-Jitter nach RFC 3550.
+ */
+
+#ifndef PINGMON_STATS_H
+#define PINGMON_STATS_H
+
+#include <stdint.h>
+
+#define LAT_SUB_BITS 5                       // 32 Unterteilungen pro Zweierpotenz
+#define LAT_SUB      (1 << LAT_SUB_BITS)
+#define LAT_MAX_BITS 26                      // bis 2^26 us = 67 s
+#define LAT_BUCKETS  ((LAT_MAX_BITS - LAT_SUB_BITS + 1) * LAT_SUB)
+
+typedef struct {
+    uint32_t counts[LAT_BUCKETS];
+    uint64_t count;
+    double min;              // ms
+    double max;              // ms
+    double mean;             // ms (Welford)
+    double m2;
+    double jitter;           // ms, RFC 3550 Abschnitt 6.4.1
+    double prev_rtt;         // ms, < 0 = noch keine Probe
+} LatencyStats;
+
+void lat_reset(LatencyStats *s);
+
+// Eine RTT in ms aufnehmen, O(1)
+void lat_add(LatencyStats *s, double rtt_ms);
+
+// Perzentil p (0..100) in ms, 0 wenn leer
+double lat_percentile(const LatencyStats *s, double p);
+
+double lat_stddev(const LatencyStats *s);
+
+// Das zeitlich folgende Teilergebnis src an dst anhängen (parallele
+// Auswertung). Histogramm, Mittel und Varianz exakt, Jitter bis auf die
+// Differenz an der Nahtstelle
+void lat_merge(LatencyStats *dst, const LatencyStats *src);
+
+// Qualität (0..100) aus der letzten RTT bzw. Stabilität aus dem Verlust in %
+double calculate_quality(double last_ms);
+double calculate_stability(double loss_percent);
+
+// Bucket-Grenzen in Mikrosekunden (für Exporte)
+int lat_bucket_index(uint64_t us);
+uint64_t lat_bucket_lower(int idx);
+uint64_t lat_bucket_upper(int idx);
+
+#endif
@@ -0,0 +1,521 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Parallele Auswertung von ping-Textmitschnitten (siehe textlog.h)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "textlog.h"
+#include "pingparse.h"
+
+// Obergrenze der History pro Block (bei 1 s Intervall gut 190 Tage)
+#define TLOG_MAX_BINS (1 << 24)
+
+typedef struct {
+    const char *data;
+    size_t len;
+    int file;
+
+    // Erster Durchlauf
+    LatencyStats lat;
+    uint64_t probes;         // inkl. Lücken im Block
+    uint64_t replies;
+    uint64_t timeouts;
+    uint64_t gaps;
+    uint64_t dups;
+    uint64_t late;
+    uint64_t lines;
+    double last;             // < 0 = keine Antwort im Block
+    int has_probe;
+    int first_seq;           // erste icmp_seq im Block, -1 = keine
+    int head_reset;          // "PING ..."-Kopfzeile vor der ersten Probe
+    int tail_expect;         // erwartete icmp_seq am Blockende, -1 = unbekannt
+    int untimed;             // Probe ohne "ping -D"-Zeitstempel gesehen
+    int64_t first_us;        // Zeitstempel der ersten/letzten Probe, -1 = keiner
+    int64_t last_us;
+
+    // Aus der Zusammenführung, für den zweiten Durchlauf
+    uint64_t base;           // Position der ersten Probe abzüglich head_gap
+    uint64_t head_gap;       // fehlende icmp_seq zum vorherigen Block
+    int head_expect;         // erwartete icmp_seq am Blockanfang, -1 = unbekannt
+
+    RollupBucket *bins;
+    size_t nbins;
+    int64_t first_bin;
+    int nomem;
+} Chunk;
+
+typedef struct {
+    Chunk *chunks;
+    size_t count;
+    size_t next;             // nächster freier Block (atomar)
+    int pass;                // 1 = Statistik (+ History mit Zeitstempeln), 2 = History nach Position
+    int64_t bin_us;
+    int64_t per_bin;         // Probes pro Intervall im zweiten Durchlauf
+} Job;
+
+static inline int is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// "[1712345678.123456] " am Zeilenanfang (ping -D). Mikrosekunden, -1 wenn keiner
+static int64_t scan_stamp(const char *s, size_t len, size_t *skip) {
+    size_t i = 1;
+    int64_t sec = 0, us = 0;
+    int frac = 0;
+
+    if (len < 3 || s[0] != '[' || !is_digit(s[1])) return -1;
+    while (i < len && is_digit(s[i])) sec = sec * 10 + (s[i++] - '0');
+    if (i < len && s[i] == '.') {
+        i++;
+        while (i < len && is_digit(s[i])) {
+            if (frac < 6) {
+                us = us * 10 + (s[i] - '0');
+                frac++;
+            }
+            i++;
+        }
+    }
+    if (i >= len || s[i] != ']') return -1;
+    for (; frac < 6; frac++) us *= 10;
+
+    i++;
+    if (i < len && s[i] == ' ') i++;
+    *skip = i;
+    return sec * 1000000 + us;
+}
+
+// Intervall key des Blocks, legt es bei Bedarf an. NULL ohne Speicher
+static RollupBucket *bin_at(Chunk *c, int64_t key) {
+    if (c->nbins == 0) c->first_bin = key;
+    // Uhr rückwärts gestellt: dem ersten Intervall zuschlagen
+    if (key < c->first_bin) key = c->first_bin;
+    if (key - c->first_bin >= TLOG_MAX_BINS) key = c->first_bin + TLOG_MAX_BINS - 1;
+
+    size_t idx = (size_t)(key - c->first_bin);
+    if (idx >= c->nbins) {
+        size_t n = c->nbins ? c->nbins : 64;
+        while (n <= idx) n *= 2;
+        RollupBucket *bins = realloc(c->bins, n * sizeof(*bins));
+        if (!bins) {
+            c->nomem = 1;
+            return NULL;
+        }
+        memset(bins + c->nbins, 0, (n - c->nbins) * sizeof(*bins));
+        c->bins = bins;
+        c->nbins = n;
+    }
+    return &c->bins[idx];
+}
+
+static void bucket_add(RollupBucket *b, double rtt_ms) {
+    float v = (float)rtt_ms;
+    if (b->recv == 0 || v < b->min) b->min = v;
+    if (b->recv == 0 || v > b->max) b->max = v;
+    b->sum += rtt_ms;
+    b->recv++;
+}
+
+static void bucket_merge(RollupBucket *dst, const RollupBucket *src) {
+    if (src->recv > 0) {
+        if (dst->recv == 0 || src->min < dst->min) dst->min = src->min;
+        if (dst->recv == 0 || src->max > dst->max) dst->max = src->max;
+    }
+    dst->sum += src->sum;
+    dst->recv += src->recv;
+    dst->lost += src->lost;
+}
+
+// count verlorene Probes ab Position pos auf die Intervalle verteilen
+static void bin_lost_range(Chunk *c, uint64_t pos, uint64_t count, int64_t per_bin) {
+    while (count > 0) {
+        uint64_t room = (uint64_t)per_bin - pos % (uint64_t)per_bin;
+        uint64_t n = count < room ? count : room;
+        RollupBucket *b = bin_at(c, (int64_t)(pos / (uint64_t)per_bin));
+        if (!b) return;
+        b->lost += (uint32_t)n;
+        pos += n;
+        count -= n;
+    }
+}
+
+static void scan_chunk(Chunk *c, const Job *job) {
+    int stats = job->pass == 1;
+    int by_time = job->pass == 1 && job->bin_us > 0;
+    int by_pos = job->pass == 2;
+    int expect = c->head_expect;
+    int first = 1;
+    uint64_t pos = c->base;
+
+    const char *p = c->data, *end = c->data + c->len;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        const char *s = p;
+        size_t len = (size_t)((nl ? nl : end) - p);
+        p = nl ? nl + 1 : end;
+
+        if (stats) c->lines++;
+        if (len > 0 && s[len - 1] == '\r') len--;
+
+        size_t skip = 0;
+        int64_t ts = scan_stamp(s, len, &skip);
+        s += skip;
+        len -= skip;
+
+        // Neuer ping-Lauf im selben Mitschnitt: icmp_seq beginnt von vorn
+        if (len >= 5 && memcmp(s, "PING ", 5) == 0) {
+            expect = -1;
+            if (first && stats) c->head_reset = 1;
+            continue;
+        }
+
+        PingLine pl;
+        if (len > PING_LINE_MAX || ping_parse_line(s, len, &pl) == PING_LINE_OTHER) continue;
+        if (pl.kind == PING_LINE_REPLY && pl.dup) {
+            if (stats) c->dups++;
+            continue;
+        }
+
+        uint64_t gap = 0;
+        if (pl.seq >= 0) {
+            if (expect >= 0) {
+                int delta = (pl.seq - expect) & 0xffff;
+                if (delta >= 0x8000) {
+                    // Antwort nach "no answer yet": Probe ist schon gezählt
+                    if (stats) c->late++;
+                    continue;
+                }
+                gap = (uint64_t)delta;
+            }
+            expect = (pl.seq + 1) & 0xffff;
+        }
+
+        int reply = pl.kind == PING_LINE_REPLY;
+        if (stats) {
+            if (first) c->has_probe = 1;
+            if (c->first_seq < 0) c->first_seq = pl.seq;
+            c->probes += gap + 1;
+            c->gaps += gap;
+            if (reply) {
+                c->replies++;
+                c->last = pl.rtt_ms;
+                lat_add(&c->lat, pl.rtt_ms);
+            } else {
+                c->timeouts++;
+            }
+            if (ts < 0) {
+                c->untimed = 1;
+            } else {
+                if (c->first_us < 0) c->first_us = ts;
+                c->last_us = ts;
+            }
+        }
+        if (first) {
+            gap += c->head_gap * (uint64_t)by_pos;
+            first = 0;
+        }
+
+        RollupBucket *b = NULL;
+        if (by_time && ts >= 0) {
+            b = bin_at(c, ts / job->bin_us);
+            if (b) b->lost += (uint32_t)gap;
+        } else if (by_pos) {
+            bin_lost_range(c, pos, gap, job->per_bin);
+            b = bin_at(c, (int64_t)((pos + gap) / (uint64_t)job->per_bin));
+        }
+        if (b) {
+            if (reply) bucket_add(b, pl.rtt_ms);
+            else b->lost++;
+        }
+        pos += gap + 1;
+    }
+
+    if (stats) c->tail_expect = expect;
+}
+
+// Ergebnisse des ersten Durchlaufs verwerfen; Daten und Datei bleiben
+static void chunk_reset(Chunk *c, int head_expect) {
+    const char *data = c->data;
+    size_t len = c->len;
+    int file = c->file;
+
+    free(c->bins);
+    memset(c, 0, sizeof(*c));
+    c->data = data;
+    c->len = len;
+    c->file = file;
+    c->last = -1;
+    c->first_seq = -1;
+    c->tail_expect = -1;
+    c->head_expect = head_expect;
+    c->first_us = c->last_us = -1;
+    lat_reset(&c->lat);
+}
+
+static void *worker(void *arg) {
+    Job *job = arg;
+    for (;;) {
+        size_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->count) break;
+        scan_chunk(&job->chunks[i], job);
+    }
+    return NULL;
+}
+
+static void run_pass(Job *job, int threads) {
+    pthread_t tid[threads];
+    int started = 0;
+
+    job->next = 0;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&tid[started], NULL, worker, job) != 0) break;
+        started++;
+    }
+    worker(job);
+    for (int i = 0; i < started; i++) pthread_join(tid[i], NULL);
+}
+
+// Datei einblenden und an Zeilengrenzen in Blöcke zerlegen
+static int add_file(Job *job, size_t *cap, int file, const char *path, void **map, size_t *size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return -1;
+    }
+    *size = (size_t)st.st_size;
+    *map = NULL;
+    if (*size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    *map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (*map == MAP_FAILED) {
+        *map = NULL;
+        return -1;
+    }
+    madvise(*map, *size, MADV_SEQUENTIAL);
+
+    const char *data = *map;
+    size_t start = 0;
+    while (start < *size) {
+        size_t stop = start + TLOG_CHUNK;
+        if (stop >= *size) {
+            stop = *size;
+        } else {
+            const char *nl = memchr(data + stop, '\n', *size - stop);
+            stop = nl ? (size_t)(nl - data) + 1 : *size;
+        }
+
+        if (job->count == *cap) {
+            size_t n = *cap ? *cap * 2 : 64;
+            Chunk *chunks = realloc(job->chunks, n * sizeof(*chunks));
+            if (!chunks) return -1;
+            job->chunks = chunks;
+            *cap = n;
+        }
+        Chunk *c = &job->chunks[job->count++];
+        c->bins = NULL;
+        c->data = data + start;
+        c->len = stop - start;
+        c->file = file;
+        chunk_reset(c, -1);
+
+        start = stop;
+    }
+    return 0;
+}
+
+// Block-History in die Gesamt-History übernehmen
+static int merge_bins(TextLogSummary *s, Job *job) {
+    int64_t lo = INT64_MAX, hi = INT64_MIN;
+    for (size_t i = 0; i < job->count; i++) {
+        Chunk *c = &job->chunks[i];
+        if (c->nomem) {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (c->nbins == 0) continue;
+        if (c->first_bin < lo) lo = c->first_bin;
+        if (c->first_bin + (int64_t)c->nbins > hi) hi = c->first_bin + (int64_t)c->nbins;
+    }
+    if (lo > hi) return 0;
+
+    s->nbins = (size_t)(hi - lo);
+    s->first_bin = lo;
+    s->bins = calloc(s->nbins, sizeof(*s->bins));
+    if (!s->bins) return -1;
+
+    for (size_t i = 0; i < job->count; i++) {
+        Chunk *c = &job->chunks[i];
+        for (size_t j = 0; j < c->nbins; j++) {
+            bucket_merge(&s->bins[c->first_bin - lo + (int64_t)j], &c->bins[j]);
+        }
+        // Lücke zum Vorgängerblock mit Zeitstempeln: beim ersten Zeitstempel
+        if (s->timed && c->head_gap > 0 && c->first_us >= 0) {
+            s->bins[c->first_us / s->bin_us - lo].lost += (uint32_t)c->head_gap;
+        }
+    }
+
+    // Leere Intervalle am Rand abschneiden (überdimensionierte Blockpuffer)
+    while (s->nbins > 0 && s->bins[s->nbins - 1].recv == 0 && s->bins[s->nbins - 1].lost == 0) s->nbins--;
+    return 0;
+}
+
+// Vielfache des Grundintervalls, bei 60 s: 1 min ... 1 Woche
+static const int coarse_steps[] = { 1, 2, 5, 10, 15, 30, 60, 120, 360, 720, 1440, 10080 };
+
+static int coarsen_bins(TextLogSummary *s) {
+    int f = 1;
+    for (size_t i = 0; i < sizeof(coarse_steps) / sizeof(coarse_steps[0]); i++) {
+        f = coarse_steps[i];
+        if ((s->first_bin + (int64_t)s->nbins - 1) / f - s->first_bin / f < s->max_bins) break;
+    }
+    if (f == 1) return 0;
+
+    int64_t first = s->first_bin / f;
+    size_t n = (size_t)((s->first_bin + (int64_t)s->nbins - 1) / f - first + 1);
+    RollupBucket *bins = calloc(n, sizeof(*bins));
+    if (!bins) return -1;
+
+    for (size_t i = 0; i < s->nbins; i++) {
+        bucket_merge(&bins[(s->first_bin + (int64_t)i) / f - first], &s->bins[i]);
+    }
+    free(s->bins);
+    s->bins = bins;
+    s->nbins = n;
+    s->first_bin = first;
+    s->bin_us *= f;
+    return 0;
+}
+
+int tlog_analyze(TextLogSummary *s, char *const paths[], int n) {
+    Job job = {0};
+    size_t cap = 0;
+    void **maps = calloc((size_t)n, sizeof(*maps));
+    size_t *sizes = calloc((size_t)n, sizeof(*sizes));
+    int rc = -1;
+
+    lat_reset(&s->lat);
+    s->sent = s->recv = s->timeouts = s->gaps = s->dups = s->late = 0;
+    s->last = 0;
+    s->files = s->chunks = s->bytes = s->lines = 0;
+    s->first_us = s->last_us = -1;
+    s->bins = NULL;
+    s->nbins = 0;
+    s->failed = NULL;
+    if (!maps || !sizes) goto out;
+
+    for (int i = 0; i < n; i++) {
+        if (add_file(&job, &cap, i, paths[i], &maps[i], &sizes[i]) == -1) {
+            s->failed = paths[i];
+            goto out;
+        }
+        s->files++;
+        s->bytes += sizes[i];
+    }
+    s->chunks = job.count;
+
+    if (s->threads <= 0) s->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (s->threads < 1) s->threads = 1;
+    if ((size_t)s->threads > job.count) s->threads = job.count ? (int)job.count : 1;
+
+    job.bin_us = s->bin_us;
+    job.pass = 1;
+    run_pass(&job, s->threads);
+    s->passes = 1;
+
+    // Zusammenführen in Dateireihenfolge, Lücken an Blockgrenzen nachtragen
+    int expect = -1, file = -1, untimed = 0;
+    uint64_t pos = 0;
+    for (size_t i = 0; i < job.count; i++) {
+        Chunk *c = &job.chunks[i];
+        if (c->file != file) {
+            expect = -1;
+            file = c->file;
+        }
+        if (c->has_probe) {
+            if (!c->head_reset && expect >= 0 && c->first_seq >= 0) {
+                int delta = (c->first_seq - expect) & 0xffff;
+                if (delta < 0x8000) {
+                    c->head_gap = (uint64_t)delta;
+                } else {
+                    // Block beginnt mit verspäteten Antworten auf Probes des
+                    // Vorgängers: mit dessen Erwartung noch einmal einlesen,
+                    // dann zählen sie wie in einem Durchlauf als verspätet
+                    chunk_reset(c, expect);
+                    scan_chunk(c, &job);
+                }
+            }
+            expect = c->tail_expect;
+        } else if (c->head_reset) {
+            expect = -1;
+        }
+        c->base = pos;
+        pos += c->head_gap + c->probes;
+
+        s->sent += c->head_gap + c->probes;
+        s->gaps += c->head_gap + c->gaps;
+        s->recv += c->replies;
+        s->timeouts += c->timeouts;
+        s->dups += c->dups;
+        s->late += c->late;
+        s->lines += c->lines;
+        if (c->last >= 0) s->last = c->last;
+        lat_merge(&s->lat, &c->lat);
+
+        untimed |= c->untimed;
+        if (c->first_us >= 0 && (s->first_us < 0 || c->first_us < s->first_us)) s->first_us = c->first_us;
+        if (c->last_us > s->last_us) s->last_us = c->last_us;
+    }
+    s->timed = s->sent > 0 && !untimed;
+
+    if (s->bin_us > 0 && s->sent > 0 && !s->timed) {
+        // Ohne Zeitstempel: History nach Position, die erst jetzt feststeht
+        for (size_t i = 0; i < job.count; i++) {
+            free(job.chunks[i].bins);
+            job.chunks[i].bins = NULL;
+            job.chunks[i].nbins = 0;
+        }
+        job.per_bin = s->bin_us / (s->interval_us > 0 ? s->interval_us : 1000000);
+        if (job.per_bin < 1) job.per_bin = 1;
+        job.pass = 2;
+        run_pass(&job, s->threads);
+        s->passes = 2;
+    }
+    if (s->bin_us > 0 && merge_bins(s, &job) == -1) goto out;
+    if (s->max_bins > 0 && s->nbins > (size_t)s->max_bins && coarsen_bins(s) == -1) goto out;
+
+    rc = 0;
+
+out:
+    for (size_t i = 0; i < job.count; i++) free(job.chunks[i].bins);
+    free(job.chunks);
+    for (int i = 0; maps && i < n; i++) {
+        if (maps[i]) munmap(maps[i], sizes[i]);
+    }
+    free(maps);
+    free(sizes);
+    return rc;
+}
+
+void tlog_free(TextLogSummary *s) {
+    free(s->bins);
+    s->bins = NULL;
+    s->nbins = 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Offline-Auswertung mitgeschnittener ping(8)-Ausgabe. Die Dateien werden
+ * per mmap gelesen, in Blöcke an Zeilengrenzen zerlegt und von mehreren
+ * Threads parallel durch den Scanner aus pingparse.c geschickt; die
+ * Teilergebnisse (Histogramm, Zähler, History) werden danach in
+ * Dateireihenfolge zusammengeführt. Lücken in icmp_seq zählen als Verlust,
+ * auch über Blockgrenzen hinweg.
+ *
+ * Zeitstempel von "ping -D" ("[1712345678.123456] 64 bytes ...") legen die
+ * History-Intervalle fest. Fehlen sie, wird die Zeit aus der Position der
+ * Probe und dem Sendeabstand abgeleitet; dafür ist ein zweiter Durchlauf
+ * nötig, weil die Position eines Blocks erst nach dem ersten feststeht.
+ */
+
+#ifndef PINGMON_TEXTLOG_H
+#define PINGMON_TEXTLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stats.h"
+#include "rollup.h"
+
+// Blockgröße für die Verteilung auf Threads
+#define TLOG_CHUNK (8u << 20)
+
+typedef struct {
+    // Eingabe
+    int threads;             // 0 = Anzahl CPUs
+    int64_t bin_us;          // History-Intervall, 0 = keine History
+    int max_bins;            // > 0: Intervall vergröbern, bis höchstens so viele übrig sind
+    int64_t interval_us;     // Sendeabstand für Logs ohne Zeitstempel
+
+    // Ergebnis
+    LatencyStats lat;
+    uint64_t sent;           // Antworten + Ausfallmeldungen + Lücken
+    uint64_t recv;
+    uint64_t timeouts;       // "no answer yet", "Request timeout", "From ... Unreachable"
+    uint64_t gaps;           // fehlende icmp_seq ohne eigene Zeile
+    uint64_t dups;
+    uint64_t late;           // Antworten auf bereits als verloren gezählte Probes
+    double last;             // letzte RTT in ms
+    uint64_t files;
+    uint64_t chunks;
+    uint64_t bytes;
+    uint64_t lines;
+    int timed;               // alle Dateien mit "ping -D"-Zeitstempeln
+    int64_t first_us;        // Wanduhr, nur wenn timed
+    int64_t last_us;
+    int passes;
+
+    // History: bins[i] deckt [first_bin + i, first_bin + i + 1) * bin_us ab,
+    // ohne Zeitstempel relativ zum Beginn des ersten Logs
+    RollupBucket *bins;
+    size_t nbins;
+    int64_t first_bin;
+
+    const char *failed;      // Datei, bei der ein Fehler auftrat (errno gesetzt)
+} TextLogSummary;
+
+// paths[0..n-1] auswerten. 0 = OK, -1 = Fehler (errno, s->failed)
+int tlog_analyze(TextLogSummary *s, char *const paths[], int n);
+
+void tlog_free(TextLogSummary *s);
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Hierarchisches Timer-Rad (siehe twheel.h)
+ */
+
+#define _GNU_SOURCE
+
+#include "twheel.h"
+
+#define TW_MASK (TW_SLOTS - 1)
+
+// w->now ist der nächste zu bearbeitende Tick
+
+static inline uint64_t rotr64(uint64_t x, unsigned s) {
+    s &= 63;
+    return s ? (x >> s) | (x << (64 - s)) : x;
+}
+
+static void unlink_timer(TimerWheel *w, TwTimer *t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    TwTimer *head = &w->heads[t->slot / TW_SLOTS][t->slot % TW_SLOTS];
+    if (head->next == head) w->occupied[t->slot / TW_SLOTS] &= ~(1ULL << (t->slot % TW_SLOTS));
+    t->next = t->prev = NULL;
+    w->count--;
+}
+
+// In den Slot der passenden Ebene hängen. Ebene L nimmt Abstände bis
+// 64^(L+1) - 1 auf; weiter entfernte Timer landen im letzten Slot der
+// obersten Ebene und werden beim Umsortieren erneut eingeordnet
+static void place(TimerWheel *w, TwTimer *t) {
+    uint64_t expires = t->expires < w->now ? w->now : t->expires;
+    uint64_t delta = expires - w->now;
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= (1ULL << (TW_BITS * (level + 1)))) level++;
+    if (delta >= (1ULL << (TW_BITS * TW_LEVELS))) expires = w->now + (1ULL << (TW_BITS * TW_LEVELS)) - 1;
+
+    unsigned idx = (unsigned)(expires >> (TW_BITS * level)) & TW_MASK;
+    TwTimer *head = &w->heads[level][idx];
+    t->slot = (uint16_t)(level * TW_SLOTS + idx);
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+    w->occupied[level] |= 1ULL << idx;
+    w->count++;
+}
+
+void tw_init(TimerWheel *w, int64_t now_us, int64_t tick_us) {
+    w->origin_us = now_us;
+    w->tick_us = tick_us > 0 ? tick_us : 1;
+    w->now = 0;
+    w->count = 0;
+    w->fired = w->cascaded = 0;
+    for (int l = 0; l < TW_LEVELS; l++) {
+        w->occupied[l] = 0;
+        for (int s = 0; s < TW_SLOTS; s++) w->heads[l][s].next = w->heads[l][s].prev = &w->heads[l][s];
+    }
+}
+
+void tw_add(TimerWheel *w, TwTimer *t, int64_t when_us) {
+    if (tw_pending(t)) unlink_timer(w, t);
+
+    int64_t rel = when_us - w->origin_us;
+    uint64_t ticks = rel > 0 ? (uint64_t)((rel + w->tick_us - 1) / w->tick_us) : 0;
+    t->expires = ticks < w->now ? w->now : ticks;
+    place(w, t);
+}
+
+void tw_del(TimerWheel *w, TwTimer *t) {
+    if (tw_pending(t)) unlink_timer(w, t);
+}
+
+// Slot einer höheren Ebene auflösen und seine Timer neu einordnen
+static void cascade(TimerWheel *w, int level, unsigned idx) {
+    TwTimer *head = &w->heads[level][idx];
+    TwTimer list = *head;
+    if (list.next == head) return;
+
+    // Liste abhängen, dann einzeln neu einordnen
+    list.next->prev = &list;
+    list.prev->next = &list;
+    head->next = head->prev = head;
+    w->occupied[level] &= ~(1ULL << idx);
+
+    while (list.next != &list) {
+        TwTimer *t = list.next;
+        list.next = t->next;
+        t->next->prev = &list;
+        w->count--;
+        place(w, t);
+        w->cascaded++;
+    }
+}
+
+size_t tw_advance(TimerWheel *w, int64_t now_us) {
+    if (now_us < w->origin_us) return 0;
+    uint64_t target = (uint64_t)((now_us - w->origin_us) / w->tick_us);
+    size_t fired = 0;
+
+    while (w->now <= target) {
+        unsigned idx = (unsigned)(w->now & TW_MASK);
+
+        // Leere Strecken bis zum nächsten belegten Slot bzw. Überlauf überspringen
+        if (idx != 0) {
+            uint64_t bits = w->occupied[0] >> idx;
+            uint64_t next = bits ? w->now + (uint64_t)__builtin_ctzll(bits) : (w->now | TW_MASK) + 1;
+            if (next > target) {
+                w->now = target + 1;
+                break;
+            }
+            w->now = next;
+            idx = (unsigned)(w->now & TW_MASK);
+        }
+
+        // Überlauf: nächsten Slot der höheren Ebenen herunterholen
+        for (int l = 1, up = (int)idx; l < TW_LEVELS && up == 0; l++) {
+            up = (int)((w->now >> (TW_BITS * l)) & TW_MASK);
+            cascade(w, l, (unsigned)up);
+        }
+
+        // Fällige Liste abhängen und den Tick als erledigt markieren, bevor
+        // die Rückrufe laufen: neu eingeplante Timer landen frühestens im
+        // nächsten Tick
+        TwTimer *head = &w->heads[0][idx];
+        TwTimer due = *head;
+        w->now++;
+        if (due.next == head) continue;
+        due.next->prev = &due;
+        due.prev->next = &due;
+        head->next = head->prev = head;
+        w->occupied[0] &= ~(1ULL << idx);
+
+        while (due.next != &due) {
+            TwTimer *t = due.next;
+            due.next = t->next;
+            t->next->prev = &due;
+            t->next = t->prev = NULL;
+            w->count--;
+            w->fired++;
+            fired++;
+            t->fn(t, now_us);
+        }
+    }
+    return fired;
+}
+
+int64_t tw_next_us(const TimerWheel *w) {
+    if (w->count == 0) return -1;
+
+    uint64_t best = UINT64_MAX;
+    for (int l = 0; l < TW_LEVELS; l++) {
+        if (!w->occupied[l]) continue;
+
+        // Erster Block der Ebene, der noch nicht bearbeitet bzw. umsortiert ist
+        unsigned shift = TW_BITS * (unsigned)l;
+        uint64_t block = (w->now + (1ULL << shift) - 1) >> shift;
+        uint64_t bits = rotr64(w->occupied[l], (unsigned)(block & TW_MASK));
+        uint64_t tick = (block + (uint64_t)__builtin_ctzll(bits)) << shift;
+        if (tick < best) best = tick;
+    }
+    return w->origin_us + (int64_t)best * w->tick_us;
+}
@@ -0,0 +1,69 @@
+/*
+ * pingmon - Advanced Ping Monitor
+ * Copyright (c) 2026 zeroc
+ *
+ * Hierarchisches Timer-Rad für den Probe-Takt vieler Ziele: fünf Ebenen
+ * mit je 64 Slots, Ebene 0 in Ticks von tick_us. Einplanen und Auslösen
+ * kosten O(1); Timer höherer Ebenen werden beim Überlauf der darunter
+ * liegenden einmal umsortiert (amortisiert O(1) pro Timer). Die Timer sind
+ * in die Strukturen des Aufrufers eingebettet, das Rad selbst alloziert
+ * nichts. Ein einziger timerfd genügt: tw_next_us() liefert, wann er das
+ * nächste Mal auslösen muss.
+ */
+
+#ifndef PINGMON_TWHEEL_H
+#define PINGMON_TWHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TW_BITS   6
+#define TW_SLOTS  (1 << TW_BITS)
+#define TW_LEVELS 5                 // 64^5 Ticks: bei 100 us rund 30 h
+
+typedef struct TwTimer TwTimer;
+typedef void (*TwFn)(TwTimer *t, int64_t now_us);
+
+struct TwTimer {
+    TwTimer *next, *prev;    // NULL = nicht eingeplant
+    uint64_t expires;        // Tick
+    uint16_t slot;           // Ebene * TW_SLOTS + Slot
+    TwFn fn;                 // beim Auslösen, Timer ist dann schon ausgetragen
+};
+
+typedef struct {
+    int64_t origin_us;       // monotone Zeit von Tick 0
+    int64_t tick_us;
+    uint64_t now;            // zuletzt bearbeiteter Tick
+    uint64_t occupied[TW_LEVELS];        // belegte Slots je Ebene (Bitmap)
+    TwTimer heads[TW_LEVELS][TW_SLOTS];  // Listenköpfe, zirkulär
+    size_t count;
+
+    uint64_t fired;
+    uint64_t cascaded;       // beim Überlauf umsortierte Timer
+} TimerWheel;
+
+void tw_init(TimerWheel *w, int64_t now_us, int64_t tick_us);
+
+static inline void tw_timer_init(TwTimer *t, TwFn fn) {
+    t->next = t->prev = NULL;
+    t->fn = fn;
+}
+
+static inline int tw_pending(const TwTimer *t) {
+    return t->next != NULL;
+}
+
+// Timer auf when_us einplanen (bereits eingeplant: verschieben). Liegt
+// when_us nicht in der Zukunft, löst er beim nächsten tw_advance aus
+void tw_add(TimerWheel *w, TwTimer *t, int64_t when_us);
+void tw_del(TimerWheel *w, TwTimer *t);
+
+// Alle bis now_us fälligen Timer auslösen. Rückgabe: Anzahl
+size_t tw_advance(TimerWheel *w, int64_t now_us);
+
+// Frühester Zeitpunkt, zu dem tw_advance etwas zu tun hat (Auslösen oder
+// Umsortieren), -1 wenn nichts eingeplant ist
+int64_t tw_next_us(const TimerWheel *w);
+
+#endif